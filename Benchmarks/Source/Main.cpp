@@ -0,0 +1,36 @@
+#define CATCH_CONFIG_RUNNER
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+
+
+#include <juce_gui_basics/juce_gui_basics.h>
+#include <docks/docks.h>
+#include "../../docks/tests/catch2.hpp"
+
+
+/**
+ -------------------------------------------------------------
+ ===================================
+ MARK: - Benchmarks -
+ ===================================
+ -------------------------------------------------------------
+ Runs every [!benchmark] case in docks/tests, without the Demo's windows or its tests.
+ With no arguments the results are written as Catch's xml, one BenchmarkResults element per
+ benchmark with its mean and standard deviation in nanoseconds, so runs can be compared
+ between releases. Any arguments are passed to Catch instead, eg:
+ 
+    Benchmarks "[!benchmark]" --reporter xml --out results.xml
+    Benchmarks bench_layoutOperations
+ */
+
+int main(int argc, char* argv[])
+{
+    /// Components and windows need the message manager, this thread is its message thread
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    
+    Catch::Session session;
+    if (argc > 1)
+        return session.run(argc, argv);
+    
+    const char* defaultArgs[] = {argv[0], "[!benchmark]", "--reporter", "xml"};
+    return session.run(4, defaultArgs);
+}
@@ -0,0 +1,29 @@
+#define CATCH_CONFIG_RUNNER
+
+
+#include <juce_gui_basics/juce_gui_basics.h>
+#include <docks/docks.h>
+#include "../../docks/tests/catch2.hpp"
+
+
+/**
+ -------------------------------------------------------------
+ ===================================
+ MARK: - Tests -
+ ===================================
+ -------------------------------------------------------------
+ Runs the tests in docks/tests without the Demo app. Built with DOCKS_HEADLESS, so the docking
+ windows never reach the desktop and it runs on a machine without a display. Arguments are
+ passed to Catch, eg:
+ 
+    Tests                   everything but the large random layouts and the long fuzzing run
+    Tests "[scale]"         only the large random layouts
+    Tests "[fuzz]" --rng-seed 7    the long fuzzing run, from seed 7
+ */
+
+int main(int argc, char* argv[])
+{
+    /// Components and windows need the message manager, this thread is its message thread
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    return Catch::Session().run(argc, argv);
+}
@@ -7,6 +7,16 @@
 #include "source/DockingWindow.cpp"
 #include "source/DockingComponent.cpp"
 #include "source/HeaderComponent.cpp"
+#include "source/TreeDispatcher.cpp"
+#include "source/SplitLayout.cpp"
+#include "source/LayoutSolver.cpp"
+#include "source/BinaryLayout.cpp"
+#include "source/XmlLayout.cpp"
+#include "source/LayoutAutosaver.cpp"
+#include "source/LayoutJournal.cpp"
+#include "source/DockUuid.cpp"
+#include "source/DropZoneIndex.cpp"
+#include "source/SuspendingViewComponent.cpp"
 
 
 //#include "tests/test_DockManager.cpp"
@@ -23,11 +23,38 @@ END_JUCE_MODULE_DECLARATION
 #include <juce_gui_basics/juce_gui_basics.h>
 
 
+/** Config: DOCKS_HEADLESS
+    Keeps docking windows off the desktop, so layouts and their components are built without
+    a display, ie to run the tests on a build machine
+*/
+#ifndef DOCKS_HEADLESS
+ #define DOCKS_HEADLESS 0
+#endif
+
+/** Config: DOCKS_COUNTERS
+    Counts listener callbacks, layout passes and the components built, for the tests and benchmarks
+    to read through DockCounters. Off, the counting compiles away and every counter reads 0
+*/
+#ifndef DOCKS_COUNTERS
+ #define DOCKS_COUNTERS 0
+#endif
+
+
 #include "source/DockManager.h"
 #include "source/DockManagerData.h"
 #include "source/DockingWindow.h"
 #include "source/DockingComponent.h"
 #include "source/HeaderComponent.h"
+#include "source/TreeDispatcher.h"
+#include "source/SplitLayout.h"
+#include "source/LayoutSolver.h"
+#include "source/BinaryLayout.h"
+#include "source/XmlLayout.h"
+#include "source/LayoutAutosaver.h"
+#include "source/LayoutJournal.h"
+#include "source/DockUuid.h"
+#include "source/DropZoneIndex.h"
+#include "source/SuspendingViewComponent.h"
 
 //#include "tests/catch2.hpp"
 
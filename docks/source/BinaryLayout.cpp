@@ -0,0 +1,348 @@
+#include "BinaryLayout.h"
+#include "DockUuid.h"
+
+
+namespace
+{
+    const char binaryLayoutMagic[] = {'D', 'O', 'C', 'K'};
+
+
+    /// What follows a property's key, never reorder these
+    enum Tag : juce::uint8
+    {
+        voidTag = 0, intTag, int64Tag, falseTag, trueTag, floatTag, doubleTag, stringTag, uuidTag
+    };
+
+
+    /**
+     BinaryWriter
+     Varints are LEB128, signed values are zigzagged first so small negative numbers stay small
+     */
+    struct BinaryWriter
+    {
+        juce::OutputStream& stream;
+        bool failed = false;
+
+        void writeByte(juce::uint8 byte)
+        {
+            failed |= !stream.writeByte((char) byte);
+        }
+
+        void writeVarint(juce::uint64 value)
+        {
+            juce::uint8 bytes[10];
+            auto numBytes = 0;
+            do
+            {
+                bytes[numBytes] = (juce::uint8) (value & 0x7f);
+                value >>= 7;
+                if (value != 0)
+                    bytes[numBytes] |= 0x80;
+                numBytes++;
+            }
+            while (value != 0);
+            failed |= !stream.write(bytes, (size_t) numBytes);
+        }
+
+        void writeSigned(juce::int64 value)
+        {
+            writeVarint(((juce::uint64) value << 1) ^ (juce::uint64) (value >> 63));
+        }
+
+        void writeString(const juce::String& string)
+        {
+            auto numBytes = string.getNumBytesAsUTF8();
+            writeVarint(numBytes);
+            failed |= !stream.write(string.toRawUTF8(), numBytes);
+        }
+
+        void writeUuid(const DockUuid& uuid)
+        {
+            juce::uint8 bytes[16];
+            uuid.copyBytes(bytes);
+            failed |= !stream.write(bytes, 16);
+        }
+    };
+
+
+    /// BinaryReader, over the whole layout in memory. Reading past the end, or anything out of range, fails it
+    struct BinaryReader
+    {
+        const juce::uint8* data;
+        size_t size;
+        size_t position = 0;
+        bool failed = false;
+
+        juce::uint8 readByte()
+        {
+            if (position >= size) {failed = true; return 0;}
+            return data[position++];
+        }
+
+        juce::uint64 readVarint()
+        {
+            juce::uint64 value = 0;
+            for (auto shift = 0; shift < 64; shift += 7)
+            {
+                auto byte = readByte();
+                value |= (juce::uint64) (byte & 0x7f) << shift;
+                if ((byte & 0x80) == 0) {return value;}
+            }
+
+            failed = true;
+            return 0;
+        }
+
+        juce::int64 readSigned()
+        {
+            auto value = readVarint();
+            return (juce::int64) (value >> 1) ^ -(juce::int64) (value & 1);
+        }
+
+        const juce::uint8* readBytes(size_t numBytes)
+        {
+            if (numBytes > size - position) {failed = true; return nullptr;}
+            auto bytes = data + position;
+            position += numBytes;
+            return bytes;
+        }
+
+        juce::String readString()
+        {
+            auto numBytes = (size_t) readVarint();
+            auto bytes = readBytes(numBytes);
+            return bytes != nullptr ? juce::String::fromUTF8((const char*) bytes, (int) numBytes) : juce::String();
+        }
+
+        float readFloat()
+        {
+            auto bytes = readBytes(sizeof(float));
+            if (bytes == nullptr) {return 0.0f;}
+            auto bits = juce::ByteOrder::littleEndianInt(bytes);
+            float number;
+            std::memcpy(&number, &bits, sizeof(float));
+            return number;
+        }
+
+        double readDouble()
+        {
+            auto bytes = readBytes(sizeof(double));
+            if (bytes == nullptr) {return 0.0;}
+            auto bits = juce::ByteOrder::littleEndianInt64(bytes);
+            double number;
+            std::memcpy(&number, &bits, sizeof(double));
+            return number;
+        }
+
+        juce::String readUuid()
+        {
+            auto bytes = readBytes(16);
+            return bytes != nullptr ? DockUuid::fromBytes(bytes).toString() : juce::String();
+        }
+    };
+
+
+    /// String Table, everything which is written as an index, in the order it was first seen
+    struct StringTable
+    {
+        juce::StringArray strings;
+        juce::HashMap<juce::String, int> indexes;
+
+        void add(const juce::String& string)
+        {
+            if (indexes.contains(string)) {return;}
+            indexes.set(string, strings.size());
+            strings.add(string);
+        }
+
+        const bool isStringValue(const juce::var& value) const
+        {
+            return !(value.isVoid() || value.isInt() || value.isInt64() || value.isBool() || value.isDouble())
+                    && !DockUuid(value.toString()).isCompact();
+        }
+
+        void addTree(const juce::ValueTree& tree)
+        {
+            add(tree.getType().toString());
+            for (auto i = 0; i < tree.getNumProperties(); i++)
+            {
+                auto name = tree.getPropertyName(i);
+                add(name.toString());
+                const auto& value = tree.getProperty(name);
+                if (isStringValue(value))
+                    add(value.toString());
+            }
+
+            for (const auto& child : tree)
+                addTree(child);
+        }
+    };
+
+
+    void writeBinaryTree(BinaryWriter& writer, const StringTable& table, const juce::ValueTree& tree)
+    {
+        writer.writeVarint((juce::uint64) table.indexes[tree.getType().toString()]);
+        writer.writeVarint((juce::uint64) tree.getNumProperties());
+        for (auto i = 0; i < tree.getNumProperties(); i++)
+        {
+            auto name = tree.getPropertyName(i);
+            const auto& value = tree.getProperty(name);
+            writer.writeVarint((juce::uint64) table.indexes[name.toString()]);
+
+            if (value.isVoid())
+            {
+                writer.writeByte(voidTag);
+            }
+            else if (value.isInt() || value.isInt64())
+            {
+                writer.writeByte(value.isInt() ? intTag : int64Tag);
+                writer.writeSigned((juce::int64) value);
+            }
+            else if (value.isBool())
+            {
+                writer.writeByte((bool) value ? trueTag : falseTag);
+            }
+            else if (value.isDouble())
+            {
+                /// Sizes are floats, which only need half the space
+                auto number = (double) value;
+                auto isFloat = (double) (float) number == number;
+                writer.writeByte(isFloat ? floatTag : doubleTag);
+                if (isFloat)
+                    writer.failed |= !writer.stream.writeFloat((float) number);
+                else
+                    writer.failed |= !writer.stream.writeDouble(number);
+            }
+            else if (auto uuid = DockUuid(value.toString()); uuid.isCompact())
+            {
+                /// Uuids as juce::Uuid writes them, 32 lower case hex digits, go in as their 16 bytes
+                writer.writeByte(uuidTag);
+                writer.writeUuid(uuid);
+            }
+            else
+            {
+                writer.writeByte(stringTag);
+                writer.writeVarint((juce::uint64) table.indexes[value.toString()]);
+            }
+        }
+
+        writer.writeVarint((juce::uint64) tree.getNumChildren());
+        for (const auto& child : tree)
+            writeBinaryTree(writer, table, child);
+    }
+
+
+    juce::ValueTree readBinaryTree(BinaryReader& reader, const juce::Array<juce::Identifier>& identifiers, const juce::StringArray& strings, int depth)
+    {
+        /// Anything this deep is corrupt, not a layout
+        if (depth > 256) {reader.failed = true; return {};}
+
+        auto readIndex = [&]() {
+            auto index = reader.readVarint();
+            if (index >= (juce::uint64) strings.size()) {reader.failed = true; return -1;}
+            return (int) index;
+        };
+
+        auto type = identifiers[readIndex()];
+        if (type.isNull()) {reader.failed = true; return {};}
+
+        juce::ValueTree tree(type);
+        auto numProperties = reader.readVarint();
+        for (juce::uint64 i = 0; i < numProperties && !reader.failed; i++)
+        {
+            auto name = identifiers[readIndex()];
+            if (name.isNull()) {reader.failed = true; break;}
+
+            juce::var value;
+            switch (reader.readByte())
+            {
+                case voidTag: break;
+                case intTag: value = (int) reader.readSigned(); break;
+                case int64Tag: value = (juce::int64) reader.readSigned(); break;
+                case falseTag: value = false; break;
+                case trueTag: value = true; break;
+                case floatTag: value = reader.readFloat(); break;
+                case doubleTag: value = reader.readDouble(); break;
+                case stringTag: value = strings[readIndex()]; break;
+                case uuidTag: value = reader.readUuid(); break;
+                default: reader.failed = true; break;
+            }
+
+            tree.setProperty(name, value, nullptr);
+        }
+
+        auto numChildren = reader.readVarint();
+        for (juce::uint64 i = 0; i < numChildren && !reader.failed; i++)
+            tree.appendChild(readBinaryTree(reader, identifiers, strings, depth + 1), nullptr);
+
+        return tree;
+    }
+}
+
+
+
+
+
+/**
+ ===================================
+ MARK: - Writing -
+ ===================================
+ */
+
+bool BinaryLayout::write(const juce::ValueTree& tree, juce::OutputStream& stream)
+{
+    if (!tree.isValid()) {return false;}
+
+    StringTable table;
+    table.addTree(tree);
+
+    BinaryWriter writer {stream};
+    writer.failed |= !stream.write(binaryLayoutMagic, sizeof(binaryLayoutMagic));
+    writer.writeVarint(version);
+    writer.writeVarint((juce::uint64) table.strings.size());
+    for (const auto& string : table.strings)
+        writer.writeString(string);
+
+    writeBinaryTree(writer, table, tree);
+    return !writer.failed;
+}
+
+
+
+
+
+/**
+ ===================================
+ MARK: - Reading -
+ ===================================
+ */
+
+juce::ValueTree BinaryLayout::read(const void* data, size_t size)
+{
+    if (!isBinaryLayout(data, size)) {return {};}
+
+    BinaryReader reader {static_cast<const juce::uint8*>(data), size, sizeof(binaryLayoutMagic)};
+    if (reader.readVarint() != version) {return {};}
+
+    /// Strings are only made into identifiers once, empty ones can only be values
+    auto numStrings = reader.readVarint();
+    if (numStrings > size) {return {};}
+    juce::StringArray strings;
+    juce::Array<juce::Identifier> identifiers;
+    strings.ensureStorageAllocated((int) numStrings);
+    identifiers.ensureStorageAllocated((int) numStrings);
+    for (juce::uint64 i = 0; i < numStrings && !reader.failed; i++)
+    {
+        strings.add(reader.readString());
+        identifiers.add(strings[(int) i].isNotEmpty() ? juce::Identifier(strings[(int) i]) : juce::Identifier());
+    }
+
+    auto tree = readBinaryTree(reader, identifiers, strings, 0);
+    return reader.failed ? juce::ValueTree() : tree;
+}
+
+
+const bool BinaryLayout::isBinaryLayout(const void* data, size_t size)
+{
+    return size >= sizeof(binaryLayoutMagic) && std::memcmp(data, binaryLayoutMagic, sizeof(binaryLayoutMagic)) == 0;
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <juce_gui_basics/juce_gui_basics.h>
+
+
+/**
+ -------------------------------------------------------------
+ ===================================
+ MARK: - Binary Layout -
+ ===================================
+ -------------------------------------------------------------
+ */
+
+/**
+ Binary Layout
+ A compact layout format, for layouts which are saved often and loaded at startup. Every type, property
+ name and string is written once in a string table, uuids are stored as their 16 bytes, whole numbers
+ as varints and sizes as floats. Reading it back gives the same tree, property types included
+
+ The stream is the magic "DOCK", the version, the string table and then the trees, parents first.
+ Each tree is its type, its properties as key, tag and value, and its children
+ */
+class BinaryLayout
+{
+public:
+
+    static constexpr int version = 1;
+
+    /// Writing
+    static bool write(const juce::ValueTree& tree, juce::OutputStream& stream);
+
+    /// Reading, an invalid tree if the data isn't a layout this version can read
+    static juce::ValueTree read(const void* data, size_t size);
+
+    /// Format Detection, from the first bytes alone
+    static const bool isBinaryLayout(const void* data, size_t size);
+
+private:
+
+    BinaryLayout() = delete;
+};
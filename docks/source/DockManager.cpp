@@ -1,5 +1,8 @@
 #include "DockManager.h"
 #include "DockingWindow.h"
+#include "DockingComponent.h"
+#include "LayoutAutosaver.h"
+#include "LayoutJournal.h"
 
 /**
  -------------------------------------------------------------
@@ -11,7 +14,11 @@
 
 DockManager::DockManager(Delegate& delegate) : _delegate(delegate)
 {
-    _data._rootTree.addListener(this);
+    _dispatcher.addListener(_data.getTree(), this);
+    _dispatcher.onPropertyChanged = [this] {clearDropZones(); scheduleLayoutUpdate(); scheduleAutosave();};
+    _dispatcher.onStructureChanged = [this] {clearDropZones(); scheduleAutosave();};
+    _data.addTransactionListener(this);
+    _reportedLayoutHash = _data.getLayoutHash();
 #if JUCE_MAC
     _menu = _delegate.getMenuForWindow("");
     
@@ -21,6 +28,10 @@ DockManager::DockManager(Delegate& delegate) : _delegate(delegate)
 
 DockManager::~DockManager()
 {
+    /// Tearing down isn't a change to the layout
+    _journal.reset();
+    _dispatcher.removeListener(_data.getTree(), this);
+    _data.removeTransactionListener(this);
     _components.clear();
     _windows.clear();
 }
@@ -95,34 +106,92 @@ void DockManager::resetAllDisplayNames()
  ====================================
  */
 
-void DockManager::saveLayout(const juce::File& fileToSave)
+void DockManager::saveLayout(const juce::File& fileToSave, LayoutFormat format)
 {
-    _data.saveToFile(fileToSave);
+    _data.saveToFile(fileToSave, format);
 }
 
 
-void DockManager::saveLayout(juce::OutputStream& outputStream)
+void DockManager::saveLayout(juce::OutputStream& outputStream, LayoutFormat format)
 {
-    _data.saveLayout(outputStream);
+    _data.saveLayout(outputStream, format);
 }
 
 
-void DockManager::openLayout(const juce::File& fileToOpen)
+void DockManager::openLayout(const juce::File& fileToOpen, bool reconcile)
 {
-    _components.clear();
-    _windows.clear();
-    _data.openFromFile(fileToOpen);
+    if (!reconcile)
+    {
+        _components.clear();
+        _windows.clear();
+    }
+    
+    _data.openFromFile(fileToOpen, reconcile);
+    removeUnusedComponents();
     
     for (auto window : _windows)
         window->layoutDidLoad();
 }
 
 
-void DockManager::openLayout(juce::InputStream& inputStream)
+void DockManager::openLayout(juce::InputStream& inputStream, bool reconcile)
 {
-    _components.clear();
-    _windows.clear();
-    _data.openLayout(inputStream);
+    if (!reconcile)
+    {
+        _components.clear();
+        _windows.clear();
+    }
+    
+    _data.openLayout(inputStream, reconcile);
+    removeUnusedComponents();
+}
+
+
+void DockManager::setAutosave(const juce::File& file, LayoutFormat format, int debounceMs, int maxLatencyMs)
+{
+    /// The old one saves what it has before it goes
+    _autosaver.reset();
+    if (file == juce::File()) {return;}
+    
+    _autosaver = std::make_unique<LayoutAutosaver>(_data.getTree(), file, format);
+    _autosaver->setTiming(debounceMs, maxLatencyMs);
+    _autosaver->setLayoutHash([this] {return _data.getLayoutHash();});
+}
+
+
+bool DockManager::flushAutosave()
+{
+    return _autosaver == nullptr || _autosaver->flush();
+}
+
+
+void DockManager::setJournal(const juce::File& file, int maxJournalBytes, LayoutFormat format)
+{
+    _journal.reset();
+    if (file == juce::File()) {return;}
+    
+    _journal = std::make_unique<LayoutJournal>(_data, file, maxJournalBytes, format);
+}
+
+
+bool DockManager::recoverLayout(const juce::File& file, bool reconcile)
+{
+    auto layout = LayoutJournal::recover(file);
+    if (!layout.isValid()) {return false;}
+    
+    if (!reconcile)
+    {
+        _components.clear();
+        _windows.clear();
+    }
+    
+    _data.loadLayout(layout, reconcile);
+    removeUnusedComponents();
+    
+    for (auto window : _windows)
+        window->layoutDidLoad();
+    
+    return true;
 }
 
 
@@ -168,6 +237,7 @@ void DockManager::openTemplate()
 
 void DockManager::create2Up(const juce::String& windowName, const juce::StringArray& views)
 {
+    DockManagerData::ScopedTransaction transaction(_data);
     juce::Rectangle<float> bounds;
     if (auto display = juce::Desktop::getInstance().getDisplays().getPrimaryDisplay())
         bounds = display->userArea.toFloat();
@@ -181,6 +251,7 @@ void DockManager::create2Up(const juce::String& windowName, const juce::StringAr
 
 void DockManager::create3Up(const juce::String& windowName, const juce::StringArray& views)
 {
+    DockManagerData::ScopedTransaction transaction(_data);
     juce::Rectangle<float> bounds;
     if (auto display = juce::Desktop::getInstance().getDisplays().getPrimaryDisplay())
         bounds = display->userArea.toFloat();
@@ -195,6 +266,7 @@ void DockManager::create3Up(const juce::String& windowName, const juce::StringAr
 
 void DockManager::create4Up(const juce::String& windowName, const juce::StringArray& views)
 {
+    DockManagerData::ScopedTransaction transaction(_data);
     juce::Rectangle<float> bounds;
     if (auto display = juce::Desktop::getInstance().getDisplays().getPrimaryDisplay())
         bounds = display->userArea.toFloat();
@@ -210,6 +282,7 @@ void DockManager::create4Up(const juce::String& windowName, const juce::StringAr
  
 void DockManager::create2By2(const juce::String& windowName, const juce::StringArray& views)
 {
+    DockManagerData::ScopedTransaction transaction(_data);
     juce::Rectangle<float> bounds;
     if (auto display = juce::Desktop::getInstance().getDisplays().getPrimaryDisplay())
         bounds = display->userArea.toFloat();
@@ -226,6 +299,7 @@ void DockManager::create2By2(const juce::String& windowName, const juce::StringA
 
 void DockManager::create3By3(const juce::String& windowName, const juce::StringArray& views)
 {
+    DockManagerData::ScopedTransaction transaction(_data);
     juce::Rectangle<float> bounds;
     if (auto display = juce::Desktop::getInstance().getDisplays().getPrimaryDisplay())
         bounds = display->userArea.toFloat();
@@ -243,6 +317,7 @@ void DockManager::create3By3(const juce::String& windowName, const juce::StringA
 
 void DockManager::create2Rows(const juce::String& windowName, const juce::StringArray& views)
 {
+    DockManagerData::ScopedTransaction transaction(_data);
     juce::Rectangle<float> bounds;
     if (auto display = juce::Desktop::getInstance().getDisplays().getPrimaryDisplay())
         bounds = display->userArea.toFloat();
@@ -256,6 +331,7 @@ void DockManager::create2Rows(const juce::String& windowName, const juce::String
 
 void DockManager::create3Rows(const juce::String& windowName, const juce::StringArray& views)
 {
+    DockManagerData::ScopedTransaction transaction(_data);
     juce::Rectangle<float> bounds;
     if (auto display = juce::Desktop::getInstance().getDisplays().getPrimaryDisplay())
         bounds = display->userArea.toFloat();
@@ -282,6 +358,7 @@ void DockManager::removeView(const juce::String& viewId)
     
     if (_components.contains(viewId))
         _components.remove(viewId);
+    _hiddenViews.remove(DockUuid(viewId));
 }
 
 
@@ -305,12 +382,211 @@ std::shared_ptr<juce::Component> DockManager::getComponent(const juce::String& u
     
     /// Add to Stored Views
     _components.set(uuid, newView);
+    updateViewVisibility(_data.findTree(uuid));
     
     /// Return Component
     return _components[uuid];
 }
 
 
+void DockManager::removeUnusedComponents()
+{
+    juce::StringArray unused;
+    for (ViewMap::Iterator it(_components); it.next();)
+        if (!_data.findTree(it.getKey()).isValid())
+            unused.add(it.getKey());
+    
+    for (const auto& uuid : unused)
+    {
+        _components.remove(uuid);
+        _hiddenViews.remove(DockUuid(uuid));
+    }
+}
+
+
+void DockManager::setVirtualTabStrip(bool shouldVirtualise)
+{
+    _virtualTabStrip = shouldVirtualise;
+}
+
+
+
+/**
+ ====================================
+ MARK: - Lazy Views -
+ ====================================
+ */
+class DockManager::ViewPrewarmer : private juce::Timer, private juce::MouseListener
+{
+public:
+    ViewPrewarmer(DockManager& manager) : _manager(manager) { juce::Desktop::getInstance().addGlobalMouseListener(this); }
+    ~ViewPrewarmer() override { juce::Desktop::getInstance().removeGlobalMouseListener(this); }
+    void didQueueView() { if (!isTimerRunning()) startTimer(idleTime); }
+    void didReceiveInput() { _lastInput = juce::Time::getMillisecondCounter(); }
+private:
+    /// One view a tick, and only once the user has left the app alone for idleTime
+    void timerCallback() override
+    {
+        auto now = juce::Time::getMillisecondCounter();
+        auto modifiers = juce::ModifierKeys::getCurrentModifiersRealtime();
+        if (modifiers.isAnyMouseButtonDown() || modifiers.isAnyModifierKeyDown())
+            _lastInput = now;
+        
+        auto sinceInput = now - _lastInput;
+        if (sinceInput < (juce::uint32) idleTime)
+        {
+            startTimer(idleTime - (int) sinceInput);
+            return;
+        }
+        
+        if (!_manager.prewarmNextView())
+        {
+            stopTimer();
+            return;
+        }
+        
+        /// The message thread was as busy as the view took to build, so the next waits at least as long
+        auto buildTime = (int) (juce::Time::getMillisecondCounter() - now);
+        startTimer(juce::jmax(interval, buildTime));
+    }
+    
+    /// Every mouse event anywhere in the app, keys come through the docking components
+    void mouseMove(const juce::MouseEvent&) override { didReceiveInput(); }
+    void mouseDown(const juce::MouseEvent&) override { didReceiveInput(); }
+    void mouseDrag(const juce::MouseEvent&) override { didReceiveInput(); }
+    void mouseUp(const juce::MouseEvent&) override { didReceiveInput(); }
+    void mouseWheelMove(const juce::MouseEvent&, const juce::MouseWheelDetails&) override { didReceiveInput(); }
+    
+    static constexpr int interval = 50;
+    static constexpr int idleTime = 500;
+    DockManager& _manager;
+    juce::uint32 _lastInput = juce::Time::getMillisecondCounter();
+};
+
+
+void DockManager::setLazyViews(bool lazy, bool prewarm)
+{
+    _lazyViews = lazy;
+    _prewarmViews = lazy && prewarm;
+    if (_prewarmViews) {return;}
+    
+    _prewarmQueue.clear();
+    _prewarmer = nullptr;
+}
+
+
+const bool DockManager::shouldDeferView(const juce::ValueTree& tree)
+{
+    if (!_lazyViews) {return false;}
+    
+    /// Only tabs which can't be seen
+    auto uuid = _data.getUuid(tree);
+    auto parent = tree.getParent();
+    if (_components.contains(uuid) || _data.getDockType(parent) != DockTypes::tabs || _data.getSelectedId(parent) == uuid) {return false;}
+    
+    if (_prewarmViews && !_prewarmQueue.contains(uuid))
+    {
+        _prewarmQueue.add(uuid);
+        if (_prewarmer == nullptr)
+            _prewarmer = std::make_unique<DockManager::ViewPrewarmer>(*this);
+        _prewarmer->didQueueView();
+    }
+    
+    return true;
+}
+
+
+const bool DockManager::prewarmNextView()
+{
+    /// Creates the next view still waiting, the docking component picks it up once selected
+    while (!_prewarmQueue.isEmpty())
+    {
+        auto uuid = _prewarmQueue[0];
+        _prewarmQueue.remove(0);
+        
+        auto tree = _data.findTree(uuid);
+        if (!tree.isValid() || _components.contains(uuid)) {continue;}
+        getComponent(uuid, _data.getName(tree));
+        break;
+    }
+    
+    return !_prewarmQueue.isEmpty();
+}
+
+
+void DockManager::didReceiveInput()
+{
+    if (_prewarmer)
+        _prewarmer->didReceiveInput();
+}
+
+
+
+
+
+/**
+ ===================================
+ MARK: - View Visibility -
+ ===================================
+ */
+
+void DockManager::updateViewVisibility(const juce::ValueTree& tree)
+{
+    if (!tree.isValid()) {return;}
+    updateViewVisibility(tree, getViewVisibility(tree));
+}
+
+
+void DockManager::updateViewVisibility(const juce::ValueTree& tree, Delegate::ViewVisibility visibility)
+{
+    using ViewVisibility = Delegate::ViewVisibility;
+    auto id = _data.getUuid(tree);
+    auto uuid = DockUuid(id);
+    if (_components.contains(id))
+    {
+        auto previous = _hiddenViews.contains(uuid) ? _hiddenViews[uuid] : ViewVisibility::shown;
+        if (visibility != previous)
+        {
+            if (visibility == ViewVisibility::shown)
+                _hiddenViews.remove(uuid);
+            else
+                _hiddenViews.set(uuid, visibility);
+            
+            if (auto view = _components[id])
+                _delegate.viewVisibilityChanged(_data.getName(tree), *view, visibility);
+        }
+    }
+    
+    /// Everything below is hidden along with this, and tabs hide all but the selected one
+    auto isTabs = _data.getDockType(tree) == DockTypes::tabs;
+    auto selected = isTabs ? _data.getSelectedId(tree) : juce::String();
+    for (auto child : tree)
+    {
+        auto isHiddenTab = isTabs && _data.getUuid(child) != selected;
+        updateViewVisibility(child, visibility == ViewVisibility::shown && isHiddenTab ? ViewVisibility::hiddenTab : visibility);
+    }
+}
+
+
+const DockManager::Delegate::ViewVisibility DockManager::getViewVisibility(const juce::ValueTree& tree) const
+{
+    using ViewVisibility = Delegate::ViewVisibility;
+    if (_data.isWindowMinimized(tree)) {return ViewVisibility::minimised;}
+    
+    for (auto child = tree, parent = tree.getParent(); parent.isValid(); child = parent, parent = parent.getParent())
+        if (_data.getDockType(parent) == DockTypes::tabs && _data.getSelectedId(parent) != _data.getUuid(child))
+            return ViewVisibility::hiddenTab;
+    
+    return ViewVisibility::shown;
+}
+
+
+void DockManager::tabStripVisibilityChanged(const juce::ValueTree& tree, bool isInTabStrip)
+{
+    _delegate.tabStripVisibilityChanged(_data.getName(tree), isInTabStrip);
+}
+
+
 
 
 /**
@@ -491,7 +767,16 @@ public:
     UpdateThrottler(DockManager& manager) : _manager(manager) {}
     void didRecieveUpdate() { startTimer(3000); }
 private:
-    void timerCallback() override {_manager._delegate.didUpdateLayouts(); stopTimer();}
+    void timerCallback() override
+    {
+        stopTimer();
+        
+        /// A layout which has come back to where it was when last reported, ie a drag which ended where it started, hasn't updated
+        auto hash = _manager._data.getLayoutHash();
+        if (hash == _manager._reportedLayoutHash) {return;}
+        _manager._reportedLayoutHash = hash;
+        _manager._delegate.didUpdateLayouts();
+    }
     DockManager& _manager;
 };
 
@@ -504,8 +789,9 @@ private:
 
 void DockManager::valueTreeChildAdded(juce::ValueTree& parentTree, juce::ValueTree& childWhichHasBeenAdded)
 {
-    if (parentTree != _data.getTree()) {return;}
+    if (parentTree != _data.getTree() || _data.isInTransaction()) {return;}
     if (PRINT_TREE_LISTENERS) DBG("Value Tree Child Added");
+    DockCounters::treeCallbacks++;
     
     /// Get Id
     auto id = _data.getUuid(childWhichHasBeenAdded);
@@ -520,8 +806,9 @@ void DockManager::valueTreeChildAdded(juce::ValueTree& parentTree, juce::ValueTr
 
 void DockManager::valueTreeChildRemoved(juce::ValueTree& parentTree, juce::ValueTree& childWhichHasBeenRemoved, int indexFromWhichChildWasRemoved)
 {
-    if (parentTree != _data.getTree()) {return;}
+    if (parentTree != _data.getTree() || _data.isInTransaction()) {return;}
     if (PRINT_TREE_LISTENERS) DBG("Value Tree Child Removed");
+    DockCounters::treeCallbacks++;
     auto id = _data.getUuid(childWhichHasBeenRemoved);
     _windows.remove(id);
 }
@@ -542,12 +829,132 @@ void DockManager::valueTreeChildOrderChanged(juce::ValueTree& parentTreeWhoseChi
 
 
 void DockManager::valueTreePropertyChanged(juce::ValueTree& treeWhosePropertyHasChanged, const juce::Identifier& property)
+{
+    if (treeWhosePropertyHasChanged != _data.getTree()) {return;}
+}
+
+
+void DockManager::scheduleLayoutUpdate()
 {
     if (_throttler == nullptr)
         _throttler = std::make_unique<DockManager::UpdateThrottler>(*this);
     _throttler->didRecieveUpdate();
+}
+
+
+void DockManager::scheduleAutosave()
+{
+    if (_autosaver != nullptr)
+        _autosaver->layoutDidChange();
+}
+
+
+
+/**
+ ===================================
+ MARK: - Transactions -
+ ===================================
+ */
+
+void DockManager::transactionDidCommit(const juce::ValueTree& affectedTree)
+{
+    if (affectedTree != _data.getTree())
+    {
+        updateViewVisibility(affectedTree);
+        return;
+    }
     
-    if (treeWhosePropertyHasChanged != _data.getTree()) {return;}
+    DockCounters::treeCallbacks++;
+    syncWindows();
+}
+
+
+void DockManager::syncWindows()
+{
+    auto rootTree = _data.getTree();
+    
+    /// Remove closed Windows, and any whose tree has been given another uuid
+    juce::Array<DockUuid> closedWindows;
+    for (WindowMap::Iterator it(_windows); it.next();)
+    {
+        auto windowTree = it.getValue()->getTree();
+        if (windowTree.getParent() != rootTree || DockUuid(_data.getUuid(windowTree)) != it.getKey())
+            closedWindows.add(it.getKey());
+    }
+    
+    for (const auto& id : closedWindows)
+        _windows.remove(id);
+    
+    /// Create new Windows
+    for (auto child : rootTree)
+    {
+        auto id = DockUuid(_data.getUuid(child));
+        if (_windows.contains(id)) {continue;}
+        _windows.set(id, std::make_shared<DockingWindow>(*this, _data, child));
+    }
+}
+
+
+void DockManager::transactionDidEnd()
+{
+    /// Whatever was not picked up again has really been removed
+    juce::HashMap<DockUuid, std::shared_ptr<DockingComponent>, DockUuid::HashFunction> detached;
+    _detachedComponents.swapWith(detached);
+}
+
+
+
+
+
+/**
+ ===================================
+ MARK: - Moving Docking Components -
+ ===================================
+ */
+
+void DockManager::registerDockingComponent(const std::shared_ptr<DockingComponent>& component)
+{
+    _dockingComponents.set(component->getUuid(), component);
+}
+
+
+void DockManager::forgetDockingComponent(const juce::String& uuid)
+{
+    auto id = DockUuid(uuid);
+    if (_dockingComponents.contains(id) && _dockingComponents[id].expired())
+        _dockingComponents.remove(id);
+}
+
+
+void DockManager::detachDockingComponent(const std::shared_ptr<DockingComponent>& component)
+{
+    /// Only hold on while a commit may still add the tree somewhere else
+    if (!_data.isCommittingTransaction()) {return;}
+    if (component->getTree().isAChildOf(_data.getTree()))
+        _detachedComponents.set(component->getUuid(), component);
+}
+
+
+std::shared_ptr<DockingComponent> DockManager::reattachDockingComponent(const juce::ValueTree& tree)
+{
+    if (!_data.isCommittingTransaction()) {return nullptr;}
+    auto uuid = DockUuid(_data.getUuid(tree));
+    
+    /// Its old parent has already let go
+    if (_detachedComponents.contains(uuid))
+    {
+        auto component = _detachedComponents[uuid];
+        _detachedComponents.remove(uuid);
+        if (component->getTree() == tree)
+            return component;
+    }
+    
+    /// Its old parent has not committed yet
+    auto component = _dockingComponents[uuid].lock();
+    if (component != nullptr && component->getTree() == tree)
+        return component;
+    
+    return nullptr;
 }
 
 
@@ -572,6 +979,23 @@ void DockManager::createNewWindow(const juce::String& withViewId, const juce::Po
 }
 
 
+void DockManager::buildDropZones(const juce::String& draggingId)
+{
+    /// A drag can end up in any window
+    _dropZones.clear();
+    for (auto window : _windows)
+        window->addDropZones(_dropZones, draggingId);
+}
+
+
+void DockManager::clearDropZones()
+{
+    /// Called on every change, mostly with nothing to clear
+    if (!_dropZones.isEmpty())
+        _dropZones.clear();
+}
+
+
 
 
 
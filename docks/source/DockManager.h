@@ -2,11 +2,15 @@
 
 #include <juce_gui_basics/juce_gui_basics.h>
 #include "DockManagerData.h"
+#include "TreeDispatcher.h"
+#include "DropZoneIndex.h"
 
 
 /// Views
 class DockingWindow;
 class DockingComponent;
+class LayoutAutosaver;
+class LayoutJournal;
 
 
 /**
@@ -17,9 +21,10 @@ class DockingComponent;
  -------------------------------------------------------------
  */
 
-class DockManager : private juce::ValueTree::Listener
+class DockManager : private juce::ValueTree::Listener, private DockManagerData::TransactionListener
 {
     friend class test_DockManager;
+    friend class bench_DockManager;
     friend class DockingWindow; 
     friend class DropComponent;
     friend class WindowComponent;
@@ -93,8 +98,38 @@ public:
         
         /**
          Layout Did Update
+         Called once changes settle, unless they left the layout as it was when last called
          */
         virtual void didUpdateLayouts() {}
+        
+        /**
+         View Visibility
+         Whether a view can be seen, and if not, why
+         */
+        enum class ViewVisibility
+        {
+            shown,
+            hiddenTab,      /// In tabs, behind the selected tab
+            minimised       /// Its window is minimised
+        };
+        
+        /**
+         View Visibility Changed
+         Called when a view stops being seen, or is seen again. Views start out shown, so a view created hidden gets this straight away.
+         Use this to suspend timers, repaints and subscriptions while a view can't be seen, see SuspendingViewComponent
+         @param nameOfView: name of the view
+         @param view: the component returned by createView
+         @param visibility: whether the view can be seen now, and why not
+         */
+        virtual void viewVisibilityChanged(const juce::String& nameOfView, juce::Component& view, ViewVisibility visibility) {}
+        
+        /**
+         Tab Strip Visibility Changed
+         Called when a view's tab scrolls out of, or back into, the header's tab strip. The view itself may still be shown
+         @param nameOfView: name of the view
+         @param isInTabStrip: whether any of the tab can be seen
+         */
+        virtual void tabStripVisibilityChanged(const juce::String& nameOfView, bool isInTabStrip) {}
     };
     
     
@@ -154,26 +189,66 @@ public:
     /**
      Save Layout
      Save a layout to a file
+     @param format: XML by default, binary is smaller and quicker to load
      */
-    void saveLayout(const juce::File& fileToSave);
+    void saveLayout(const juce::File& fileToSave, LayoutFormat format = LayoutFormat::xml);
    
     /**
      Save Layout
      Save a layout to a file
+     @param format: XML by default, binary is smaller and quicker to load
      */
-    void saveLayout(juce::OutputStream& outputStream);
+    void saveLayout(juce::OutputStream& outputStream, LayoutFormat format = LayoutFormat::xml);
     
     /**
      Open Layouts
-     Should be a valid XML file which was saved via SaveLayout
+     Should be a valid XML or binary file which was saved via SaveLayout, the format is detected
+     @param reconcile: keep the windows and views which survive in the new layout, rather than rebuilding everything.
+     Trees matched by name keep the uuid they had, so only reconcile when nothing holds on to the saved uuids
      */
-    void openLayout(const juce::File& fileToOpen);
+    void openLayout(const juce::File& fileToOpen, bool reconcile = false);
     
     /**
      Open Layouts From Input Stream
-     Should be a valid XML file which was saved via SaveLayout
+     Should be a valid XML or binary file which was saved via SaveLayout, the format is detected
+     @param reconcile: keep the windows and views which survive in the new layout, rather than rebuilding everything.
+     Trees matched by name keep the uuid they had, so only reconcile when nothing holds on to the saved uuids
      */
-    void openLayout(juce::InputStream& inputStream);
+    void openLayout(juce::InputStream& inputStream, bool reconcile = false);
+    
+    /**
+     Autosave
+     Saves the layout to the file whenever it changes, once it has settled for debounceMs, and at the latest
+     maxLatencyMs after the first unsaved change. The layout is copied on the message thread and written on a
+     background thread, then swapped in for the file so it's never left with half a layout
+     @param file: the file to save to, File() turns autosave off
+     @param format: the format to save in
+     */
+    void setAutosave(const juce::File& file, LayoutFormat format = LayoutFormat::xml, int debounceMs = 3000, int maxLatencyMs = 10000);
+    
+    /**
+     Flush Autosave
+     Saves any change autosave hasn't yet, and waits for it to be written
+     @returns false if it couldn't be written
+     */
+    bool flushAutosave();
+    
+    /**
+     Journal
+     Appends every change to the layout to a journal beside the file as it's made, so a crash loses nothing.
+     Each change costs a few bytes however large the layout is, and once the journal passes maxJournalBytes
+     it's folded into a new snapshot in the file. Recover the layout with recoverLayout before starting it again
+     @param file: the snapshot, File() turns the journal off
+     */
+    void setJournal(const juce::File& file, int maxJournalBytes = 1 << 20, LayoutFormat format = LayoutFormat::binary);
+    
+    /**
+     Recover Layout
+     Opens the snapshot a journal kept, with every change it had journaled since replayed over it
+     @param reconcile: as for openLayout
+     @returns false if there was no layout to recover
+     */
+    bool recoverLayout(const juce::File& file, bool reconcile = false);
     
     
     /**
@@ -238,9 +313,27 @@ public:
      */
     void create3Rows(const juce::String& windowName, const juce::StringArray& views);
 
+    /**
+     Lazy Views
+     Tabs which aren't selected wait until they're first selected before creating their view,
+     so only the views which can be seen are built when a layout opens
+     @param lazy: wait for a tab to be selected before creating its view
+     @param prewarm: still create the waiting views, one at a time once there's been no mouse or keyboard input for half a second,
+     leaving at least as long as each one took to build before the next
+     */
+    void setLazyViews(bool lazy, bool prewarm = false);
+    
+    /**
+     Virtual Tab Strip
+     Headers only build tabs for the part of the strip which can be seen, reusing them as it scrolls,
+     and list every tab in a dropdown once they don't all fit. For tab groups with hundreds of tabs
+     @param shouldVirtualise: applies to headers as they next update their tabs
+     */
+    void setVirtualTabStrip(bool shouldVirtualise);
+
     /**
      Get All Components
-     @returns a reference to the underlying view map, so you can access the views and manipulate them
+     @returns a reference to the underlying view map, so you can access the views and manipulate them. Views still waiting to be created aren't in it
      */
     const ViewMap& getAllComponents() const;
 
@@ -275,6 +368,18 @@ private:
     
     /// Get Actual View
     std::shared_ptr<juce::Component> getComponent(const juce::String& withUuid, const juce::String& name);
+    void removeUnusedComponents();
+    
+    /// Lazy Views
+    const bool shouldDeferView(const juce::ValueTree& tree);
+    const bool prewarmNextView();
+    void didReceiveInput();
+    
+    /// View Visibility
+    void updateViewVisibility(const juce::ValueTree& tree);
+    void updateViewVisibility(const juce::ValueTree& tree, Delegate::ViewVisibility visibility);
+    const Delegate::ViewVisibility getViewVisibility(const juce::ValueTree& tree) const;
+    void tabStripVisibilityChanged(const juce::ValueTree& tree, bool isInTabStrip);
     
     /// Popup Menus
     juce::PopupMenu getHeaderPopupMenu(const juce::ValueTree& tree);
@@ -292,10 +397,25 @@ private:
     void valueTreeParentChanged(juce::ValueTree& treeWhoseParentHasChanged) override;
     void valueTreeChildOrderChanged(juce::ValueTree& parentTreeWhoseChildrenHaveMoved, int oldIndex, int newIndex) override;
     void valueTreePropertyChanged(juce::ValueTree& treeWhosePropertyHasChanged, const juce::Identifier& property) override;
+    void scheduleLayoutUpdate();
+    void scheduleAutosave();
+    
+    /// Transactions
+    void transactionDidCommit(const juce::ValueTree& affectedTree) override;
+    void transactionDidEnd() override;
+    void syncWindows();
+    
+    /// Moving Docking Components
+    void registerDockingComponent(const std::shared_ptr<DockingComponent>& component);
+    void forgetDockingComponent(const juce::String& uuid);
+    void detachDockingComponent(const std::shared_ptr<DockingComponent>& component);
+    std::shared_ptr<DockingComponent> reattachDockingComponent(const juce::ValueTree& tree);
 
     /// Drag and Drop Helpers
     void setCreateNewView(bool createNewView);
     void createNewWindow(const juce::String& withViewId, const juce::Point<float>& atPosition);
+    void buildDropZones(const juce::String& draggingId);
+    void clearDropZones();
     
 private:
  
@@ -304,17 +424,25 @@ private:
     
     /// Window Tree
     DockManagerData _data;
+    TreeDispatcher _dispatcher {_data};
     
     /// Windows
-    using WindowMap = juce::HashMap<juce::String, std::shared_ptr<DockingWindow>>;
+    using WindowMap = juce::HashMap<DockUuid, std::shared_ptr<DockingWindow>, DockUuid::HashFunction>;
     WindowMap _windows;
     
     /// Components
     ViewMap _components;
+    
+    /// Docking Components by uuid, so a tree which moves can take its component along
+    juce::HashMap<DockUuid, std::weak_ptr<DockingComponent>, DockUuid::HashFunction> _dockingComponents;
+    juce::HashMap<DockUuid, std::shared_ptr<DockingComponent>, DockUuid::HashFunction> _detachedComponents;
 
     /// Drag and Drop Helper
     bool _createNewView = false;
     
+    /// Drop Zones, only filled while a drag is going on
+    DropZoneIndex _dropZones;
+    
     /// File Chooser
     std::unique_ptr<juce::FileChooser> _fileChooser;
 
@@ -324,6 +452,26 @@ private:
     /// Throttler
     class UpdateThrottler;
     std::unique_ptr<UpdateThrottler> _throttler;
+    juce::uint64 _reportedLayoutHash = 0;
+    
+    /// Autosave
+    std::unique_ptr<LayoutAutosaver> _autosaver;
+    
+    /// Journal
+    std::unique_ptr<LayoutJournal> _journal;
+    
+    /// Lazy Views, hidden tabs wait to be selected, or for the prewarmer to get to them
+    bool _lazyViews = false;
+    bool _prewarmViews = false;
+    juce::StringArray _prewarmQueue;
+    class ViewPrewarmer;
+    std::unique_ptr<ViewPrewarmer> _prewarmer;
+    
+    /// Virtual Tab Strip
+    bool _virtualTabStrip = false;
+    
+    /// View Visibility, only views which can't be seen are in here
+    juce::HashMap<DockUuid, Delegate::ViewVisibility, DockUuid::HashFunction> _hiddenViews;
     
     /// Utility
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DockManager)
@@ -1,15 +1,107 @@
 #include "DockManagerData.h"
+#include "BinaryLayout.h"
+#include "XmlLayout.h"
 #include <regex>
+#include <list>
+#include <unordered_map>
+#include <unordered_set>
 
-DockManagerData::DockManagerData()
+
+/**
+ ===================================
+ MARK: - Matcher Cache -
+ ===================================
+ */
+
+class DockManagerData::MatcherCache
 {
+public:
+    /// Matches a name against a pattern, compiling the pattern once and remembering results
+    const bool matches(const juce::String& pattern, const juce::String& name)
+    {
+        auto& matcher = getMatcher(pattern);
+        auto result = matcher.results.find(name);
+        if (result != matcher.results.end()) {return result->second;}
+        
+        if (matcher.results.size() >= _maxResults)
+            matcher.results.clear();
+        
+        auto stdName = name.toStdString();
+        auto didMatch = std::regex_match(stdName.begin(), stdName.end(), matcher.expression);
+        matcher.results.emplace(name, didMatch);
+        return didMatch;
+    }
+    
+    /// The last search result, valid while the index has not changed
+    const bool getResult(const juce::String& pattern, int indexVersion, juce::String& uuid)
+    {
+        auto& matcher = getMatcher(pattern);
+        if (matcher.indexVersion != indexVersion) {return false;}
+        uuid = matcher.uuid;
+        return true;
+    }
+    
+    void setResult(const juce::String& pattern, int indexVersion, const juce::String& uuid)
+    {
+        auto& matcher = getMatcher(pattern);
+        matcher.indexVersion = indexVersion;
+        matcher.uuid = uuid;
+    }
+    
+private:
+    struct Matcher
+    {
+        Matcher(const juce::String& p) : pattern(p), expression(p.toStdString()) {}
+        
+        juce::String pattern;
+        std::regex expression;
+        std::unordered_map<juce::String, bool> results;
+        int indexVersion = -1;
+        juce::String uuid;
+    };
+    
+    Matcher& getMatcher(const juce::String& pattern)
+    {
+        /// Most recently used at the front
+        auto found = _lookup.find(pattern);
+        if (found != _lookup.end())
+        {
+            _matchers.splice(_matchers.begin(), _matchers, found->second);
+            return _matchers.front();
+        }
+        
+        _matchers.emplace_front(pattern);
+        _lookup[pattern] = _matchers.begin();
+        
+        if (_matchers.size() > _maxMatchers)
+        {
+            _lookup.erase(_matchers.back().pattern);
+            _matchers.pop_back();
+        }
+        
+        return _matchers.front();
+    }
+    
+    const size_t _maxMatchers = 32;
+    const size_t _maxResults = 256;
+    std::list<Matcher> _matchers;
+    std::unordered_map<juce::String, std::list<Matcher>::iterator> _lookup;
+};
+
+
+
+
+
+DockManagerData::DockManagerData() : _matchers(std::make_unique<MatcherCache>())
+{
+    _rootTree.addListener(this);
     setLayoutName("Current Layout"); 
 }
 
 
 DockManagerData::~DockManagerData()
 {
-    
+    _rootTree.removeListener(this);
 }
 
 
@@ -35,67 +127,237 @@ bool DockManagerData::saveAsTemplate(const juce::File& file)
     auto treeToSave = _rootTree.createCopy();
     
     /// Set the Template name as the root
-    treeToSave.setProperty(dockProps::nameProperty, file.getFileNameWithoutExtension(), nullptr);
+    dockNode::set<dockSchema::name>(treeToSave, file.getFileNameWithoutExtension());
     
     /// Remove Window properties.
     for (auto child : treeToSave)
     {
-        child.removeProperty(dockProps::xProperty, nullptr);
-        child.removeProperty(dockProps::yProperty, nullptr);
-        child.removeProperty(dockProps::widthProperty, nullptr);
-        child.removeProperty(dockProps::heightProperty, nullptr);
-        child.removeProperty(dockProps::windowMinimized, nullptr);
-        child.removeProperty(dockProps::windowMaximized, nullptr);
+        dockNode::remove<dockSchema::x>(child);
+        dockNode::remove<dockSchema::y>(child);
+        dockNode::remove<dockSchema::width>(child);
+        dockNode::remove<dockSchema::height>(child);
+        dockNode::remove<dockSchema::minimized>(child);
+        dockNode::remove<dockSchema::maximized>(child);
     }
     
-    
-    auto xml = treeToSave.createXml();
-    if (!xml) {return false;}
-    return xml->writeTo(fileToSave);
+    return writeLayout(treeToSave, fileToSave, LayoutFormat::xml);
 }
 
 
-bool DockManagerData::saveToFile(const juce::File& file)
+bool DockManagerData::saveToFile(const juce::File& file, LayoutFormat format)
 {
     if (!file.existsAsFile())
         file.create();
-        
-    auto xml = _rootTree.createXml();
-    if (!xml) {return false;}
-    return xml->writeTo(file);
+    
+    return writeLayout(_rootTree, file, format);
 }
 
 
-bool DockManagerData::saveLayout(juce::OutputStream& outputStream)
+bool DockManagerData::saveLayout(juce::OutputStream& outputStream, LayoutFormat format)
 {
-    auto xml = _rootTree.createXml();
-    if (!xml) {return false;}
-    xml->writeTo(outputStream);
-    return true;
+    return writeLayout(_rootTree, outputStream, format);
 }
 
 
-bool DockManagerData::openFromFile(const juce::File& file)
+bool DockManagerData::openFromFile(const juce::File& file, bool reconcile)
 {
     if (!file.existsAsFile()) {return false;}
-    auto xml = juce::parseXML(file);
-    if (!xml) {return false;}
+    juce::FileInputStream stream(file);
+    if (!stream.openedOk()) {return false;}
+    return loadLayout(readLayout(stream), reconcile);
+}
+
+
+bool DockManagerData::openLayout(juce::InputStream& inputStream, bool reconcile)
+{
+    return loadLayout(readLayout(inputStream), reconcile);
+}
+
+
+bool DockManagerData::writeLayout(const juce::ValueTree& layout, juce::OutputStream& outputStream, LayoutFormat format)
+{
+    /// Both write straight from the tree, XML in the same bytes as createXml()->writeTo()
+    return format == LayoutFormat::binary ? BinaryLayout::write(layout, outputStream)
+                                          : XmlLayout::write(layout, outputStream);
+}
+
+
+bool DockManagerData::writeLayout(const juce::ValueTree& layout, const juce::File& file, LayoutFormat format)
+{
+    /// Written next to the file and swapped in, as XmlElement::writeTo does
+    juce::TemporaryFile tempFile(file);
+    {
+        juce::FileOutputStream stream(tempFile.getFile());
+        if (!stream.openedOk() || !writeLayout(layout, stream, format)) {return false;}
+        stream.flush();
+    }
+    
+    return tempFile.overwriteTargetFileWithTemporary();
+}
+
+
+juce::ValueTree DockManagerData::readLayout(juce::InputStream& inputStream)
+{
+    /// The format is told by the first bytes, XML can't start with the binary magic
+    juce::MemoryBlock block;
+    inputStream.readIntoMemoryBlock(block);
+    if (BinaryLayout::isBinaryLayout(block.getData(), block.getSize()))
+        return BinaryLayout::read(block.getData(), block.getSize());
+    
+    auto xml = juce::parseXML(juce::MemoryInputStream(block, false).readEntireStreamAsString());
+    return xml ? juce::ValueTree::fromXml(*xml) : juce::ValueTree();
+}
+
+
+bool DockManagerData::loadLayout(const juce::ValueTree& layout, bool reconcile)
+{
+    if (!layout.isValid()) {return false;}
+    if (reconcile)
+        return reconcileLayout(layout);
+    
+    /// Listeners rebuild once the whole layout is in place
+    ScopedTransaction transaction(*this);
     _rootTree.removeAllChildren(nullptr);
-    _rootTree.copyPropertiesAndChildrenFrom(juce::ValueTree::fromXml(*xml), nullptr);
+    const juce::ScopedValueSetter<bool> adding(_isAddingTrees, true);
+    _rootTree.copyPropertiesAndChildrenFrom(layout, nullptr);
     return true;
 }
 
 
-bool DockManagerData::openLayout(juce::InputStream& inputStream)
+
+
+
+/**
+ ===================================
+ MARK: - Reconcile -
+ ===================================
+ */
+
+bool DockManagerData::reconcileLayout(const juce::ValueTree& layout)
 {
-    auto xml = juce::parseXML(inputStream.readEntireStreamAsString());
-    if (!xml) {return false;}
-    _rootTree.removeAllChildren(nullptr);
-    _rootTree.copyPropertiesAndChildrenFrom(juce::ValueTree::fromXml(*xml), nullptr);
+    if (!layout.isValid()) {return false;}
+    
+    /// Work on a copy, matching rewrites its uuids
+    auto layoutToSync = layout.createCopy();
+    matchTrees(layoutToSync);
+    
+    ScopedTransaction transaction(*this);
+    syncTree(_rootTree, layoutToSync);
+    pruneTree(_rootTree, layoutToSync);
     return true;
 }
 
 
+void DockManagerData::matchTrees(juce::ValueTree& layout) const
+{
+    /// Uuids which match as they are
+    std::unordered_set<juce::String> layoutIds;
+    std::function<void(const juce::ValueTree&)> addLayoutIds = [&](const juce::ValueTree& tree)
+    {
+        for (const auto& child : tree)
+        {
+            layoutIds.insert(getUuid(child));
+            addLayoutIds(child);
+        }
+    };
+    addLayoutIds(layout);
+    
+    /// Live trees which nothing claims by uuid, by type and name
+    auto getKey = [this](const juce::ValueTree& tree) {return tree.getType().toString() + "/" + getName(tree);};
+    std::unordered_map<juce::String, juce::Array<juce::ValueTree>> freeTrees;
+    std::function<void(const juce::ValueTree&)> addFreeTrees = [&](const juce::ValueTree& tree)
+    {
+        for (const auto& child : tree)
+        {
+            if (layoutIds.count(getUuid(child)) == 0 && getName(child).isNotEmpty())
+                freeTrees[getKey(child)].add(child);
+            addFreeTrees(child);
+        }
+    };
+    addFreeTrees(_rootTree);
+    
+    /// Claim them top down, preferring one that already sits in the matched parent
+    juce::HashMap<juce::String, juce::String> claimedIds;
+    std::function<void(juce::ValueTree, const juce::ValueTree&)> claimTrees = [&](juce::ValueTree layoutTree, const juce::ValueTree& parent)
+    {
+        for (auto child : layoutTree)
+        {
+            auto uuid = getUuid(child);
+            auto candidates = freeTrees.find(getKey(child));
+            if (!findTree(uuid).isValid() && candidates != freeTrees.end() && !candidates->second.isEmpty())
+            {
+                auto index = 0;
+                for (auto i = 0; i < candidates->second.size(); i++)
+                    if (candidates->second[i].getParent() == parent) {index = i; break;}
+                
+                auto claimedId = getUuid(candidates->second.removeAndReturn(index));
+                claimedIds.set(uuid, claimedId);
+                dockNode::set<dockSchema::uuid>(child, claimedId);
+            }
+            claimTrees(child, findTree(getUuid(child)));
+        }
+    };
+    claimTrees(layout, _rootTree);
+    
+    /// Selected tabs follow their tree
+    std::function<void(juce::ValueTree)> updateSelected = [&](juce::ValueTree tree)
+    {
+        auto selected = getSelectedId(tree);
+        if (claimedIds.contains(selected))
+            dockNode::set<dockSchema::selected>(tree, claimedIds[selected]);
+        for (auto child : tree)
+            updateSelected(child);
+    };
+    updateSelected(layout);
+}
+
+
+void DockManagerData::syncTree(juce::ValueTree tree, const juce::ValueTree& layoutTree)
+{
+    /// Only changed properties notify
+    tree.copyPropertiesFrom(layoutTree, nullptr);
+    
+    for (auto i = 0; i < layoutTree.getNumChildren(); i++)
+    {
+        auto layoutChild = layoutTree.getChild(i);
+        auto child = findTree(getUuid(layoutChild));
+        
+        /// Create what could not be matched
+        if (!child.isValid() || child.getType() != layoutChild.getType() || child == tree || tree.isAChildOf(child))
+        {
+            child = juce::ValueTree(layoutChild.getType());
+            child.copyPropertiesFrom(layoutChild, nullptr);
+        }
+        
+        /// Move it into place
+        if (child.getParent() == tree)
+        {
+            tree.moveChild(tree.indexOf(child), i, nullptr);
+        }
+        else
+        {
+            auto parent = child.getParent();
+            if (parent.isValid())
+                parent.removeChild(child, nullptr);
+            addChild(tree, child, i);
+        }
+        
+        syncTree(child, layoutChild);
+    }
+}
+
+
+void DockManagerData::pruneTree(juce::ValueTree tree, const juce::ValueTree& layoutTree)
+{
+    /// Synced children come first, anything after them was not claimed
+    while (tree.getNumChildren() > layoutTree.getNumChildren())
+        tree.removeChild(tree.getNumChildren() - 1, nullptr);
+    
+    for (auto i = 0; i < tree.getNumChildren(); i++)
+        pruneTree(tree.getChild(i), layoutTree.getChild(i));
+}
+
+
 
 
 
@@ -107,17 +369,17 @@ bool DockManagerData::openLayout(juce::InputStream& inputStream)
 
 const std::pair<juce::String, juce::String> DockManagerData::addNewWindow(const juce::String& named, const juce::Rectangle<float> bounds)
 {
-    auto windowTree = juce::ValueTree(dockIds::windowIdentifier);
+    auto windowTree = dockNode::create<dockSchema::window>();
     auto uuid = juce::Uuid().toString();
     
-    windowTree.setProperty(dockProps::uuidProperty, uuid, nullptr);
+    dockNode::set<dockSchema::uuid>(windowTree, uuid);
     if (!bounds.isEmpty())
         setBounds(windowTree, bounds);
     
     setName(windowTree, named);
     
     /// Add to Root Tree
-    _rootTree.addChild(windowTree, -1, nullptr);
+    addChild(_rootTree, windowTree, -1);
     
     /// Add Root View
     auto rootId = addRootView(uuid);
@@ -146,13 +408,13 @@ const juce::String DockManagerData::addRootView(const juce::String& toWindow)
     auto window = findTree(toWindow);
     if (!window.isValid()) {return "";}
     auto id = juce::Uuid().toString();
-    auto tree = juce::ValueTree(dockIds::rootTreeIdentifier);
-    tree.setProperty(dockProps::uuidProperty, id, nullptr);
+    auto tree = dockNode::create<dockSchema::root>();
+    dockNode::set<dockSchema::uuid>(tree, id);
     setName(tree, dockIds::rootTreeIdentifier);
     setDockType(tree, DockTypes::none);
     
     /// Add Child
-    window.addChild(tree, -1, nullptr);
+    addChild(window, tree, -1);
     
     /// Return Id
     return id;
@@ -169,8 +431,8 @@ const juce::String DockManagerData::addRootView(const juce::String& toWindow)
 juce::ValueTree DockManagerData::getNewView(const juce::String viewName, DockTypes dockAt)
 {
     auto viewId = juce::Uuid().toString();
-    auto viewTree = juce::ValueTree(dockIds::viewIdentifier);
-    viewTree.setProperty(dockProps::uuidProperty, viewId, nullptr);
+    auto viewTree = dockNode::create<dockSchema::view>();
+    dockNode::set<dockSchema::uuid>(viewTree, viewId);
     setName(viewTree, viewName.isEmpty() ? getRandomName() : viewName);
     setDockType(viewTree, dockAt);
     return viewTree;
@@ -186,7 +448,7 @@ const juce::String DockManagerData::addView(const juce::String& toView, const ju
     auto viewTree = getNewView(viewName, dockAt);
     
     /// Add to Window
-    treeToAddTo.addChild(viewTree, -1, nullptr);
+    addChild(treeToAddTo, viewTree, -1);
     
     /// Return the View Id;
     return getUuid(viewTree);
@@ -199,6 +461,9 @@ void DockManagerData::removeView(const juce::String& viewid)
     if (!isView(view)) {return;}
     auto viewParent = view.getParent();
     if (!viewParent.isValid()) {return;}
+    
+    /// Orphan checks move trees, keep their components
+    ScopedTransaction transaction(*this);
     viewParent.removeChild(view, nullptr);
 
     /// Check for Selected Tab
@@ -217,6 +482,8 @@ void DockManagerData::removeViewAndChildren(const juce::String& viewid)
     if (!isView(view)) {return;}
     auto viewParent = view.getParent();
     if (!viewParent.isValid()) {return;}
+    
+    ScopedTransaction transaction(*this);
     view.removeAllChildren(nullptr);
     viewParent.removeChild(view, nullptr);
     
@@ -232,7 +499,7 @@ void DockManagerData::removeViewAndChildren(const juce::String& viewid)
 
 bool DockManagerData::showView(const juce::String& viewName)
 {
-    auto tree = findTree(dockProps::nameProperty, viewName, _rootTree);
+    auto tree = findTreeWithName(viewName);
     if (!tree.isValid()) {return false;}
     if (getDockType(tree.getParent()) == DockTypes::tabs)
     {
@@ -262,6 +529,9 @@ void DockManagerData::openInNewWindow(const juce::String& treeId, const juce::Po
 {
     auto tree = findTree(treeId);
     if (!tree.isValid()) {return;}
+    
+    /// Moves the tree, keep its components
+    ScopedTransaction transaction(*this);
     removeChildFromParent(tree);
     dockInNewWindow(tree, position, bounds);
 }
@@ -277,12 +547,7 @@ void DockManagerData::createInNewWindow(const juce::String& viewName, const juce
 
 void DockManagerData::openViewAsNewTab(const juce::String& viewName, const juce::String& regex, DropLocation fallbackType)
 {
-    auto expr = std::regex(regex.toStdString());
-    auto treeToOpenIn = findTree(_rootTree, [expr](const juce::ValueTree& tree)->bool {
-        if (!tree.hasProperty(dockProps::nameProperty)) {return false;}
-        auto name = tree.getProperty(dockProps::nameProperty).toString().toStdString();
-        return std::regex_match(name.begin(), name.end(), expr);
-    });
+    auto treeToOpenIn = findTreeMatching(regex);
     
     if (treeToOpenIn.isValid())
     {
@@ -312,7 +577,8 @@ const juce::String DockManagerData::dockNewView(const juce::String& viewToDockIn
     /// Index
     auto index = getIndexForLocation(location);
 
-    /// Dock view
+    /// Dock view, splitting may move existing trees
+    ScopedTransaction transaction(*this);
     auto status = dockView(treeToDock, treeToDockIn, location, index);
     
     /// Return new tree
@@ -333,6 +599,9 @@ void DockManagerData::dockView(const juce::String& viewToDock, const juce::Strin
     /// Index
     auto newIndex = location == DropLocation::tabs ? index : getIndexForLocation(location);
     
+    /// Move as one transaction so the components are transplanted rather than rebuilt
+    ScopedTransaction transaction(*this);
+    
     /// Remove From Parent
     removeChildFromParent(treeToDock);
     
@@ -382,7 +651,7 @@ bool DockManagerData::dockInView(juce::ValueTree treeToDock, juce::ValueTree tre
     auto newIndex = treeToDockIn.getParent().indexOf(treeToDockIn) + indexAdd;
     
     /// Dock In View
-    treeToDockIn.addChild(treeToDock, isTabs ? index : newIndex, nullptr);
+    addChild(treeToDockIn, treeToDock, isTabs ? index : newIndex);
     
     /// Set Selected Tab
     if (isTabs)
@@ -414,7 +683,7 @@ bool DockManagerData::dockInParent(juce::ValueTree treeToDock, juce::ValueTree t
         /// Check that there is a place to dock the view.
         auto newTree = addAndMoveTree(treeToDockIn, dockType);
         if (newTree.isValid())
-            newTree.addChild(treeToDock, index, nullptr);
+            addChild(newTree, treeToDock, index);
                 
         /// Set Selected Tab
         if (dockLocation == DropLocation::tabs)
@@ -433,7 +702,7 @@ bool DockManagerData::dockInParent(juce::ValueTree treeToDock, juce::ValueTree t
         auto newIndex = treeToDockIn.getParent().indexOf(treeToDockIn) + indexAdd;
         
         /// Dock the child at the index
-        parentToDockIn.addChild(treeToDock, newIndex, nullptr);
+        addChild(parentToDockIn, treeToDock, newIndex);
 
         /// Set Selected Tab
         if (dockLocation == DropLocation::tabs)
@@ -476,7 +745,7 @@ bool DockManagerData::dockInRoot(juce::ValueTree treeToDock, juce::ValueTree tre
     if (!newView.isValid()) {return false;}
     
     /// Add View to new View
-    newView.addChild(treeToDock, index, nullptr);
+    addChild(newView, treeToDock, index);
     
     /// Check for Orphans
     checkForOrphanedTrees();
@@ -494,7 +763,7 @@ bool DockManagerData::dockInNewWindow(juce::ValueTree treeToDock, juce::Point<fl
     if (!rootView.isValid()) {return false;}
     
     /// Add to root view for window
-    rootView.addChild(treeToDock, -1, nullptr);
+    addChild(rootView, treeToDock, -1);
     auto size = getSize(window);
     setPosition(window, dropPosition.withX(dropPosition.getX() - size.getX()/2));
     
@@ -514,8 +783,32 @@ bool DockManagerData::dockInNewWindow(juce::ValueTree treeToDock, juce::Point<fl
 
 void DockManagerData::checkForOrphanedTrees()
 {
+    /// Nothing changed since the last check, which left the layout without orphans
+    if (_isCheckingForOrphans) {return;}
+    if (_orphanCheckTrees.size() == 0 && !_needsWholeOrphanCheck && !_checksWholeLayout) {return;}
+    
+    _isCheckingForOrphans = true;
+    /// A walk through a small layout costs less than finding the paths through it
+    auto isSmallLayout = _walksSmallLayouts && _uuidIndex.size() <= treesWalkedPerOrphanCheckPath * _orphanCheckTrees.size();
+    _isCheckingWholeLayout = _checksWholeLayout || _needsWholeOrphanCheck || isSmallLayout || !buildOrphanCheckPaths();
+    _needsWholeOrphanCheck = false;
+    _orphanCheckTrees.clear();
+    if (_isCheckingWholeLayout)
+        _uncheckedTrees.clear();
+    
     checkForOrphanedTreesIn(_rootTree);
     checkForOrphanedWindows();
+    
+    /// Changed trees it didn't reach, ie inside one it moved, wait for the next check as they would have
+    for (TreeSet::Iterator it(_uncheckedTrees); it.next();)
+        if (it.getValue().isAChildOf(_rootTree))
+            markForOrphanCheck(it.getValue(), false);
+    
+    _uncheckedTrees.clear();
+    _orphanCheckPaths.clear();
+    _removedTrees.clear();
+    _isCheckingWholeLayout = false;
+    _isCheckingForOrphans = false;
 }
 
 
@@ -525,6 +818,11 @@ void DockManagerData::checkForOrphanedTreesIn(juce::ValueTree tree)
     {
         auto child = tree.getChild(i);
         if (!child.isValid()) {continue;}
+        
+        /// Nothing in it has changed since it was last checked
+        if (!isOnOrphanCheckPath(child)) {continue;}
+        didCheckForOrphans(child);
+        
         auto shouldRemoveEmptyDockType = getDockType(child) != DockTypes::none
                                             && !isRootTree(child)
                                             && child.getNumChildren() == 1
@@ -539,11 +837,17 @@ void DockManagerData::checkForOrphanedTreesIn(juce::ValueTree tree)
             auto index = tree.indexOf(child);
             child.removeChild(treeToMove, nullptr);
             tree.removeChild(child, nullptr);
-            tree.addChild(treeToMove, index, nullptr);
-            if (child.hasProperty(dockProps::widthProperty))
+            addChild(tree, treeToMove, index);
+            if (getSelectedId(tree) == getUuid(child))
+                setSelected(tree, getUuid(treeToMove));
+            if (dockNode::has<dockSchema::width>(child))
                 setWidth(treeToMove, getWidth(child));
-            if (child.hasProperty(dockProps::heightProperty))
+            if (dockNode::has<dockSchema::height>(child))
                 setHeight(treeToMove, getHeight(child));
+            
+            /// The next tree moves into an empty tab's place and is passed over, nothing says what's in it
+            if (shouldRemoveEmptyTab && _isCheckingWholeLayout && i < tree.getNumChildren())
+                markForOrphanCheck(tree.getChild(i), true);
         }
         
         else
@@ -554,16 +858,123 @@ void DockManagerData::checkForOrphanedTreesIn(juce::ValueTree tree)
 
 void DockManagerData::checkForOrphanedWindows()
 {
-    for (auto i = 0; i < _rootTree.getNumChildren(); i++)
+    auto isOrphaned = [](const juce::ValueTree& window) {return window.getNumChildren() == 0 || window.getChild(0).getNumChildren() == 0;};
+    if (_isCheckingWholeLayout)
     {
-        auto child = _rootTree.getChild(i);
-        if (!child.isValid()) {continue;}
-        if (child.getNumChildren() == 0 || child.getChild(0).getNumChildren() == 0)
-            _rootTree.removeChild(child, nullptr);
+        for (auto i = 0; i < _rootTree.getNumChildren(); i++)
+        {
+            auto child = _rootTree.getChild(i);
+            if (!child.isValid()) {continue;}
+            if (isOrphaned(child))
+            {
+                _rootTree.removeChild(child, nullptr);
+                if (i < _rootTree.getNumChildren())
+                    markForOrphanCheck(_rootTree.getChild(i), false);
+            }
+        }
+        return;
+    }
+    
+    /// Only the windows something changed in, in order
+    juce::Array<std::pair<int, juce::ValueTree>> windows;
+    for (TreeSet::Iterator it(_orphanCheckPaths); it.next();)
+        if (it.getValue().getParent() == _rootTree)
+            windows.add({_rootTree.indexOf(it.getValue()), it.getValue()});
+    std::sort(windows.begin(), windows.end(), [](const auto& a, const auto& b) {return a.first < b.first;});
+    
+    /// A window moving into the place of one removed is passed over until the next check
+    auto passedOver = -1;
+    for (const auto& [index, window] : windows)
+    {
+        if (index == passedOver)
+            markForOrphanCheck(window, false);
+        else if (isOrphaned(window))
+        {
+            _rootTree.removeChild(window, nullptr);
+            passedOver = index + 1;
+        }
     }
 }
 
 
+void DockManagerData::markForOrphanCheck(const juce::ValueTree& tree, bool withChildren)
+{
+    /// Windows coming and going leave no orphans
+    if (!tree.isValid() || tree == _rootTree) {return;}
+    
+    /// Without a uuid of its own, a tree can't be told apart from another
+    auto uuid = DockUuid(getUuid(tree));
+    if (uuid.isNull())
+        _needsWholeOrphanCheck = true;
+    else if (_orphanCheckTrees.contains(uuid) && _orphanCheckTrees[uuid] != tree && _orphanCheckTrees[uuid].isAChildOf(_rootTree))
+        _needsWholeOrphanCheck = true;
+    else
+        _orphanCheckTrees.set(uuid, tree);
+    
+    if (withChildren)
+        for (const auto& child : tree)
+            markForOrphanCheck(child, true);
+}
+
+
+const bool DockManagerData::isOnOrphanCheckPath(const juce::ValueTree& tree) const
+{
+    return _isCheckingWholeLayout || contains(_orphanCheckPaths, tree, DockUuid(getUuid(tree)));
+}
+
+
+const bool DockManagerData::buildOrphanCheckPaths()
+{
+    _orphanCheckPaths.clear();
+    _uncheckedTrees.clear();
+    for (TreeSet::Iterator it(_orphanCheckTrees); it.next();)
+    {
+        /// Re-keyed since, and marked again under its new uuid
+        auto tree = it.getValue();
+        if (DockUuid(getUuid(tree)) != it.getKey()) {continue;}
+        
+        /// Up to the root, or a path already taken, dropped if it has since left the layout
+        juce::Array<std::pair<DockUuid, juce::ValueTree>> path;
+        auto isInLayout = false;
+        for (auto parent = tree; parent.isValid(); parent = parent.getParent())
+        {
+            if (parent == _rootTree) {isInLayout = true; break;}
+            auto uuid = DockUuid(getUuid(parent));
+            if (uuid.isNull()) {return false;}
+            if (_orphanCheckPaths.contains(uuid))
+            {
+                if (_orphanCheckPaths[uuid] != parent) {return false;}
+                isInLayout = true;
+                break;
+            }
+            path.add({uuid, parent});
+        }
+        
+        if (!isInLayout) {continue;}
+        for (const auto& [uuid, parent] : path)
+            _orphanCheckPaths.set(uuid, parent);
+        _uncheckedTrees.set(it.getKey(), tree);
+    }
+    
+    return true;
+}
+
+
+void DockManagerData::didCheckForOrphans(const juce::ValueTree& tree)
+{
+    if (_isCheckingWholeLayout) {return;}
+    auto uuid = DockUuid(getUuid(tree));
+    if (contains(_uncheckedTrees, tree, uuid))
+        _uncheckedTrees.remove(uuid);
+}
+
+
+const bool DockManagerData::contains(const TreeSet& trees, const juce::ValueTree& tree, const DockUuid& uuid)
+{
+    return !uuid.isNull() && trees.contains(uuid) && trees[uuid] == tree;
+}
+
+
 
 /**
  ===================================
@@ -579,8 +990,12 @@ juce::ValueTree DockManagerData::addAndMoveTree(const juce::ValueTree& tree, Doc
     auto index = parent.indexOf(tree);
     parent.removeChild(tree, nullptr);
     auto newViewTree = getNewView("", type);
-    parent.addChild(newViewTree, index, nullptr);
-    newViewTree.addChild(tree, -1, nullptr);
+    addChild(parent, newViewTree, index);
+    addChild(newViewTree, tree, -1);
+    
+    /// A selected tab stays selected in what now wraps it
+    if (getSelectedId(parent) == getUuid(tree))
+        setSelected(parent, getUuid(newViewTree));
     return newViewTree;
 }
 
@@ -621,7 +1036,7 @@ const juce::String DockManagerData::getUuid(const juce::ValueTree& tree) const
     if (!tree.isValid())
         return "";
     
-    return tree.getProperty(dockProps::uuidProperty);
+    return dockNode::get<dockSchema::uuid>(tree);
 }
 
 
@@ -651,8 +1066,8 @@ const juce::Point<float> DockManagerData::getPosition(const juce::String& uuid)
 
 const juce::Point<float> DockManagerData::getPosition(const juce::ValueTree& fromTree) const
 {
-    auto x = getProperty<float>(fromTree, dockProps::xProperty);
-    auto y = getProperty<float>(fromTree, dockProps::yProperty);
+    auto x = dockNode::get<dockSchema::x>(fromTree);
+    auto y = dockNode::get<dockSchema::y>(fromTree);
     return {x, y};
 }
 
@@ -674,13 +1089,13 @@ const juce::Point<float> DockManagerData::getSize(const juce::ValueTree& fromTre
 
 const float DockManagerData::getWidth(const juce::ValueTree& tree) const
 {
-    return getProperty<float>(tree, dockProps::widthProperty);
+    return dockNode::get<dockSchema::width>(tree);
 }
 
 
 const float DockManagerData::getHeight(const juce::ValueTree& tree) const
 {
-    return getProperty<float>(tree, dockProps::heightProperty);
+    return dockNode::get<dockSchema::height>(tree);
 }
 
 
@@ -694,7 +1109,7 @@ const juce::String DockManagerData::getName(const juce::String& uuid) const
 
 const juce::String DockManagerData::getName(const juce::ValueTree& fromTree) const
 {
-    return getProperty<juce::String>(fromTree, dockProps::nameProperty);
+    return dockNode::get<dockSchema::name>(fromTree);
 }
 
 
@@ -708,17 +1123,13 @@ const DockTypes DockManagerData::getDockType(const juce::String& uuid) const
 
 const DockTypes DockManagerData::getDockType(const juce::ValueTree& fromTree) const
 {
-    auto type = getProperty<int>(fromTree, dockProps::dockType);
-    return DockTypes(type);
+    return dockNode::get<dockSchema::dockType>(fromTree);
 }
 
 
 const juce::String DockManagerData::getSelectedId(const juce::ValueTree& tree) const
 {
-    if (tree.hasProperty(dockProps::selectedProperty))
-        return getProperty<juce::String>(tree, dockProps::selectedProperty);
-    else
-        return "";
+    return dockNode::get<dockSchema::selected>(tree);
 }
 
 
@@ -732,16 +1143,24 @@ const bool DockManagerData::isWindowLocked(const juce::ValueTree& tree) const
 {
     auto window = findWindow(tree);
     if (!window.isValid() || !isWindow(window)) {return false;}
-    return getProperty<bool>(window, dockProps::lockedProperty);
+    return dockNode::get<dockSchema::locked>(window);
+}
+
+
+const bool DockManagerData::isWindowMinimized(const juce::ValueTree& tree) const
+{
+    auto window = findWindow(tree);
+    if (!window.isValid() || !isWindow(window)) {return false;}
+    return dockNode::get<dockSchema::minimized>(window);
 }
 
 
 template <typename T>
-const T DockManagerData::getProperty(const juce::ValueTree& tree, const juce::String& propId) const
+const T DockManagerData::getProperty(const juce::ValueTree& tree, const juce::Identifier& propId) const
 {
-    if (!tree.isValid() || !tree.hasProperty(propId)) {return T();}
-    T property = tree.getProperty(propId);
-    return property;
+    auto property = tree.getPropertyPointer(propId);
+    if (property == nullptr) {return T();}
+    return *property;
 }
 
 
@@ -800,9 +1219,9 @@ const bool DockManagerData::isViewDropLocation(DropLocation drop) const
 
 juce::ValueTree DockManagerData::getParentForDropType(const juce::ValueTree& tree, DockTypes type) const
 {
-    auto parent = searchParentsFor(tree, dockProps::dockType, (int)type);
+    auto parent = searchParentsFor(tree, dockNode::getId<dockSchema::dockType>(), (int)type);
     if (parent.isValid()) {return parent;}
-    return searchParentsFor(tree, dockProps::dockType, (int)DockTypes::none);
+    return searchParentsFor(tree, dockNode::getId<dockSchema::dockType>(), (int)DockTypes::none);
 }
 
 
@@ -840,7 +1259,7 @@ void DockManagerData::setWindowMinimized(const juce::String& windowId, bool mini
 {
     auto window = findTree(windowId);
     if (!window.isValid() || !isWindow(window)) {return;}
-    window.setProperty(dockProps::windowMinimized, minimized, nullptr);
+    dockNode::set<dockSchema::minimized>(window, minimized);
 }
 
 
@@ -848,7 +1267,7 @@ void DockManagerData::setWindowMaximized(const juce::String& windowId, bool maxi
 {
     auto window = findTree(windowId);
     if (!window.isValid() || !isWindow(window)) {return;}
-    window.setProperty(dockProps::windowMaximized, maximised, nullptr);
+    dockNode::set<dockSchema::maximized>(window, maximised);
 }
 
 
@@ -856,7 +1275,7 @@ void DockManagerData::setWindowLocked(const juce::String& windowId, bool locked)
 {
     auto window = findTree(windowId);
     if (!window.isValid() || !isWindow(window)) {return;}
-    window.setProperty(dockProps::lockedProperty, locked, nullptr);
+    dockNode::set<dockSchema::locked>(window, locked);
 }
 
 
@@ -923,13 +1342,13 @@ void DockManagerData::setY(juce::String& uuid, float y)
 
 void DockManagerData::setX(juce::ValueTree& tree, float x)
 {
-    tree.setProperty(dockProps::xProperty, x, nullptr);
+    dockNode::set<dockSchema::x>(tree, x);
 }
 
 
 void DockManagerData::setY(juce::ValueTree& tree, float y)
 {
-    tree.setProperty(dockProps::yProperty, y, nullptr);
+    dockNode::set<dockSchema::y>(tree, y);
 }
 
 
@@ -952,13 +1371,13 @@ void DockManagerData::setHeight(juce::String& uuid, float height)
 
 void DockManagerData::setWidth(juce::ValueTree& tree, float width)
 {
-    tree.setProperty(dockProps::widthProperty, juce::jmax<float>(width, 5), nullptr);
+    dockNode::set<dockSchema::width>(tree, juce::jmax<float>(width, 5));
 }
 
 
 void DockManagerData::setHeight(juce::ValueTree& tree, float height)
 {
-    tree.setProperty(dockProps::heightProperty, juce::jmax<float>(height, 5), nullptr);
+    dockNode::set<dockSchema::height>(tree, juce::jmax<float>(height, 5));
 }
 
 
@@ -972,7 +1391,7 @@ void DockManagerData::setDockType(juce::String& uuid, DockTypes type)
 
 void DockManagerData::setDockType(juce::ValueTree& tree, DockTypes type)
 {
-    tree.setProperty(dockProps::dockType, (int)type, nullptr);
+    dockNode::set<dockSchema::dockType>(tree, type);
 }
 
 
@@ -986,13 +1405,13 @@ void DockManagerData::setName(juce::String& uuid, const juce::String& name)
 
 void DockManagerData::setName(juce::ValueTree& tree, const juce::String& name)
 {
-    tree.setProperty(dockProps::nameProperty, name, nullptr);
+    dockNode::set<dockSchema::name>(tree, name);
 }
 
 
 void DockManagerData::setSelected(juce::ValueTree& tree, const juce::String& uuid)
 {
-    tree.setProperty(dockProps::selectedProperty, uuid, nullptr);
+    dockNode::set<dockSchema::selected>(tree, uuid);
 }
 
 
@@ -1006,19 +1425,19 @@ void DockManagerData::setSelected(juce::ValueTree& tree, const juce::String& uui
 
 const bool DockManagerData::isWindow(const juce::ValueTree& tree) const
 {
-    return tree.isValid() && tree.getType().toString() == dockIds::windowIdentifier;
+    return dockNode::isType<dockSchema::window>(tree);
 }
 
 
 const bool DockManagerData::isView(const juce::ValueTree& tree) const
 {
-    return tree.isValid() && tree.getType().toString() == dockIds::viewIdentifier;
+    return dockNode::isType<dockSchema::view>(tree);
 }
 
 
 const bool DockManagerData::isRootTree(const juce::ValueTree& tree) const
 {
-    return tree.isValid() && tree.getType().toString() == dockIds::rootTreeIdentifier;
+    return dockNode::isType<dockSchema::root>(tree);
 }
 
 
@@ -1036,7 +1455,7 @@ const bool DockManagerData::isRootTree(const juce::String& treeId) const
 
 juce::ValueTree DockManagerData::getRootView(const juce::ValueTree& tree) const
 {
-    return searchParentsFor<juce::String>(tree, dockProps::nameProperty, dockIds::rootTreeIdentifier);
+    return searchParentsFor<juce::String>(tree, dockNode::getId<dockSchema::name>(), dockIds::rootTreeIdentifier);
 }
 
 
@@ -1086,7 +1505,7 @@ const std::pair<juce::String, int> DockManagerData::getTreeForDockLocation(const
     int index = -1;
     for (auto child : parent)
     {
-        if (findTree(dockProps::uuidProperty, treeId, child).isValid())
+        if (child == tree || tree.isAChildOf(child))
         {
             index = parent.indexOf(child);
             break;
@@ -1099,7 +1518,77 @@ const std::pair<juce::String, int> DockManagerData::getTreeForDockLocation(const
 
 const juce::ValueTree DockManagerData::findTree(const juce::String& withUuid) const
 {
-    return findTree(dockProps::uuidProperty, withUuid, _rootTree);
+    if (withUuid.isEmpty()) {return juce::ValueTree();}
+    
+    /// The text is already in hand, so the tree found is checked against it rather than parsing its uuid again
+    auto uuid = DockUuid(withUuid);
+    if (_uuidIndex.contains(uuid))
+    {
+        const auto& tree = _uuidIndex.getReference(uuid).tree;
+        if (isIndexed(tree, withUuid)) {return tree;}
+    }
+    
+    return findTree(uuid);
+}
+
+
+const juce::ValueTree DockManagerData::findTree(const DockUuid& withUuid) const
+{
+    if (withUuid.isNull()) {return juce::ValueTree();}
+    
+    /// Indexed
+    if (_uuidIndex.contains(withUuid))
+    {
+        const auto& tree = _uuidIndex.getReference(withUuid).tree;
+        if (isIndexed(tree, withUuid)) {return tree;}
+        _uuidIndex.remove(withUuid);
+    }
+    
+    /// The listener keeps every tree in the layout indexed, so a miss is a uuid which isn't in it, unless
+    /// it's one the data is adding and the listener hasn't heard of yet
+    if (_isAddingTrees)
+        return findTree(dockProps::uuidProperty, withUuid.toString(), _rootTree);
+    
+    return juce::ValueTree();
+}
+
+
+const juce::ValueTree DockManagerData::findTreeWithName(const juce::String& name) const
+{
+    /// First in tree order, like a depth first search
+    auto uuids = _nameIndex.find(name);
+    if (uuids == _nameIndex.end()) {return juce::ValueTree();}
+    
+    juce::ValueTree first;
+    for (const auto& uuid : uuids->second)
+    {
+        auto tree = findTree(uuid);
+        if (getName(tree) != name) {continue;}
+        if (!first.isValid() || isBefore(tree, first))
+            first = tree;
+    }
+    
+    return first;
+}
+
+
+const juce::ValueTree DockManagerData::findTreeMatching(const juce::String& regex) const
+{
+    juce::String uuid;
+    if (_matchers->getResult(regex, _indexVersion, uuid))
+        return findTree(uuid);
+    
+    juce::ValueTree first;
+    for (const auto& [name, uuids] : _nameIndex)
+    {
+        if (!_matchers->matches(regex, name)) {continue;}
+        auto tree = findTreeWithName(name);
+        if (tree.isValid() && (!first.isValid() || isBefore(tree, first)))
+            first = tree;
+    }
+    
+    _matchers->setResult(regex, _indexVersion, getUuid(first));
+    return first;
 }
 
 
@@ -1139,14 +1628,15 @@ const juce::ValueTree DockManagerData::findTree(const juce::ValueTree& treeToSea
 
 
 template <typename T>
-const juce::ValueTree DockManagerData::searchParentsFor(const juce::ValueTree& tree,const juce::String& propId, T value) const
+const juce::ValueTree DockManagerData::searchParentsFor(const juce::ValueTree& tree, const juce::Identifier& propId, T value) const
 {
-    if (!tree.isValid()) {return juce::ValueTree();}
-    const T property = tree.getProperty(propId);
-    if (tree.hasProperty(propId) && property == value)
-        return tree;
-    else
-        return searchParentsFor(tree.getParent(), propId, value);
+    for (auto parent = tree; parent.isValid(); parent = parent.getParent())
+    {
+        auto property = parent.getPropertyPointer(propId);
+        if (property != nullptr && (T) *property == value)
+            return parent;
+    }
+    return juce::ValueTree();
 }
 
 
@@ -1173,6 +1663,461 @@ void DockManagerData::removeChildFromParent(juce::ValueTree& tree)
 }
 
 
+void DockManagerData::addChild(juce::ValueTree parent, const juce::ValueTree& child, int index)
+{
+    const juce::ScopedValueSetter<bool> adding(_isAddingTrees, true);
+    parent.addChild(child, index, nullptr);
+}
+
+
+
+
+
+/**
+ ===================================
+ MARK: - Uuid Index -
+ ===================================
+ */
+
+void DockManagerData::addToIndex(const juce::ValueTree& tree)
+{
+    if (!tree.isValid()) {return;}
+    
+    auto uuid = DockUuid(getUuid(tree));
+    if (!uuid.isNull())
+    {
+        /// Re-keyed or renamed while detached
+        auto& entry = _uuidIndex.getReference(uuid);
+        if (entry.name.isNotEmpty())
+            unindexName(uuid, entry.name);
+        
+        entry = {tree, getName(tree)};
+        indexName(uuid, entry.name);
+    }
+    
+    for (const auto& child : tree)
+        addToIndex(child);
+}
+
+
+void DockManagerData::removeFromIndex(const juce::ValueTree& tree)
+{
+    if (!tree.isValid()) {return;}
+    
+    /// Only drop the entry if it still points at this tree
+    auto uuid = DockUuid(getUuid(tree));
+    if (!uuid.isNull() && _uuidIndex.contains(uuid) && _uuidIndex[uuid].tree == tree)
+    {
+        unindexName(uuid, _uuidIndex[uuid].name);
+        _uuidIndex.remove(uuid);
+    }
+    
+    for (const auto& child : tree)
+        removeFromIndex(child);
+}
+
+
+void DockManagerData::indexName(const DockUuid& uuid, const juce::String& name)
+{
+    if (name.isEmpty()) {return;}
+    _nameIndex[name].addIfNotAlreadyThere(uuid);
+}
+
+
+void DockManagerData::unindexName(const DockUuid& uuid, const juce::String& name)
+{
+    auto uuids = _nameIndex.find(name);
+    if (uuids == _nameIndex.end()) {return;}
+    uuids->second.removeFirstMatchingValue(uuid);
+    if (uuids->second.isEmpty())
+        _nameIndex.erase(uuids);
+}
+
+
+const bool DockManagerData::isIndexed(const juce::ValueTree& tree, const DockUuid& uuid) const
+{
+    if (!tree.isValid() || DockUuid(getUuid(tree)) != uuid) {return false;}
+    return tree == _rootTree || tree.isAChildOf(_rootTree);
+}
+
+
+const bool DockManagerData::isIndexed(const juce::ValueTree& tree, const juce::String& uuid) const
+{
+    if (!tree.isValid() || getUuid(tree) != uuid) {return false;}
+    return tree == _rootTree || tree.isAChildOf(_rootTree);
+}
+
+
+const bool DockManagerData::isBefore(const juce::ValueTree& tree, const juce::ValueTree& otherTree) const
+{
+    /// Compares the paths from the root, an ancestor comes before its children
+    auto getPath = [](juce::ValueTree t)
+    {
+        juce::Array<int> path;
+        for (auto parent = t.getParent(); parent.isValid(); t = parent, parent = t.getParent())
+            path.insert(0, parent.indexOf(t));
+        return path;
+    };
+    
+    auto path = getPath(tree);
+    auto otherPath = getPath(otherTree);
+    for (auto i = 0; i < juce::jmin(path.size(), otherPath.size()); i++)
+        if (path[i] != otherPath[i])
+            return path[i] < otherPath[i];
+    
+    return path.size() < otherPath.size();
+}
+
+
+
+/**
+ ===================================
+ MARK: - Layout Hashes -
+ ===================================
+ */
+
+const juce::uint64 DockManagerData::getLayoutHash() const
+{
+    return getHash(_rootTree, true);
+}
+
+
+const juce::uint64 DockManagerData::getWindowHash(const juce::String& windowId) const
+{
+    auto window = findTree(windowId);
+    if (!isWindow(window)) {return 0;}
+    return getHash(window, true);
+}
+
+
+const juce::uint64 DockManagerData::getHash(const juce::ValueTree& tree) const
+{
+    /// Only trees in the layout are told when they change, so only they can keep a hash
+    return getHash(tree, tree == _rootTree || tree.isAChildOf(_rootTree));
+}
+
+
+const juce::uint64 DockManagerData::getHash(const juce::ValueTree& tree, bool shouldCache) const
+{
+    if (!tree.isValid()) {return 0;}
+    
+    auto uuid = DockUuid(getUuid(tree));
+    if (shouldCache && _hashes.contains(uuid))
+    {
+        const auto& entry = _hashes.getReference(uuid);
+        if (entry.tree == tree)
+            return entry.hash;
+    }
+    
+    /// Properties in any order, as isEquivalentTo, children in theirs
+    auto finalise = [](juce::uint64 hash)
+    {
+        hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9ull;
+        hash = (hash ^ (hash >> 27)) * 0x94d049bb133111ebull;
+        return hash ^ (hash >> 31);
+    };
+    
+    juce::uint64 properties = 0;
+    for (auto i = 0; i < tree.getNumProperties(); i++)
+    {
+        auto name = tree.getPropertyName(i);
+        properties += finalise((juce::uint64) name.toString().hashCode64() * 31 + hashValue(tree.getProperty(name)));
+    }
+    
+    auto hash = finalise((juce::uint64) tree.getType().toString().hashCode64() ^ finalise(properties));
+    for (const auto& child : tree)
+        hash = finalise(hash * 31 + getHash(child, shouldCache));
+    
+    if (shouldCache)
+        _hashes.set(uuid, {tree, hash});
+    
+    return hash;
+}
+
+
+void DockManagerData::invalidateHashes(const juce::ValueTree& tree)
+{
+    for (auto parent = tree; parent.isValid(); parent = parent.getParent())
+        _hashes.remove(getUuid(parent));
+}
+
+
+void DockManagerData::forgetHashes(const juce::ValueTree& tree)
+{
+    _hashes.remove(getUuid(tree));
+    for (const auto& child : tree)
+        forgetHashes(child);
+}
+
+
+const juce::uint64 DockManagerData::hashValue(const juce::var& value)
+{
+    /// Tagged by type, so "1", 1 and true differ as they would on disk
+    if (value.isVoid())
+        return 0;
+    if (value.isBool())
+        return (bool) value ? 1 : 2;
+    if (value.isInt() || value.isInt64())
+        return 3 + (juce::uint64) (juce::int64) value * 0x9e3779b97f4a7c15ull;
+    if (value.isDouble())
+    {
+        auto number = (double) value;
+        juce::uint64 bits;
+        std::memcpy(&bits, &number, sizeof(bits));
+        return 4 + bits * 0x9e3779b97f4a7c15ull;
+    }
+    if (auto binary = value.getBinaryData())
+        return 5 + (juce::uint64) juce::String::toHexString(binary->getData(), (int) binary->getSize(), 0).hashCode64();
+    
+    return 6 + (juce::uint64) value.toString().hashCode64();
+}
+
+
+
+
+
+/**
+ ===================================
+ MARK: - Transactions -
+ ===================================
+ */
+
+void DockManagerData::beginTransaction()
+{
+    _transactionDepth++;
+}
+
+
+void DockManagerData::commitTransaction()
+{
+    jassert(_transactionDepth > 0);
+    if (--_transactionDepth > 0) {return;}
+    
+    /// Drop trees which were removed during the transaction, their owners are rebuilt by a parent
+    juce::Array<std::pair<int, juce::ValueTree>> affected;
+    for (const auto& [uuid, tree] : _affectedTrees)
+    {
+        if (tree != _rootTree && !tree.isAChildOf(_rootTree)) {continue;}
+        
+        /// Given another uuid during the transaction, and listed again under it
+        auto currentUuid = DockUuid(getUuid(tree));
+        if (currentUuid != uuid && contains(_affectedTreeSet, tree, currentUuid)) {continue;}
+        
+        auto depth = 0;
+        for (auto parent = tree.getParent(); parent.isValid(); parent = parent.getParent())
+            depth++;
+        affected.add({depth, tree});
+    }
+    _affectedTrees.clear();
+    _affectedTreeSet.clear();
+    _affectedTreesWithoutUuid.clear();
+    
+    /// Parents reconcile before their children
+    std::stable_sort(affected.begin(), affected.end(), [](const auto& a, const auto& b) {return a.first < b.first;});
+    
+    _isCommitting = true;
+    _commitNumber++;
+    for (const auto& [depth, tree] : affected)
+    {
+        /// A parent may have detached this tree while reconciling
+        if (tree != _rootTree && !tree.isAChildOf(_rootTree)) {continue;}
+        _transactionListeners.call([&tree](TransactionListener& l) {l.transactionDidCommit(tree);});
+    }
+    _isCommitting = false;
+    
+    _transactionListeners.call([](TransactionListener& l) {l.transactionDidEnd();});
+}
+
+
+const bool DockManagerData::isInTransaction() const
+{
+    return _transactionDepth > 0;
+}
+
+
+const bool DockManagerData::isCommittingTransaction() const
+{
+    return _isCommitting;
+}
+
+
+const int DockManagerData::getCommitNumber() const
+{
+    return _commitNumber;
+}
+
+
+void DockManagerData::addTransactionListener(TransactionListener* listener)
+{
+    _transactionListeners.add(listener);
+}
+
+
+void DockManagerData::removeTransactionListener(TransactionListener* listener)
+{
+    _transactionListeners.remove(listener);
+}
+
+
+void DockManagerData::setChangeRecorder(juce::ValueTree::Listener* recorder)
+{
+    _changeRecorder = recorder;
+}
+
+
+void DockManagerData::addTreeListener(juce::ValueTree::Listener* listener)
+{
+    _treeListeners.add(listener);
+}
+
+
+void DockManagerData::removeTreeListener(juce::ValueTree::Listener* listener)
+{
+    _treeListeners.remove(listener);
+}
+
+
+void DockManagerData::addAffectedTree(const juce::ValueTree& tree)
+{
+    if (!isInTransaction()) {return;}
+    
+    /// In the order they were first affected, without a scan of those already listed
+    auto uuid = DockUuid(getUuid(tree));
+    if (uuid.isNull())
+    {
+        /// Only trees set up by hand, and the root, have no uuid
+        if (_affectedTreesWithoutUuid.contains(tree)) {return;}
+        _affectedTreesWithoutUuid.add(tree);
+    }
+    else
+    {
+        if (contains(_affectedTreeSet, tree, uuid)) {return;}
+        _affectedTreeSet.set(uuid, tree);
+    }
+    
+    _affectedTrees.add({uuid, tree});
+}
+
+
+
+
+
+/**
+ ===================================
+ MARK: - Value Tree Listener -
+ ===================================
+ */
+
+void DockManagerData::valueTreeChildAdded(juce::ValueTree& parentTree, juce::ValueTree& childWhichHasBeenAdded)
+{
+    if (_changeRecorder != nullptr)
+        _changeRecorder->valueTreeChildAdded(parentTree, childWhichHasBeenAdded);
+    
+    /// It may have changed while it was outside the layout
+    forgetHashes(childWhichHasBeenAdded);
+    invalidateHashes(parentTree);
+    
+    _indexVersion++;
+    addToIndex(childWhichHasBeenAdded);
+    addAffectedTree(parentTree);
+    
+    /// Nothing says what's inside a tree which was added, unless it was only moved, then the paths to where it was and is are enough
+    auto uuid = DockUuid(getUuid(childWhichHasBeenAdded));
+    auto wasMoved = contains(_removedTrees, childWhichHasBeenAdded, uuid);
+    if (wasMoved)
+        _removedTrees.remove(uuid);
+    markForOrphanCheck(parentTree, false);
+    markForOrphanCheck(childWhichHasBeenAdded, !wasMoved);
+    
+    _treeListeners.call([&](juce::ValueTree::Listener& l) {l.valueTreeChildAdded(parentTree, childWhichHasBeenAdded);});
+}
+
+
+void DockManagerData::valueTreeChildRemoved(juce::ValueTree& parentTree, juce::ValueTree& childWhichHasBeenRemoved, int indexFromWhichChildWasRemoved)
+{
+    if (_changeRecorder != nullptr)
+        _changeRecorder->valueTreeChildRemoved(parentTree, childWhichHasBeenRemoved, indexFromWhichChildWasRemoved);
+    
+    forgetHashes(childWhichHasBeenRemoved);
+    invalidateHashes(parentTree);
+    
+    _indexVersion++;
+    removeFromIndex(childWhichHasBeenRemoved);
+    addAffectedTree(parentTree);
+    markForOrphanCheck(parentTree, false);
+    
+    /// Only the data moves trees around between checks
+    auto uuid = DockUuid(getUuid(childWhichHasBeenRemoved));
+    if (!uuid.isNull())
+        _removedTrees.set(uuid, childWhichHasBeenRemoved);
+    
+    _treeListeners.call([&](juce::ValueTree::Listener& l) {l.valueTreeChildRemoved(parentTree, childWhichHasBeenRemoved, indexFromWhichChildWasRemoved);});
+}
+
+
+void DockManagerData::valueTreeChildOrderChanged(juce::ValueTree& parentTreeWhoseChildrenHaveMoved, int oldIndex, int newIndex)
+{
+    if (_changeRecorder != nullptr)
+        _changeRecorder->valueTreeChildOrderChanged(parentTreeWhoseChildrenHaveMoved, oldIndex, newIndex);
+    
+    invalidateHashes(parentTreeWhoseChildrenHaveMoved);
+    
+    /// Tree order decides which match comes first
+    _indexVersion++;
+    addAffectedTree(parentTreeWhoseChildrenHaveMoved);
+    
+    _treeListeners.call([&](juce::ValueTree::Listener& l) {l.valueTreeChildOrderChanged(parentTreeWhoseChildrenHaveMoved, oldIndex, newIndex);});
+}
+
+
+void DockManagerData::valueTreePropertyChanged(juce::ValueTree& treeWhosePropertyHasChanged, const juce::Identifier& property)
+{
+    /// Before any other listener can react to the change, so the recorder's order replays
+    if (_changeRecorder != nullptr)
+        _changeRecorder->valueTreePropertyChanged(treeWhosePropertyHasChanged, property);
+    
+    invalidateHashes(treeWhosePropertyHasChanged);
+    
+    addAffectedTree(treeWhosePropertyHasChanged);
+    
+    if (dockNode::is<dockSchema::uuid>(property) || dockNode::is<dockSchema::name>(property) || dockNode::is<dockSchema::dockType>(property))
+        markForOrphanCheck(treeWhosePropertyHasChanged, false);
+    indexProperty(treeWhosePropertyHasChanged, property);
+    
+    _treeListeners.call([&](juce::ValueTree::Listener& l) {l.valueTreePropertyChanged(treeWhosePropertyHasChanged, property);});
+}
+
+
+void DockManagerData::indexProperty(const juce::ValueTree& treeWhosePropertyHasChanged, const juce::Identifier& property)
+{
+    /// Only uuids and names are indexed, so a resize doesn't parse a uuid
+    auto isUuid = dockNode::is<dockSchema::uuid>(property);
+    auto isName = dockNode::is<dockSchema::name>(property);
+    if (!isUuid && !isName) {return;}
+    
+    auto uuid = DockUuid(getUuid(treeWhosePropertyHasChanged));
+    if (uuid.isNull()) {return;}
+    
+    /// The old uuid is dropped lazily by findTree
+    if (isUuid)
+    {
+        _indexVersion++;
+        auto& entry = _uuidIndex.getReference(uuid);
+        entry = {treeWhosePropertyHasChanged, getName(treeWhosePropertyHasChanged)};
+        indexName(uuid, entry.name);
+    }
+    
+    else if (_uuidIndex.contains(uuid))
+    {
+        _indexVersion++;
+        auto& entry = _uuidIndex.getReference(uuid);
+        unindexName(uuid, entry.name);
+        entry.name = getName(treeWhosePropertyHasChanged);
+        indexName(uuid, entry.name);
+    }
+}
+
+
 
 
 
@@ -1193,7 +2138,7 @@ juce::Array<juce::Rectangle<float>> DockManagerData::mockAllRects()
 
 void DockManagerData::addTreeToMock(const juce::ValueTree& tree, juce::Array<juce::Rectangle<float>>& rects)
 {
-    auto bounds = getBounds(tree.getProperty(dockProps::uuidProperty));
+    auto bounds = getBounds(dockNode::get<dockSchema::uuid>(tree));
     
     if (!bounds.isEmpty())
         rects.add(bounds);
@@ -1,9 +1,196 @@
 #pragma once
 #include <juce_gui_basics/juce_gui_basics.h>
+#include "DockUuid.h"
+#include <unordered_map>
 
 
 constexpr bool PRINT_TREE_LISTENERS = false; 
 
+
+/**
+ -------------------------------------------------------------
+ ===================================
+ MARK: - Dock Counters -
+ Listener and layout traffic, read by the tests and benchmarks. Only counted with DOCKS_COUNTERS
+ ===================================
+ -------------------------------------------------------------
+ */
+struct DockCounters
+{
+   #if DOCKS_COUNTERS
+    /// Relaxed, nothing is ordered by them and they're only read once the traffic is over
+    struct Counter
+    {
+        Counter() : _count(0) {}
+        void operator++(int) {_count.fetch_add(1, std::memory_order_relaxed);}
+        void operator=(int count) {_count.store(count, std::memory_order_relaxed);}
+        operator int() const {return _count.load(std::memory_order_relaxed);}
+        
+    private:
+        std::atomic<int> _count;
+    };
+   #else
+    struct Counter
+    {
+        void operator++(int) {}
+        void operator=(int) {}
+        operator int() const {return 0;}
+    };
+   #endif
+    
+    static inline Counter treeCallbacks;
+    static inline Counter layoutPasses;
+    static inline Counter dockingComponents;
+    static inline Counter dispatchedCalls;
+    static inline Counter tabComponents;
+    
+    static void reset()
+    {
+        treeCallbacks = 0;
+        layoutPasses = 0;
+        dockingComponents = 0;
+        dispatchedCalls = 0;
+        tabComponents = 0;
+    }
+};
+
+enum class DockTypes
+{
+    none = 0, tabs, vertical, horizontal
+};
+
+
+
+
+/**
+ -------------------------------------------------------------
+ ===================================
+ MARK: - Dock Schema -
+ ===================================
+ -------------------------------------------------------------
+ */
+
+/// A tree type, by the name it's saved under
+struct DockNodeType
+{
+    const char* name;
+};
+
+
+/// A property, by the name it's saved under and the type it's read as
+template <typename T>
+struct DockProperty
+{
+    using Type = T;
+    const char* name;
+};
+
+
+namespace dockSchema
+{
+    /// Tree Types
+    inline constexpr DockNodeType root {"root"};
+    inline constexpr DockNodeType window {"window"};
+    inline constexpr DockNodeType view {"view"};
+    inline constexpr DockNodeType tabs {"tabs"};
+    
+    /// Properties
+    inline constexpr DockProperty<juce::String> uuid {"uuid"};
+    inline constexpr DockProperty<float> x {"x"};
+    inline constexpr DockProperty<float> y {"y"};
+    inline constexpr DockProperty<float> width {"width"};
+    inline constexpr DockProperty<float> height {"height"};
+    inline constexpr DockProperty<juce::String> name {"name"};
+    inline constexpr DockProperty<juce::String> selected {"selectedTab"};
+    inline constexpr DockProperty<DockTypes> dockType {"dockType"};
+    inline constexpr DockProperty<bool> minimized {"minimized"};
+    inline constexpr DockProperty<bool> maximized {"maximized"};
+    inline constexpr DockProperty<bool> locked {"locked"};
+}
+
+
+/**
+ Dock Node
+ Reads and writes a tree's properties by their schema entries, eg dockNode::get<dockSchema::width>(tree).
+ Each identifier is made once, the first time it's used, so no string is built or pooled per access, and
+ a value is read with one lookup straight into its type. Values are stored as they always were, so
+ layouts saved before open the same
+ */
+namespace dockNode
+{
+    template <const auto& entry>
+    const juce::Identifier& getId()
+    {
+        static const juce::Identifier id (entry.name);
+        return id;
+    }
+    
+    
+    template <const auto& property>
+    const typename std::decay_t<decltype(property)>::Type get(const juce::ValueTree& tree)
+    {
+        using Type = typename std::decay_t<decltype(property)>::Type;
+        auto value = tree.getPropertyPointer(getId<property>());
+        if (value == nullptr) {return Type();}
+        
+        if constexpr (std::is_same_v<Type, juce::String>)
+            return value->toString();
+        else if constexpr (std::is_enum_v<Type>)
+            return Type((int) *value);
+        else
+            return (Type) *value;
+    }
+    
+    
+    template <const auto& property>
+    void set(juce::ValueTree& tree, const typename std::decay_t<decltype(property)>::Type& value)
+    {
+        if constexpr (std::is_enum_v<typename std::decay_t<decltype(property)>::Type>)
+            tree.setProperty(getId<property>(), (int) value, nullptr);
+        else
+            tree.setProperty(getId<property>(), value, nullptr);
+    }
+    
+    
+    template <const auto& property>
+    const bool has(const juce::ValueTree& tree)
+    {
+        return tree.hasProperty(getId<property>());
+    }
+    
+    
+    template <const auto& property>
+    void remove(juce::ValueTree& tree)
+    {
+        tree.removeProperty(getId<property>(), nullptr);
+    }
+    
+    
+    /// For listeners, which are told the identifier that changed
+    template <const auto& property>
+    const bool is(const juce::Identifier& id)
+    {
+        return id == getId<property>();
+    }
+    
+    
+    template <const auto& type>
+    const bool isType(const juce::ValueTree& tree)
+    {
+        return tree.hasType(getId<type>());
+    }
+    
+    
+    template <const auto& type>
+    juce::ValueTree create()
+    {
+        return juce::ValueTree(getId<type>());
+    }
+}
+
+
+
+
 /**
  -------------------------------------------------------------
  ===================================
@@ -13,10 +200,10 @@ constexpr bool PRINT_TREE_LISTENERS = false;
  */
 namespace dockIds
 {
-    const juce::String rootTreeIdentifier = "root";
-    const juce::String windowIdentifier = "window";
-    const juce::String viewIdentifier = "view";
-    const juce::String tabsIdentifier = "tabs";
+    const juce::String rootTreeIdentifier = dockSchema::root.name;
+    const juce::String windowIdentifier = dockSchema::window.name;
+    const juce::String viewIdentifier = dockSchema::view.name;
+    const juce::String tabsIdentifier = dockSchema::tabs.name;
 }
 
 
@@ -27,6 +214,7 @@ namespace dockIds
  -------------------------------------------------------------
  ===================================
  MARK: - Dock Property Identifiers -
+ As text, for callers outside the hot paths, dockNode reads the same properties without it
  ===================================
  -------------------------------------------------------------
  */
@@ -34,27 +222,21 @@ namespace dockIds
 namespace dockProps
 {
     /// Property Identifiers
-    const juce::String uuidProperty = "uuid";
-    const juce::String xProperty = "x";
-    const juce::String yProperty = "y";
-    const juce::String widthProperty = "width";
-    const juce::String heightProperty = "height";
-    const juce::String nameProperty = "name";
-    const juce::String selectedProperty = "selectedTab";
-    const juce::String dockType = "dockType";
-    const juce::String windowMinimized = "minimized";
-    const juce::String windowMaximized = "maximized";
-    const juce::String lockedProperty = "locked";
+    const juce::String uuidProperty = dockSchema::uuid.name;
+    const juce::String xProperty = dockSchema::x.name;
+    const juce::String yProperty = dockSchema::y.name;
+    const juce::String widthProperty = dockSchema::width.name;
+    const juce::String heightProperty = dockSchema::height.name;
+    const juce::String nameProperty = dockSchema::name.name;
+    const juce::String selectedProperty = dockSchema::selected.name;
+    const juce::String dockType = dockSchema::dockType.name;
+    const juce::String windowMinimized = dockSchema::minimized.name;
+    const juce::String windowMaximized = dockSchema::maximized.name;
+    const juce::String lockedProperty = dockSchema::locked.name;
 
 }
 
 
-enum class DockTypes
-{
-    none = 0, tabs, vertical, horizontal
-};
-
-
 enum class DropLocation
 {
     viewLeft, viewRight, viewTop, viewBottom,
@@ -64,6 +246,13 @@ enum class DropLocation
 };
 
 
+/// Layouts save as XML by default, and open from either
+enum class LayoutFormat
+{
+    xml, binary
+};
+
+
 
 
 /**
@@ -73,24 +262,92 @@ enum class DropLocation
  ===================================
  -------------------------------------------------------------
  */
-class DockManagerData
+class DockManagerData : private juce::ValueTree::Listener
 {
     friend class test_DockManagerData;
     friend class DockManager;
+    friend class LayoutAutosaver;
+    friend class LayoutJournal;
     
 public:
 
     DockManagerData();
     ~DockManagerData();
     
+    /**
+     Transaction Listener
+     Recieves one update per affected tree when the outermost transaction commits. Listeners added
+     here hear about every affected tree, one which only cares about its own tree registers with
+     the manager's TreeDispatcher instead
+     */
+    class TransactionListener
+    {
+    public:
+        virtual ~TransactionListener() = default;
+        virtual void transactionDidCommit(const juce::ValueTree& affectedTree) = 0;
+        
+        /// Called once every affected tree has been committed
+        virtual void transactionDidEnd() {}
+    };
+    
+    /**
+     Scoped Transaction
+     Batches every change made while it is alive. Value tree listeners should skip
+     their callbacks while isInTransaction() and reconcile in transactionDidCommit()
+     */
+    class ScopedTransaction
+    {
+    public:
+        ScopedTransaction(DockManagerData& data) : _data(data) {_data.beginTransaction();}
+        ~ScopedTransaction() {_data.commitTransaction();}
+    private:
+        DockManagerData& _data;
+        JUCE_DECLARE_NON_COPYABLE(ScopedTransaction)
+    };
+    
+    /// Transactions
+    void beginTransaction();
+    void commitTransaction();
+    const bool isInTransaction() const;
+    const bool isCommittingTransaction() const;
+    void addTransactionListener(TransactionListener* listener);
+    void removeTransactionListener(TransactionListener* listener);
+    
+    /// Goes up with each outermost commit, so a listener can tell one commit from the next
+    const int getCommitNumber() const;
+    
+    /// Change Recorder, hears of every change before any other listener so a journal gets them in the order they were made
+    void setChangeRecorder(juce::ValueTree::Listener* recorder);
+    
+    /// Tree Listeners, hear of every change after the index has been updated, so findTree always finds what the change added
+    void addTreeListener(juce::ValueTree::Listener* listener);
+    void removeTreeListener(juce::ValueTree::Listener* listener);
+    
+    /**
+     Layout Hashes
+     A hash of a tree and everything below it, which comes back to what it was when the tree does.
+     Each subtree keeps its hash until something below it changes, so rehashing after a change only
+     goes as far as the trees above it
+     */
+    const juce::uint64 getLayoutHash() const;
+    const juce::uint64 getWindowHash(const juce::String& windowId) const;
+    const juce::uint64 getHash(const juce::ValueTree& tree) const;
+    
     /** Save To File */
     bool saveAsTemplate(const juce::File& file);
-    bool saveToFile(const juce::File& file);
-    bool saveLayout(juce::OutputStream& outputStream);
+    bool saveToFile(const juce::File& file, LayoutFormat format = LayoutFormat::xml);
+    bool saveLayout(juce::OutputStream& outputStream, LayoutFormat format = LayoutFormat::xml);
 
-    /** Open From file */
-    bool openFromFile(const juce::File& file);
-    bool openLayout(juce::InputStream& inputStream);
+    /** Open From file, in either format (reconcile keeps the trees which survive, see reconcileLayout) */
+    bool openFromFile(const juce::File& file, bool reconcile = false);
+    bool openLayout(juce::InputStream& inputStream, bool reconcile = false);
+    
+    /**
+     Reconcile Layout
+     Morphs the current tree into the layout. Trees are matched by uuid, then by type and name,
+     so the components built for them survive. Only what actually changed is created, moved or removed
+     */
+    bool reconcileLayout(const juce::ValueTree& layout);
 
     
     /**
@@ -146,6 +403,7 @@ public:
     const juce::String getSelectedId(const juce::ValueTree& tree) const;
     const bool isSelected(const juce::ValueTree& tree) const;
     const bool isWindowLocked(const juce::ValueTree& tree) const;
+    const bool isWindowMinimized(const juce::ValueTree& tree) const;
     const juce::String dropLocationToString(DropLocation drop) const; 
     const juce::String dockTypeToString(DockTypes type) const; 
     const std::pair<juce::String, int> getTreeForDockLocation(const juce::String& treeId, DropLocation drop) const;
@@ -203,11 +461,26 @@ protected:
     bool dockInNewWindow(juce::ValueTree treeToDock, juce::Point<float> dropPosition, juce::Rectangle<float> windowBounds = {});
     const int getIndexForLocation(DropLocation location) const;
     
-    /// Check For Orphans
+    /// Layout Helpers
+    static bool writeLayout(const juce::ValueTree& layout, juce::OutputStream& outputStream, LayoutFormat format);
+    static bool writeLayout(const juce::ValueTree& layout, const juce::File& file, LayoutFormat format);
+    static juce::ValueTree readLayout(juce::InputStream& inputStream);
+    bool loadLayout(const juce::ValueTree& layout, bool reconcile);
+    
+    /// Reconcile Helpers
+    void matchTrees(juce::ValueTree& layout) const;
+    void syncTree(juce::ValueTree tree, const juce::ValueTree& layoutTree);
+    void pruneTree(juce::ValueTree tree, const juce::ValueTree& layoutTree);
+    
+    /// Check For Orphans, only down the paths to trees changed since the last check
     void checkForOrphanedTrees();
     void checkForOrphanedTreesIn(juce::ValueTree tree);
     void checkForOrphanedWindows();
     
+    /// Test Hooks, a check of the whole layout every time, or the paths found even through a small layout
+    bool _checksWholeLayout = false;
+    bool _walksSmallLayouts = true;
+    
     /// To Delete
     void checkBounds(const juce::String& forView);
     const juce::String getRandomName() const;
@@ -220,26 +493,116 @@ protected:
 
     /// Find Tree
     const juce::ValueTree findTree(const juce::String& withUuid) const;
+    const juce::ValueTree findTree(const DockUuid& withUuid) const;
     const juce::ValueTree findTree(const juce::String& propId, const juce::String& value, const juce::ValueTree& treeToSearch) const;
     const juce::ValueTree findTree(const juce::ValueTree& treeToSearch, const std::function<bool(const juce::ValueTree& tree)>& checkFunc) const;
+    const juce::ValueTree findTreeWithName(const juce::String& name) const;
+    const juce::ValueTree findTreeMatching(const juce::String& regex) const;
     const juce::ValueTree findWindow(const juce::ValueTree& forTree) const;
     void removeChildFromParent(juce::ValueTree& tree);
+    void addChild(juce::ValueTree parent, const juce::ValueTree& child, int index);
     juce::ValueTree getParentForDropType(const juce::ValueTree& tree, DockTypes type) const;
     juce::ValueTree addAndMoveTree(const juce::ValueTree& tree, DockTypes type);
     
     /// Search Parents for Value
     template <typename T>
-    const juce::ValueTree searchParentsFor(const juce::ValueTree& tree,const juce::String& propId, T value) const;
+    const juce::ValueTree searchParentsFor(const juce::ValueTree& tree, const juce::Identifier& propId, T value) const;
     
     /// Get Properties from tree
     template <typename T>
-    const T getProperty(const juce::ValueTree& tree, const juce::String& propId) const;
+    const T getProperty(const juce::ValueTree& tree, const juce::Identifier& propId) const;
     
 private:
     
+    /// Uuid/Name Index
+    struct IndexEntry
+    {
+        juce::ValueTree tree;
+        juce::String name;
+    };
+    void addToIndex(const juce::ValueTree& tree);
+    void removeFromIndex(const juce::ValueTree& tree);
+    void indexName(const DockUuid& uuid, const juce::String& name);
+    void unindexName(const DockUuid& uuid, const juce::String& name);
+    void indexProperty(const juce::ValueTree& treeWhosePropertyHasChanged, const juce::Identifier& property);
+    const bool isIndexed(const juce::ValueTree& tree, const DockUuid& uuid) const;
+    const bool isIndexed(const juce::ValueTree& tree, const juce::String& uuid) const;
+    const bool isBefore(const juce::ValueTree& tree, const juce::ValueTree& otherTree) const;
+    
+    /// Subtree Hashes
+    struct HashEntry
+    {
+        juce::ValueTree tree;
+        juce::uint64 hash;
+    };
+    const juce::uint64 getHash(const juce::ValueTree& tree, bool shouldCache) const;
+    void invalidateHashes(const juce::ValueTree& tree);
+    void forgetHashes(const juce::ValueTree& tree);
+    static const juce::uint64 hashValue(const juce::var& value);
+    
+    /// Orphan Checks
+    using TreeSet = juce::HashMap<DockUuid, juce::ValueTree, DockUuid::HashFunction>;
+    static constexpr int treesWalkedPerOrphanCheckPath = 32;
+    void markForOrphanCheck(const juce::ValueTree& tree, bool withChildren);
+    const bool isOnOrphanCheckPath(const juce::ValueTree& tree) const;
+    const bool buildOrphanCheckPaths();
+    void didCheckForOrphans(const juce::ValueTree& tree);
+    static const bool contains(const TreeSet& trees, const juce::ValueTree& tree, const DockUuid& uuid);
+    
+    /// Transactions
+    void addAffectedTree(const juce::ValueTree& tree);
+    
+    /// Value Tree Listener
+    void valueTreeChildAdded(juce::ValueTree& parentTree, juce::ValueTree& childWhichHasBeenAdded) override;
+    void valueTreeChildRemoved(juce::ValueTree& parentTree, juce::ValueTree& childWhichHasBeenRemoved, int indexFromWhichChildWasRemoved) override;
+    void valueTreeChildOrderChanged(juce::ValueTree& parentTreeWhoseChildrenHaveMoved, int oldIndex, int newIndex) override;
+    void valueTreePropertyChanged(juce::ValueTree& treeWhosePropertyHasChanged, const juce::Identifier& property) override;
+    
     /// Tree Data
     juce::ValueTree _rootTree = juce::ValueTree(dockIds::rootTreeIdentifier);
     
+    /// Uuid -> Tree (kept in sync by the listener, a stale entry is dropped on lookup)
+    mutable juce::HashMap<DockUuid, IndexEntry, DockUuid::HashFunction> _uuidIndex;
+    
+    /// Name -> Uuids
+    std::unordered_map<juce::String, juce::Array<DockUuid>> _nameIndex;
+    int _indexVersion = 0;
+    
+    /// While the data adds trees, listeners below the root hear of them before the index does
+    bool _isAddingTrees = false;
+    
+    /// Uuid -> Subtree Hash (the root's under no uuid, cleared up the tree by every change)
+    mutable juce::HashMap<DockUuid, HashEntry, DockUuid::HashFunction> _hashes;
+    
+    /// Trees whose children, name or dock type changed since the last orphan check, and during one, the paths down to them
+    /// Trees removed since then are known to have been checked, so moving one back in only marks its root
+    TreeSet _orphanCheckTrees;
+    TreeSet _removedTrees;
+    TreeSet _orphanCheckPaths;
+    TreeSet _uncheckedTrees;
+    bool _needsWholeOrphanCheck = false;
+    bool _isCheckingWholeLayout = false;
+    bool _isCheckingForOrphans = false;
+    
+    /// Compiled Regex Matchers
+    class MatcherCache;
+    std::unique_ptr<MatcherCache> _matchers;
+    
+    /// Transactions
+    int _transactionDepth = 0;
+    bool _isCommitting = false;
+    int _commitNumber = 0;
+    juce::Array<std::pair<DockUuid, juce::ValueTree>> _affectedTrees;
+    TreeSet _affectedTreeSet;
+    juce::Array<juce::ValueTree> _affectedTreesWithoutUuid;
+    juce::ListenerList<TransactionListener> _transactionListeners;
+    
+    /// Change Recorder
+    juce::ValueTree::Listener* _changeRecorder = nullptr;
+    
+    /// Tree Listeners
+    juce::ListenerList<juce::ValueTree::Listener> _treeListeners;
+    
     /// Utility
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DockManagerData)
 };
@@ -0,0 +1,191 @@
+#include "DockUuid.h"
+
+
+namespace
+{
+    constexpr juce::uint64 eachByte(juce::uint8 value) {return 0x0101010101010101ull * value;}
+
+    /// Sets the top bit of each byte from first to last. Only for bytes below 0x80, which can't carry into the next one
+    constexpr juce::uint64 bytesInRange(juce::uint64 bytes, juce::uint8 first, juce::uint8 last)
+    {
+        return (bytes + eachByte((juce::uint8) (0x80 - first))) & ~(bytes + eachByte((juce::uint8) (0x80 - last - 1)));
+    }
+}
+
+
+DockUuid::DockUuid() : _text()
+{
+}
+
+
+DockUuid::DockUuid(const juce::String& uuid)
+{
+    /// Eight digits at a time, checked all together at the end, as digits and letters come in no order
+    /// a branch could guess. Anything but 32 lower case hex digits is kept as text
+    if (uuid.getNumBytesAsUTF8() != 32)
+    {
+        new (&_text) juce::String(uuid);
+        return;
+    }
+
+    auto text = uuid.toRawUTF8();
+    auto isHex = eachByte(0x80);
+    auto anyHighBit = (juce::uint64) 0;
+    auto readDigits = [&](int offset) -> juce::uint64
+    {
+        auto bytes = juce::ByteOrder::bigEndianInt64(text + offset);
+        anyHighBit |= bytes;
+        isHex &= bytesInRange(bytes, '0', '9') | bytesInRange(bytes, 'a', 'f');
+
+        /// Each digit's value, letters have bit 6 set and need 9 more than their low bits
+        auto digits = (bytes & eachByte(0x0f)) + 9 * ((bytes >> 6) & eachByte(0x01));
+
+        /// Then each pair of digits into a byte, each pair of bytes into 16 bits, and so on
+        digits = (digits | (digits >> 4)) & 0x00ff00ff00ff00ffull;
+        digits = (digits | (digits >> 8)) & 0x0000ffff0000ffffull;
+        return (digits | (digits >> 16)) & 0x00000000ffffffffull;
+    };
+
+    auto high = (readDigits(0) << 32) | readDigits(8);
+    auto low = (readDigits(16) << 32) | readDigits(24);
+
+    /// No top 64 bits would read as text, and juce::Uuid never writes them
+    if (isHex != eachByte(0x80) || (anyHighBit & eachByte(0x80)) != 0 || high == 0)
+    {
+        new (&_text) juce::String(uuid);
+        return;
+    }
+
+    _high = high;
+    _low = low;
+}
+
+
+DockUuid::DockUuid(const DockUuid& other) : _high(other._high)
+{
+    if (isCompact())
+        _low = other._low;
+    else
+        new (&_text) juce::String(other._text);
+}
+
+
+DockUuid::DockUuid(juce::uint64 high, juce::uint64 low) : _high(high), _low(low)
+{
+    jassert(isCompact());
+}
+
+
+DockUuid& DockUuid::operator=(const DockUuid& other)
+{
+    /// Only one of the two is alive, so switching between them ends one and starts the other
+    if (!isCompact() && other.isCompact())
+        _text.~String();
+    else if (isCompact() && !other.isCompact())
+        new (&_text) juce::String();
+
+    _high = other._high;
+    if (isCompact())
+        _low = other._low;
+    else
+        _text = other._text;
+
+    return *this;
+}
+
+
+DockUuid::~DockUuid()
+{
+    if (!isCompact())
+        _text.~String();
+}
+
+
+DockUuid DockUuid::fromBytes(const juce::uint8* bytes)
+{
+    auto high = (juce::uint64) 0;
+    auto low = (juce::uint64) 0;
+    for (auto i = 0; i < 8; i++)
+    {
+        high = (high << 8) | bytes[i];
+        low = (low << 8) | bytes[i + 8];
+    }
+
+    if (high == 0)
+        return DockUuid(juce::String::toHexString(bytes, 16, 0));
+
+    return DockUuid(high, low);
+}
+
+
+void DockUuid::copyBytes(juce::uint8* bytes) const
+{
+    jassert(isCompact());
+    for (auto i = 0; i < 8; i++)
+    {
+        bytes[i] = (juce::uint8) (_high >> (56 - i * 8));
+        bytes[i + 8] = (juce::uint8) (_low >> (56 - i * 8));
+    }
+}
+
+
+
+
+
+/**
+ ===================================
+ MARK: - Text -
+ ===================================
+ */
+
+const juce::String DockUuid::toString() const
+{
+    if (!isCompact()) {return _text;}
+
+    juce::uint8 bytes[16];
+    copyBytes(bytes);
+    return juce::String::toHexString(bytes, 16, 0);
+}
+
+
+const bool DockUuid::isCompact() const
+{
+    return _high != 0;
+}
+
+
+const bool DockUuid::isNull() const
+{
+    return !isCompact() && _text.isEmpty();
+}
+
+
+
+
+
+/**
+ ===================================
+ MARK: - Comparing -
+ ===================================
+ */
+
+bool DockUuid::operator==(const DockUuid& other) const
+{
+    if (_high != other._high) {return false;}
+    return isCompact() ? _low == other._low : _text == other._text;
+}
+
+
+bool DockUuid::operator!=(const DockUuid& other) const
+{
+    return !operator==(other);
+}
+
+
+int DockUuid::HashFunction::generateHash(const DockUuid& uuid, int upperLimit) noexcept
+{
+    /// The bits are already random, text is hashed as juce::String would be. Folded to 32 bits, which
+    /// divide a lot faster than 64
+    auto hash = uuid.isCompact() ? uuid._high ^ uuid._low : (juce::uint64) uuid._text.hashCode64();
+    return upperLimit > 0 ? (int) ((juce::uint32) (hash ^ (hash >> 32)) % (juce::uint32) upperLimit) : 0;
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <juce_gui_basics/juce_gui_basics.h>
+
+
+/**
+ -------------------------------------------------------------
+ ===================================
+ MARK: - Dock Uuid -
+ ===================================
+ -------------------------------------------------------------
+ */
+
+/**
+ Dock Uuid
+ A uuid as its 128 bits, rather than the 32 hex digits juce::Uuid writes, so hashing and comparing one
+ is a couple of integer operations. Trees keep their uuids as text, which is what's saved and what the
+ rest of the API takes, and it's only turned into one of these to key the indexes. A uuid which isn't
+ 32 lower case hex digits, ie one set by hand, is kept as the text it was
+ */
+class DockUuid
+{
+public:
+
+    DockUuid();
+    DockUuid(const juce::String& uuid);
+    DockUuid(const DockUuid& other);
+    DockUuid& operator=(const DockUuid& other);
+    ~DockUuid();
+
+    /// Bytes, in the order juce::Uuid writes them
+    static DockUuid fromBytes(const juce::uint8* bytes);
+    void copyBytes(juce::uint8* bytes) const;
+
+    /// Text, as it was before it was parsed
+    const juce::String toString() const;
+    const bool isCompact() const;
+    const bool isNull() const;
+
+    bool operator==(const DockUuid& other) const;
+    bool operator!=(const DockUuid& other) const;
+
+    /// For juce::HashMap
+    struct HashFunction
+    {
+        static int generateHash(const DockUuid& uuid, int upperLimit) noexcept;
+    };
+
+private:
+
+    DockUuid(juce::uint64 high, juce::uint64 low);
+
+    /// juce::Uuid keeps its version in the top 64 bits, so they're never all zero. Zero there means
+    /// the uuid is text instead, which is kept where the low 64 bits would be, so a key is 16 bytes
+    juce::uint64 _high = 0;
+    union
+    {
+        juce::uint64 _low;
+        juce::String _text;
+    };
+};
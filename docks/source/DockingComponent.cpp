@@ -114,6 +114,9 @@ private:
 
 DockingComponent::DockingComponent(DockManager& manager, DockManagerData& data, const juce::ValueTree& tree) : _manager(manager), _data(data), _tree(tree)
 {
+    DockCounters::dockingComponents++;
+    _builtInCommit = _data.isCommittingTransaction() ? _data.getCommitNumber() : -1;
+    _constructionDepth++;
     setSize(400, 400); /// Because it has to have some size...
     setupWithTree();
     auto name = _data.getName(tree);
@@ -126,12 +129,21 @@ DockingComponent::DockingComponent(DockManager& manager, DockManagerData& data,
     /// Setup View
     setupView();
     selectedTabDidChange();
+    
+    if (--_constructionDepth == 0)
+        finishConstruction();
 }
 
 
 DockingComponent::~DockingComponent()
 {
-    _tree.removeListener(this);
+    _manager._dispatcher.removeListener(_tree, this);
+    _manager._dispatcher.removeTransactionListener(_tree, this);
+    
+    /// Subviews whose trees moved elsewhere outlive this component
+    for (auto component : _components)
+        _manager.detachDockingComponent(component);
+    _manager.forgetDockingComponent(getUuid());
 }
 
 
@@ -234,6 +246,8 @@ void DockingComponent::paint(juce::Graphics &g)
 
 void DockingComponent::resized()
 {
+    if (_isConstructing) {return;}
+    DockCounters::layoutPasses++;
     auto bounds = getLocalBounds();
     if (_floater)
         _floater->setBounds(bounds);
@@ -249,6 +263,7 @@ void DockingComponent::resized()
     {
         case DockTypes::none:
         {
+            _splitLayout.invalidate();
             for (auto component : _components)
                 component->setBounds(bounds);
             break;
@@ -256,6 +271,7 @@ void DockingComponent::resized()
         case DockTypes::tabs:
         {
             /// Components
+            _splitLayout.invalidate();
             for (auto component : _components)
                 component->setBounds(bounds.reduced(1));
             
@@ -263,68 +279,12 @@ void DockingComponent::resized()
         }
         case DockTypes::horizontal:
         {
-            juce::Grid grid;
-            using Track = juce::Grid::TrackInfo;
-            using Px = juce::Grid::Px;
-            using Fr = juce::Grid::Fr;
-            grid.autoFlow = juce::Grid::AutoFlow::column;
-            grid.templateRows.add(Track(Px(getHeight())));
-
-            for (auto i = 0; i < _components.size(); i++)
-            {
-                auto child = _tree.getChild(i);
-                if (child.isValid() && child.hasProperty(dockProps::widthProperty) && i != _components.size() - 2)
-                {
-                    grid.templateColumns.add(Track(Px(_data.getWidth(child))));
-                }
-                else
-                {
-                    grid.templateColumns.add(Track(Fr(1)));
-                }
-                
-                grid.items.add(_components[i].get());
-                
-                if (i < _resizerBars.size())
-                {
-                    grid.templateColumns.add(Track(Px(_resizerSize)));
-                    grid.items.add(_resizerBars[i].get());
-                }
-            }
-            
-            grid.performLayout(bounds);
+            layoutSplit(bounds, false);
             break;
         }
         case DockTypes::vertical:
         {
-            juce::Grid grid;
-            using Track = juce::Grid::TrackInfo;
-            using Px = juce::Grid::Px;
-            using Fr = juce::Grid::Fr;
-            grid.autoFlow = juce::Grid::AutoFlow::row;
-            grid.templateColumns.add(Track(Px(getWidth())));
-            
-            for (auto i = 0; i < _components.size(); i++)
-            {
-                auto child = _tree.getChild(i);
-        
-                if (child.isValid() && child.hasProperty(dockProps::heightProperty) && i != _components.size() - 2)
-                {
-                    grid.templateRows.add(Track(Px(_data.getHeight(child))));
-                }
-                else
-                {
-                    grid.templateRows.add(Track(Fr(1)));
-                }
-                grid.items.add(_components[i].get());
-                
-                if (i < _resizerBars.size())
-                {
-                    grid.templateRows.add(Track(Px(_resizerSize)));
-                    grid.items.add(_resizerBars[i].get());
-                }
-            }
-            
-            grid.performLayout(bounds);
+            layoutSplit(bounds, true);
             break;
         }
     }
@@ -340,6 +300,14 @@ void DockingComponent::lookAndFeelChanged()
 }
 
 
+void DockingComponent::visibilityChanged()
+{
+    /// A hidden tab can also be shown by being moved out of its tabs
+    if (isVisible())
+        createPendingView();
+}
+
+
 
 
 
@@ -395,7 +363,8 @@ void DockingComponent::focusOfChildComponentChanged(FocusChangeType cause)
 void DockingComponent::setupWithTree()
 {
     /// Add Listener
-    _tree.addListener(this);
+    _manager._dispatcher.addListener(_tree, this);
+    _manager._dispatcher.addTransactionListener(_tree, this);
     
     /// Set The Name of the component
     auto name = _data.getName(_tree);
@@ -405,8 +374,86 @@ void DockingComponent::setupWithTree()
     setupHeader();
     
     /// Add Subviews
+    reconcile();
+}
+
+
+void DockingComponent::syncSubviews()
+{
+    /// Keep the subviews whose tree is still a child, create the rest
+    juce::Array<std::shared_ptr<DockingComponent>> components;
     for (auto child : _tree)
-        valueTreeChildAdded(_tree, child);
+    {
+        std::shared_ptr<DockingComponent> component = nullptr;
+        for (auto existing : _components)
+            if (existing->_tree == child)
+                component = existing;
+        
+        if (component == nullptr)
+        {
+            component = getSubview(child);
+            addChildComponent(component.get());
+        }
+        
+        component->setVisible(!isTabs());
+        components.add(component);
+    }
+    
+    /// Dropped subviews remove themselves from this component, unless their tree moved
+    _components.swapWith(components);
+    for (auto component : components)
+        if (!_components.contains(component))
+            _manager.detachDockingComponent(component);
+}
+
+
+std::shared_ptr<DockingComponent> DockingComponent::getSubview(const juce::ValueTree& child)
+{
+    /// A tree which moved here brings its component, and all of its subviews, along
+    if (auto component = _manager.reattachDockingComponent(child))
+    {
+        auto oldParent = dynamic_cast<DockingComponent*>(component->getParentComponent());
+        if (oldParent != nullptr && oldParent != this)
+            oldParent->_components.removeFirstMatchingValue(component);
+        
+        component->setupHeader();
+        component->setupKeyboardFocus();
+        return component;
+    }
+    
+    auto component = std::make_shared<DockingComponent>(_manager, _data, child);
+    _manager.registerDockingComponent(component);
+    return component;
+}
+
+
+void DockingComponent::finishConstruction()
+{
+    if (!_isConstructing) {return;}
+    _isConstructing = false;
+    resized();
+    
+    for (auto component : _components)
+        component->finishConstruction();
+}
+
+
+void DockingComponent::reconcile()
+{
+    cancelLiveResize();
+    syncSubviews();
+    
+    /// Select a tab if none selected
+    if (_data.getSelectedId(_tree).isEmpty() && isTabs() && _tree.getNumChildren() > 0)
+        _data.setSelected(_tree, _data.getUuid(_tree.getChild(0)));
+    
+    /// Setup
+    selectedTabDidChange();
+    setupResizerBars();
+    setupHeader();
+    setupKeyboardFocus();
+    resizeParent();
+    repaint();
 }
 
 
@@ -419,13 +466,21 @@ void DockingComponent::setupView()
         removeChildComponent(_view.get());
      }
     
+    /// Hidden tabs can wait until they're selected
+    _isViewPending = !_view && _manager.shouldDeferView(_tree);
+    if (_isViewPending)
+    {
+        setupKeyboardFocus();
+        return;
+    }
+    
     /// Get the Component from the manager
     _view = _manager.getComponent(uuid, name);
     
     if (_view)
     {
         _view->setName(name); 
-        if (!_view->getParentComponent())
+        if (_view->getParentComponent() != this)
             addAndMakeVisible(_view.get());
     }
     
@@ -433,6 +488,14 @@ void DockingComponent::setupView()
 }
 
 
+void DockingComponent::createPendingView()
+{
+    if (!_isViewPending) {return;}
+    setupView();
+    resized();
+}
+
+
 void DockingComponent::setupHeader()
 {
     if (!shouldShowHeader())
@@ -499,7 +562,12 @@ void DockingComponent::selectedTabDidChange()
     if (!isTabs()) {return;}
     auto selectedTab = _data.getSelectedId(_tree);
     for (auto tab : _components)
+    {
         tab->setVisible(selectedTab == tab->getUuid());
+        if (tab->isVisible())
+            tab->createPendingView();
+    }
+    _manager.updateViewVisibility(_tree);
     
     /// Reset Focus
     focusOfChildComponentChanged(FocusChangeType::focusChangedDirectly);
@@ -517,12 +585,17 @@ void DockingComponent::selectedTabDidChange()
 
 void DockingComponent::valueTreeChildAdded(juce::ValueTree& parentTree, juce::ValueTree& childWhichHasBeenAdded)
 {
-    if (parentTree != _tree) {return;}
+    if (parentTree != _tree || _data.isInTransaction()) {return;}
     if (PRINT_TREE_LISTENERS) DBG("Value Tree Child Added: Component " << _data.getUuid(childWhichHasBeenAdded));
+    DockCounters::treeCallbacks++;
+    _committedHash = _data.getHash(_tree);
+    
+    /// The indexes a live resize was using have moved
+    cancelLiveResize();
     
     /// Create Subview
     auto id = _data.getUuid(childWhichHasBeenAdded);
-    auto newView = std::make_shared<DockingComponent>(_manager, _data, childWhichHasBeenAdded);
+    auto newView = getSubview(childWhichHasBeenAdded);
     auto index = parentTree.indexOf(childWhichHasBeenAdded);
     _components.insert(index, newView);
     
@@ -549,10 +622,13 @@ void DockingComponent::valueTreeChildAdded(juce::ValueTree& parentTree, juce::Va
 
 void DockingComponent::valueTreeChildRemoved(juce::ValueTree& parentTree, juce::ValueTree& childWhichHasBeenRemoved, int indexFromWhichChildWasRemoved)
 {
-    if (parentTree != _tree) {return;}
+    if (parentTree != _tree || _data.isInTransaction()) {return;}
     if (PRINT_TREE_LISTENERS) DBG("Value Tree Child Removed: Component " << _data.getUuid(childWhichHasBeenRemoved));
+    DockCounters::treeCallbacks++;
+    _committedHash = _data.getHash(_tree);
     
     /// Get Id
+    cancelLiveResize();
     _components.remove(indexFromWhichChildWasRemoved);
     setupHeader();
     setupResizerBars();
@@ -562,8 +638,9 @@ void DockingComponent::valueTreeChildRemoved(juce::ValueTree& parentTree, juce::
 
 void DockingComponent::valueTreeParentChanged(juce::ValueTree& treeWhoseParentHasChanged)
 {
-    if (treeWhoseParentHasChanged != _tree) {return;}
+    if (treeWhoseParentHasChanged != _tree || _data.isInTransaction()) {return;}
     if (PRINT_TREE_LISTENERS) DBG("Value Tree Child Parent Changed: Component " << _data.getUuid(treeWhoseParentHasChanged));
+    DockCounters::treeCallbacks++;
     setupHeader();
     setupKeyboardFocus();
 }
@@ -571,8 +648,11 @@ void DockingComponent::valueTreeParentChanged(juce::ValueTree& treeWhoseParentHa
 
 void DockingComponent::valueTreeChildOrderChanged(juce::ValueTree& parentTreeWhoseChildrenHaveMoved, int oldIndex, int newIndex)
 {
-    if (parentTreeWhoseChildrenHaveMoved != _tree) {return;}
+    if (parentTreeWhoseChildrenHaveMoved != _tree || _data.isInTransaction()) {return;}
     if (PRINT_TREE_LISTENERS) DBG("Value Tree Order Changed: Component " << _data.getUuid(parentTreeWhoseChildrenHaveMoved));
+    DockCounters::treeCallbacks++;
+    _committedHash = _data.getHash(_tree);
+    cancelLiveResize();
     setupHeader();
     setupKeyboardFocus();
 }
@@ -580,25 +660,27 @@ void DockingComponent::valueTreeChildOrderChanged(juce::ValueTree& parentTreeWho
 
 void DockingComponent::valueTreePropertyChanged(juce::ValueTree& treeWhosePropertyHasChanged, const juce::Identifier& property)
 {
-    if (treeWhosePropertyHasChanged != _tree) {return;}
+    if (treeWhosePropertyHasChanged != _tree || _data.isInTransaction()) {return;}
+    DockCounters::treeCallbacks++;
+    _committedHash = _data.getHash(_tree);
     
-    if (property.toString() == dockProps::xProperty || property.toString() == dockProps::yProperty)
+    if (dockNode::is<dockSchema::x>(property) || dockNode::is<dockSchema::y>(property))
     {
         resizeParent();
     }
-    else if (property.toString() == dockProps::widthProperty || property.toString() == dockProps::heightProperty)
+    else if (dockNode::is<dockSchema::width>(property) || dockNode::is<dockSchema::height>(property))
     {
         resizeParent();
     }
-    else if (property.toString() == dockProps::selectedProperty)
+    else if (dockNode::is<dockSchema::selected>(property))
     {
         selectedTabDidChange();
     }
-    else if (property.toString() == dockProps::dockType)
+    else if (dockNode::is<dockSchema::dockType>(property))
     {
         resized();
     }
-    else if (property.toString() == dockProps::nameProperty)
+    else if (dockNode::is<dockSchema::name>(property))
     {
         setupView();
     }
@@ -612,6 +694,42 @@ void DockingComponent::valueTreePropertyChanged(juce::ValueTree& treeWhoseProper
 
 
 
+/**
+ ===================================
+ MARK: - Transactions -
+ ===================================
+ */
+
+void DockingComponent::transactionDidCommit(const juce::ValueTree& affectedTree)
+{
+    if (affectedTree != _tree || _builtInCommit == _data.getCommitNumber()) {return;}
+    
+    /// Changed and changed back within the transaction, the last pass still holds
+    auto hash = _data.getHash(_tree);
+    if (hash == _committedHash && hasSubviewsForTree()) {return;}
+    DockCounters::treeCallbacks++;
+    
+    /// One pass for everything that changed on this tree
+    auto name = _data.getName(_tree);
+    setName(name.isEmpty() ? "comp" : name);
+    setupView();
+    reconcile();
+    _committedHash = _data.getHash(_tree);
+}
+
+
+const bool DockingComponent::hasSubviewsForTree() const
+{
+    /// The same trees, not just equal ones
+    if (_components.size() != _tree.getNumChildren()) {return false;}
+    for (auto i = 0; i < _components.size(); i++)
+        if (_components[i]->_tree != _tree.getChild(i))
+            return false;
+    
+    return true;
+}
+
+
 /**
  ===================================
  MARK: - Drag and Drop Target -
@@ -643,54 +761,15 @@ void DockingComponent::itemDragExit(const SourceDetails &dragSourceDetails)
 
 void DockingComponent::itemDragMove(const SourceDetails &dragSourceDetails)
 {
-    auto location = getDragLocation(getMouseXYRelative());
     auto rootComponent = findParentComponentOfClass<WindowComponent>();
     if (!rootComponent) {repaint(); return;}
-    auto treeThatIsMoving = dragSourceDetails.description[0].toString();
-    auto [treeToDropAt, index] = _data.getTreeForDockLocation(getUuid(), location);
     
-    if (_data.isRootTree(treeToDropAt))
-    {
-        switch (location)
-        {
-            case DropLocation::parentLeft:
-            case DropLocation::viewLeft:
-            {
-                location = DropLocation::rootLeft;
-                break;
-            }
-            case DropLocation::parentRight:
-            case DropLocation::viewRight:
-            {
-                location = DropLocation::rootRight;
-                break;
-            }
-            case DropLocation::parentTop:
-            case DropLocation::viewTop:
-            {
-                location = DropLocation::rootTop;
-                break;
-            }
-            case DropLocation::parentBottom:
-            case DropLocation::viewBottom:
-            {
-                location = DropLocation::rootBottom;
-                break;
-            }
-            default:
-                break;
-        }
-    }
-//
-//    DBG("Tree to Drop At: " << _data.getName(treeToDropAt)
-//        <<", Dragging: " << _data.getName(treeThatIsMoving)
-//        << ", Location: " << _data.dropLocationToString(location)
-//        << ", Index: " << index);
-//
-    if (treeToDropAt == treeThatIsMoving || getUuid() == treeThatIsMoving)
-        rootComponent->hideDropHandle();
+    /// Worked out when the drag started, unless this component wasn't around then
+    auto position = getMouseXYRelative();
+    if (auto zone = _manager._dropZones.findZone(getUuid(), position))
+        rootComponent->showDropZone(*zone);
     else
-        rootComponent->showDropHandleAt(treeToDropAt, index, location);
+        rootComponent->showDropZone(getDropZone(getDragLocation(position), dragSourceDetails.description[0].toString()));
 }
 
 
@@ -720,31 +799,37 @@ void DockingComponent::itemDropped(const SourceDetails &dragSourceDetails)
 
 const DropLocation DockingComponent::getDragLocation(const juce::Point<int> position) const
 {
+    for (const auto& area : getDropAreas())
+        if (area.area.contains(position))
+            return area.location;
+    
+    return DropLocation::none;
+}
+
+
+const juce::Array<DropZoneIndex::Zone> DockingComponent::getDropAreas() const
+{
+    /// In the order they're checked
+    juce::Array<DropZoneIndex::Zone> areas;
     auto bounds = getLocalBounds();
     if (shouldShowHeader())
         bounds.removeFromTop(_headerHeight);
     
     for (auto resize : _resizerBars)
-        if (resize->getBoundsInParent().contains(position))
-            return DropLocation::none;
+        areas.add({resize->getBoundsInParent(), DropLocation::none});
     
     if (auto peer = getPeer())
     {
-        auto peerPosition = localPointToGlobal(position);
         auto peerBounds = peer->getBounds().withPosition(0, 0).reduced(5);
         auto rootTop = peerBounds.removeFromTop(_rootHitSize);
         auto rootBottom = peerBounds.removeFromBottom(_rootHitSize);
         auto rootLeft = peerBounds.removeFromLeft(_rootHitSize);
         auto rootRight = peerBounds.removeFromRight(_rootHitSize);
         
-        if (rootTop.contains(peerPosition))
-            return DropLocation::rootTop;
-        else if (rootBottom.contains(peerPosition))
-            return DropLocation::rootBottom;
-        else if (rootLeft.contains(peerPosition))
-            return DropLocation::rootLeft;
-        else if (rootRight.contains(peerPosition))
-            return DropLocation::rootRight;
+        areas.add({getLocalArea(nullptr, rootTop), DropLocation::rootTop});
+        areas.add({getLocalArea(nullptr, rootBottom), DropLocation::rootBottom});
+        areas.add({getLocalArea(nullptr, rootLeft), DropLocation::rootLeft});
+        areas.add({getLocalArea(nullptr, rootRight), DropLocation::rootRight});
     }
     
     auto parentTop = bounds.removeFromTop(_parentHitSize);
@@ -756,26 +841,82 @@ const DropLocation DockingComponent::getDragLocation(const juce::Point<int> posi
     auto viewLeft = bounds.removeFromLeft(_viewHitSize);
     auto viewRight = bounds.removeFromRight(_viewHitSize);
     
-    if (parentTop.contains(position))
-        return DropLocation::parentTop;
-    else if (parentBottom.contains(position))
-        return DropLocation::parentBottom;
-    else if (parentLeft.contains(position))
-        return DropLocation::parentLeft;
-    else if (parentRight.contains(position))
-        return DropLocation::parentRight;
-    else if (viewTop.contains(position))
-        return DropLocation::viewTop;
-    else if (viewBottom.contains(position))
-        return DropLocation::viewBottom;
-    else if (viewLeft.contains(position))
-        return DropLocation::viewLeft;
-    else if (viewRight.contains(position))
-        return DropLocation::viewRight;
-    else if (bounds.contains(position))
-        return DropLocation::tabs;
-    else
-        return DropLocation::none;
+    areas.add({parentTop, DropLocation::parentTop});
+    areas.add({parentBottom, DropLocation::parentBottom});
+    areas.add({parentLeft, DropLocation::parentLeft});
+    areas.add({parentRight, DropLocation::parentRight});
+    areas.add({viewTop, DropLocation::viewTop});
+    areas.add({viewBottom, DropLocation::viewBottom});
+    areas.add({viewLeft, DropLocation::viewLeft});
+    areas.add({viewRight, DropLocation::viewRight});
+    areas.add({bounds, DropLocation::tabs});
+    return areas;
+}
+
+
+const DropZoneIndex::Zone DockingComponent::getDropZone(DropLocation location, const juce::String& draggingId) const
+{
+    auto [treeToDropAt, index] = _data.getTreeForDockLocation(getUuid(), location);
+    
+    /// Docking next to the root view docks in the root
+    if (_data.isRootTree(treeToDropAt))
+    {
+        switch (location)
+        {
+            case DropLocation::parentLeft:
+            case DropLocation::viewLeft:
+            {
+                location = DropLocation::rootLeft;
+                break;
+            }
+            case DropLocation::parentRight:
+            case DropLocation::viewRight:
+            {
+                location = DropLocation::rootRight;
+                break;
+            }
+            case DropLocation::parentTop:
+            case DropLocation::viewTop:
+            {
+                location = DropLocation::rootTop;
+                break;
+            }
+            case DropLocation::parentBottom:
+            case DropLocation::viewBottom:
+            {
+                location = DropLocation::rootBottom;
+                break;
+            }
+            default:
+                break;
+        }
+    }
+    
+    DropZoneIndex::Zone zone;
+    zone.location = location;
+    zone.treeToDropAt = treeToDropAt;
+    zone.index = index;
+    zone.showsHandle = treeToDropAt != draggingId && getUuid() != draggingId;
+    if (zone.showsHandle)
+        if (auto rootComponent = findParentComponentOfClass<WindowComponent>())
+            zone.handleBounds = rootComponent->getDropHandleBounds(treeToDropAt, index, location);
+    return zone;
+}
+
+
+void DockingComponent::addDropZones(DropZoneIndex& index, const juce::String& draggingId) const
+{
+    auto zones = getDropAreas();
+    for (auto& zone : zones)
+    {
+        auto area = zone.area;
+        zone = getDropZone(zone.location, draggingId);
+        zone.area = area;
+    }
+    
+    index.addTarget(getUuid(), zones, getDropZone(DropLocation::none, draggingId));
+    for (auto component : _components)
+        component->addDropZones(index, draggingId);
 }
 
 
@@ -798,11 +939,13 @@ void DockingComponent::dragOperationStarted(const juce::DragAndDropTarget::Sourc
         comp->setVisible(false);
     
     _manager.setCreateNewView(true);
+    _manager.buildDropZones(details.description[0].toString());
 }
 
 
 void DockingComponent::dragOperationEnded(const juce::DragAndDropTarget::SourceDetails& details)
 {
+    _manager.clearDropZones();
     if (auto comp = details.sourceComponent)
         comp->setVisible(true);
     
@@ -825,46 +968,118 @@ void DockingComponent::dragOperationEnded(const juce::DragAndDropTarget::SourceD
 
 void DockingComponent::resizerDidDrag(juce::Point<float> delta, int index)
 {
-    if (index >= _components.size()) {return;}
- 
-    /// Chr
-    auto tree = _tree.getChild(index);
-    auto comp = _components[index];
+    if (index >= _components.size() - 1 || index >= _resizerBars.size()) {return;}
+    auto resize = dynamic_cast<ResizerBar*>(_resizerBars[index].get());
+    if (resize == nullptr) {return;}
+    auto vertical = resize->isVertical();
     
-    /// Next
-    auto nextTree = _tree.getChild(index + 1);
-    auto nextComp = index + 1 > _components.size() - 1 ? nullptr : _components[index + 1];
+    /// Start from the tree, or from the subviews if no size was set yet
+    if (_liveResizeIndex != index)
+    {
+        auto size = _data.getSize(_tree.getChild(index));
+        auto nextSize = _data.getSize(_tree.getChild(index + 1));
+        auto comp = _components[index];
+        auto nextComp = _components[index + 1];
+        
+        _liveResizeIndex = index;
+        _liveResizeStart = vertical
+            ? std::make_pair(size.isOrigin() ? (float) comp->getHeight() : size.y, nextSize.isOrigin() ? (float) nextComp->getHeight() : nextSize.y)
+            : std::make_pair(size.isOrigin() ? (float) comp->getWidth() : size.x, nextSize.isOrigin() ? (float) nextComp->getWidth() : nextSize.x);
+        _liveResizeSizes = _liveResizeStart;
+    }
     
-    auto resize = dynamic_cast<ResizerBar*>(_resizerBars[index].get());
-    if (!tree.isValid() || comp == nullptr || resize == nullptr) {return;}
+    /// Nothing is written to the tree until the mouse is released
+    auto amount = vertical ? delta.y : delta.x;
+    _liveResizeSizes.first += amount;
+    _liveResizeSizes.second -= amount;
     
-    auto size = _data.getSize(tree);
-    auto nextSize = nextTree.isValid() ? _data.getSize(nextTree) : juce::Point<float>();
-    auto isOrigin = size.isOrigin();
-    auto vertical = resize->isVertical();
+    /// Only the two either side of the bar moved, the one before last still takes up the slack
+    auto item = index * 2;
+    _splitLayout.setItem(item, _components[index].get(), _liveResizeSizes.first, index != _components.size() - 2);
+    _splitLayout.setItem(item + 2, _components[index + 1].get(), _liveResizeSizes.second, index + 1 != _components.size() - 2);
+    if (!_splitLayout.performLayout(item, item + 2))
+        resized();
+    
+    checkWillDisappear();
+}
+
+
+void DockingComponent::resizerMouseUp()
+{
+    commitLiveResize();
+    checkWillDisappear();
+    checkViewsShouldExist();
+}
+
+
+void DockingComponent::commitLiveResize()
+{
+    if (_liveResizeIndex < 0) {return;}
+    auto index = _liveResizeIndex;
+    auto sizes = _liveResizeSizes;
+    cancelLiveResize();
     
-    if (vertical)
+    auto tree = _tree.getChild(index);
+    auto nextTree = _tree.getChild(index + 1);
+    auto resize = dynamic_cast<ResizerBar*>(_resizerBars[index].get());
+    if (!tree.isValid() || !nextTree.isValid() || resize == nullptr) {return;}
+    
+    if (resize->isVertical())
     {
-        _data.setHeight(tree, isOrigin ? comp->getHeight() + delta.y : size.y + delta.y);
-        if (nextTree.isValid() && nextComp != nullptr)
-            _data.setHeight(nextTree, nextSize.isOrigin() ? nextComp->getHeight() - delta.y : nextSize.y - delta.y);
+        _data.setHeight(tree, sizes.first);
+        _data.setHeight(nextTree, sizes.second);
     }
     else
     {
-        _data.setWidth(tree, isOrigin ? comp->getWidth() + delta.x : size.x + delta.x);
-        if (nextTree.isValid() && nextComp != nullptr)
-            _data.setWidth(nextTree, nextSize.isOrigin() ? nextComp->getWidth() - delta.x : nextSize.x - delta.x);
+        _data.setWidth(tree, sizes.first);
+        _data.setWidth(nextTree, sizes.second);
     }
     
     resized();
-    checkWillDisappear();
 }
 
 
-void DockingComponent::resizerMouseUp()
+void DockingComponent::cancelLiveResize()
 {
-    checkWillDisappear();
-    checkViewsShouldExist();
+    /// The next drag starts again from the tree
+    _liveResizeIndex = -1;
+    _liveResizeStart = {};
+    _liveResizeSizes = {};
+}
+
+
+const bool DockingComponent::getSplitSize(int index, bool vertical, float& size) const
+{
+    /// A live resize stands in for the tree
+    if (_liveResizeIndex >= 0 && (index == _liveResizeIndex || index == _liveResizeIndex + 1))
+    {
+        size = index == _liveResizeIndex ? _liveResizeSizes.first : _liveResizeSizes.second;
+        return true;
+    }
+    
+    auto child = _tree.getChild(index);
+    if (!child.isValid() || !(vertical ? dockNode::has<dockSchema::height>(child) : dockNode::has<dockSchema::width>(child))) {return false;}
+    size = vertical ? _data.getHeight(child) : _data.getWidth(child);
+    return true;
+}
+
+
+void DockingComponent::layoutSplit(const juce::Rectangle<int>& bounds, bool vertical)
+{
+    /// Each subview is followed by its resizer bar, the one before last always takes up the slack
+    _splitLayout.setNumItems(_components.size() + juce::jmin(_components.size(), _resizerBars.size()));
+    auto item = 0;
+    for (auto i = 0; i < _components.size(); i++)
+    {
+        auto size = 0.0f;
+        auto isFixed = getSplitSize(i, vertical, size) && i != _components.size() - 2;
+        _splitLayout.setItem(item++, _components[i].get(), size, isFixed);
+        
+        if (i < _resizerBars.size())
+            _splitLayout.setItem(item++, _resizerBars[i].get(), (float) _resizerSize, true);
+    }
+    
+    _splitLayout.performLayout(bounds, (float) (vertical ? getWidth() : getHeight()), vertical);
 }
 
 
@@ -920,6 +1135,7 @@ void DockingComponent::resetDisplayName()
 
 bool DockingComponent::keyPressed(const juce::KeyPress& key)
 {
+    _manager.didReceiveInput();
     if (!hasKeyboardFocus(true) || !key.isCurrentlyDown()) {return false;}
     if (keyPressed_tabs(key))
         return true;
@@ -966,7 +1182,7 @@ bool DockingComponent::keyPressed_tabs(const juce::KeyPress& key)
 bool DockingComponent::selectNextTab()
 {
     auto selected = _data.getSelectedId(_tree);
-    auto child = _tree.getChildWithProperty(dockProps::uuidProperty, selected);
+    auto child = _tree.getChildWithProperty(dockNode::getId<dockSchema::uuid>(), selected);
     if (!child.isValid()) {return false;}
     auto index = _tree.indexOf(child) + 1;
     if (index >= _tree.getNumChildren())
@@ -978,7 +1194,7 @@ bool DockingComponent::selectNextTab()
 bool DockingComponent::selectPreviousTab()
 {
     auto selected = _data.getSelectedId(_tree);
-    auto child = _tree.getChildWithProperty(dockProps::uuidProperty, selected);
+    auto child = _tree.getChildWithProperty(dockNode::getId<dockSchema::uuid>(), selected);
     if (!child.isValid()) {return false;}
     auto index = _tree.indexOf(child) - 1;
     if (index < 0)
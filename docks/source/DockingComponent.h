@@ -3,6 +3,9 @@
 #include <juce_gui_basics/juce_gui_basics.h>
 #include "HeaderComponent.h"
 #include "DockManagerData.h"
+#include "SplitLayout.h"
+#include "LayoutSolver.h"
+#include "DropZoneIndex.h"
 
 
 /**
@@ -25,9 +28,11 @@ class WindowComponent;
  -------------------------------------------------------------
  */
 
-class DockingComponent : public juce::Component, private juce::ValueTree::Listener, public juce::DragAndDropTarget, public juce::DragAndDropContainer
+class DockingComponent : public juce::Component, private juce::ValueTree::Listener, public juce::DragAndDropTarget, public juce::DragAndDropContainer, private DockManagerData::TransactionListener
 {
     friend class HeaderComponent;
+    friend class test_DockManager;
+    friend class bench_DockManager;
     
 public:
     
@@ -51,9 +56,13 @@ public:
     const bool isTabs() const;
     const juce::String getName() const;
     const juce::String getUuid() const;
+    const juce::ValueTree& getTree() const {return _tree;}
     const bool shouldShowHeader() const;
     const juce::Rectangle<int> getBoundsForSubview(const juce::String& uuid, int index) const;
     
+    /// Drop Zones, for this component and everything in it
+    void addDropZones(DropZoneIndex& index, const juce::String& draggingId) const;
+    
     /// Check Will Disappear
     void checkWillDisappear();
     
@@ -65,19 +74,27 @@ public:
 private:
 
     const DropLocation getDragLocation(const juce::Point<int> position) const;
+    const juce::Array<DropZoneIndex::Zone> getDropAreas() const;
+    const DropZoneIndex::Zone getDropZone(DropLocation location, const juce::String& draggingId) const;
  
 
     /// Component Overrides
     void paint(juce::Graphics &g) override;
     void resized() override;
     void lookAndFeelChanged() override;
+    void visibilityChanged() override;
     
     /// Setup
     void setupWithTree();
+    void syncSubviews();
+    std::shared_ptr<DockingComponent> getSubview(const juce::ValueTree& child);
+    void finishConstruction();
+    void reconcile();
     void setupHeader();
     void selectedTabDidChange();
     void setupResizerBars();
     void setupView();
+    void createPendingView();
     void setupKeyboardFocus();
     
     /// Value Tree Listener
@@ -87,6 +104,10 @@ private:
     void valueTreeChildOrderChanged(juce::ValueTree& parentTreeWhoseChildrenHaveMoved, int oldIndex, int newIndex) override;
     void valueTreePropertyChanged(juce::ValueTree& treeWhosePropertyHasChanged, const juce::Identifier& property) override;
     
+    /// Transactions
+    void transactionDidCommit(const juce::ValueTree& affectedTree) override;
+    const bool hasSubviewsForTree() const;
+    
     /// Focus
     void focusOfChildComponentChanged(FocusChangeType cause) override;
     
@@ -104,6 +125,10 @@ private:
     /// Resizer Utility
     void resizerDidDrag(juce::Point<float> delta, int index);
     void resizerMouseUp();
+    void commitLiveResize();
+    void cancelLiveResize();
+    const bool getSplitSize(int index, bool vertical, float& size) const;
+    void layoutSplit(const juce::Rectangle<int>& bounds, bool vertical);
     void checkViewsShouldExist();
     void setViewsMayDisappear();
     void resizeParent();
@@ -118,11 +143,11 @@ private:
     
 private:
     
-    const int _headerHeight = 25;
+    const int _headerHeight = LayoutSolver::headerHeight;
     const int _viewHitSize = 50;
     const int _parentHitSize = 25;
     const int _rootHitSize = 10;
-    const int _resizerSize = 5;
+    const int _resizerSize = LayoutSolver::resizerSize;
     const int _minimumSize = 100;
     
     /// Dock Manager
@@ -137,11 +162,13 @@ private:
     /// Components Parts
     juce::Array<std::shared_ptr<DockingComponent>> _components;
     juce::Array<std::shared_ptr<juce::Component>> _resizerBars;
+    SplitLayout _splitLayout;
     
     /// Header
     std::unique_ptr<HeaderComponent> _header = nullptr;
     std::unique_ptr<juce::Component> _floater = nullptr;
     std::shared_ptr<juce::Component> _view = nullptr;
+    bool _isViewPending = false;
     
     /// Drag and Drop
     bool _didDropOnView = false;
@@ -150,6 +177,21 @@ private:
     bool _didDrag = false;
     bool _willDisappear = false;
     
+    /// Live Resize, the sizes either side of a dragged bar only live here until the mouse is released
+    int _liveResizeIndex = -1;
+    std::pair<float, float> _liveResizeStart;
+    std::pair<float, float> _liveResizeSizes;
+    
+    /// The commit this was built during, so already up to date with
+    int _builtInCommit = -1;
+    
+    /// Subtree hash as of the last time this was brought up to date with its tree
+    juce::uint64 _committedHash = 0;
+    
+    /// Subviews built along with a component are laid out once, top down, when it is done
+    static inline int _constructionDepth = 0;
+    bool _isConstructing = true;
+    
     /// Utility
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DockingComponent)
 };
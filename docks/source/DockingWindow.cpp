@@ -140,7 +140,8 @@ void WindowDropHandle::setDropLocation(DropLocation type)
 WindowComponent::WindowComponent(DockingWindow& window, DockManager& manager, DockManagerData& data, const juce::ValueTree& tree) : _window(window), _manager(manager), _data(data), _tree(tree)
 {
     /// Listener
-    _tree.addListener(this);
+    _manager._dispatcher.addListener(_tree, this);
+    _manager._dispatcher.addTransactionListener(_tree, this);
     
     /// Component Size/Name
     setSize(400, 400);
@@ -160,7 +161,8 @@ WindowComponent::WindowComponent(DockingWindow& window, DockManager& manager, Do
 
 WindowComponent::~WindowComponent()
 {
-    _tree.removeListener(this);
+    _manager._dispatcher.removeListener(_tree, this);
+    _manager._dispatcher.removeTransactionListener(_tree, this);
 }
 
 
@@ -198,7 +200,7 @@ void WindowComponent::resized()
         _menuComponent->setBounds(bounds.removeFromTop(20));
 #endif
     
-    const int trim = 5;
+    const int trim = LayoutSolver::windowTrim;
     const int bottomTrim = _footerComponent != nullptr || _lockedButton != nullptr ? 0 : trim;
     if (_dockingComponent)
         _dockingComponent->setBounds(bounds.withTrimmedLeft(trim)
@@ -260,6 +262,30 @@ void WindowComponent::setupFooter()
 }
 
 
+void WindowComponent::setupLockedButton()
+{
+    auto locked = _data.isWindowLocked(_tree);
+    _window.setAlwaysOnTop(locked);
+    if (locked)
+    {
+        _lockedButton = std::make_unique<juce::ImageButton>();
+        auto image = juce::ImageCache::getFromMemory(BinaryData::LockOn_svg, BinaryData::LockOn_svgSize);
+        _lockedButton->setImages(true, true, true,
+                                 image, 1.0, juce::Colours::orange,     /// normal
+                                 image, 0.5, juce::Colours::lightblue,  /// Over
+                                 image, 0.8, juce::Colours::blue);      /// Down
+        _lockedButton->onClick = [this] {_data.setWindowLocked(_data.getUuid(_tree), false);};
+        addAndMakeVisible(_lockedButton.get());
+    }
+    else
+    {
+        _lockedButton = nullptr;
+    }
+    resized();
+    repaint();
+}
+
+
 void WindowComponent::layoutDidLoad()
 {
     if (_dockingComponent)
@@ -280,70 +306,71 @@ void WindowComponent::resetAllDisplayNames()
  ====================================
  */
 void WindowComponent::showDropHandleAt(const juce::String& uuid, int index, DropLocation location)
+{
+    showDropHandle(getDropHandleBounds(uuid, index, location), location);
+}
+
+
+void WindowComponent::showDropHandle(const juce::Rectangle<int>& bounds, DropLocation location)
 {
     if (!_dockingComponent) {return;}
-    auto bounds = getLocalArea(nullptr, _dockingComponent->getBoundsForSubview(uuid, index));
     _dropHandle.setDropLocation(location);
     _dropHandle.setVisible(true);
     _dropHandle.toFront(false);
     
+    if (location != DropLocation::none)
+        _dropHandle.setBounds(bounds);
+}
+
+
+void WindowComponent::showDropZone(const DropZoneIndex::Zone& zone)
+{
+    if (zone.showsHandle)
+        showDropHandle(zone.handleBounds, zone.location);
+    else
+        hideDropHandle();
+}
+
+
+const juce::Rectangle<int> WindowComponent::getDropHandleBounds(const juce::String& uuid, int index, DropLocation location) const
+{
+    if (!_dockingComponent) {return {};}
+    
+    /// Straight to the component when it's in this window, rather than searching every one for it
+    auto subview = _manager._dockingComponents[uuid].lock();
+    auto searchFrom = subview != nullptr && subview->findParentComponentOfClass<WindowComponent>() == this ? subview.get() : _dockingComponent.get();
+    auto bounds = getLocalArea(nullptr, searchFrom->getBoundsForSubview(uuid, index));
+    
     const int handleSize = 10;
     switch (location)
     {
         case DropLocation::tabs:
-        {
-            _dropHandle.setBounds(bounds);
-            break;
-        }
+            return bounds;
         case DropLocation::parentTop:
         case DropLocation::viewTop:
-        {
-            _dropHandle.setBounds(bounds.removeFromTop(handleSize));
-            break;
-        }
+            return bounds.removeFromTop(handleSize);
         case DropLocation::parentBottom:
         case DropLocation::viewBottom:
-        {
-            _dropHandle.setBounds(bounds.removeFromBottom(handleSize));
-            break;
-        }
+            return bounds.removeFromBottom(handleSize);
         case DropLocation::parentLeft:
         case DropLocation::viewLeft:
-        {
-            _dropHandle.setBounds(bounds.removeFromLeft(handleSize));
-            break;
-        }
+            return bounds.removeFromLeft(handleSize);
         case DropLocation::parentRight:
         case DropLocation::viewRight:
-        {
-            _dropHandle.setBounds(bounds.removeFromRight(handleSize));
-            break;
-        }
+            return bounds.removeFromRight(handleSize);
         case DropLocation::rootTop:
-        {
-            _dropHandle.setBounds(getLocalBounds().removeFromTop(handleSize));
-            break;
-        }
+            return getLocalBounds().removeFromTop(handleSize);
         case DropLocation::rootBottom:
-        {
-            _dropHandle.setBounds(getLocalBounds().removeFromBottom(handleSize));
-            break;
-        }
+            return getLocalBounds().removeFromBottom(handleSize);
         case DropLocation::rootLeft:
-        {
-            _dropHandle.setBounds(getLocalBounds().removeFromLeft(handleSize));
-            break;
-        }
+            return getLocalBounds().removeFromLeft(handleSize);
         case DropLocation::rootRight:
-        {
-            _dropHandle.setBounds(getLocalBounds().removeFromRight(handleSize));
-            break;
-        }
+            return getLocalBounds().removeFromRight(handleSize);
         case DropLocation::none:
-        {
-            break; 
-        }
+            return {};
     }
+    
+    return {};
 }
 
 
@@ -385,8 +412,9 @@ void WindowComponent::refresh()
 
 void WindowComponent::valueTreeChildAdded(juce::ValueTree& parentTree, juce::ValueTree& childWhichHasBeenAdded)
 {
-    if (parentTree != _tree) {return;}
+    if (parentTree != _tree || _data.isInTransaction()) {return;}
     if (PRINT_TREE_LISTENERS) DBG("Value Tree Added: WindowComp " << _data.getName(_tree) << " " << _data.getName(childWhichHasBeenAdded));
+    DockCounters::treeCallbacks++;
     
     /// Remove Component
     if (_dockingComponent != nullptr)
@@ -405,8 +433,9 @@ void WindowComponent::valueTreeChildAdded(juce::ValueTree& parentTree, juce::Val
 
 void WindowComponent::valueTreeChildRemoved(juce::ValueTree& parentTree, juce::ValueTree& childWhichHasBeenRemoved, int indexFromWhichChildWasRemoved)
 {
-    if (parentTree != _tree.getParent()) {return;}
+    if (parentTree != _tree.getParent() || _data.isInTransaction()) {return;}
     if (PRINT_TREE_LISTENERS) DBG("Value Tree Removed: WindowComp");
+    DockCounters::treeCallbacks++;
     if (childWhichHasBeenRemoved == parentTree.getChild(0) && _dockingComponent != nullptr)
     {
         removeChildComponent(_dockingComponent.get()); 
@@ -430,30 +459,38 @@ void WindowComponent::valueTreeChildOrderChanged(juce::ValueTree& parentTreeWhos
 
 void WindowComponent::valueTreePropertyChanged(juce::ValueTree& treeWhosePropertyHasChanged, const juce::Identifier& property)
 {
-    if (treeWhosePropertyHasChanged != _tree) {return;}
+    if (treeWhosePropertyHasChanged != _tree || _data.isInTransaction()) {return;}
     if (PRINT_TREE_LISTENERS) DBG("Value Tree Property Changed: WindowComp");
-    if (property.toString() == dockProps::lockedProperty)
-    {
-        auto locked = _data.isWindowLocked(_tree);
-        _window.setAlwaysOnTop(locked);
-        if (locked)
-        {
-            _lockedButton = std::make_unique<juce::ImageButton>();
-            auto image = juce::ImageCache::getFromMemory(BinaryData::LockOn_svg, BinaryData::LockOn_svgSize);
-            _lockedButton->setImages(true, true, true,
-                                     image, 1.0, juce::Colours::orange,     /// normal
-                                     image, 0.5, juce::Colours::lightblue,  /// Over
-                                     image, 0.8, juce::Colours::blue);      /// Down
-            _lockedButton->onClick = [this] {_data.setWindowLocked(_data.getUuid(_tree), false);};
-            addAndMakeVisible(_lockedButton.get());
-        }
-        else
-        {
-            _lockedButton = nullptr;
-        }
-        resized();
-        repaint();
-    }
+    DockCounters::treeCallbacks++;
+    if (dockNode::is<dockSchema::locked>(property))
+        setupLockedButton();
+}
+
+
+
+
+
+/**
+ ===================================
+ MARK: - Transactions -
+ ===================================
+ */
+
+void WindowComponent::transactionDidCommit(const juce::ValueTree& affectedTree)
+{
+    if (affectedTree != _tree) {return;}
+    DockCounters::treeCallbacks++;
+    
+    /// Rebuild only if the root view was replaced
+    auto rootView = _tree.getChild(0);
+    if (_dockingComponent == nullptr || _dockingComponent->getUuid() != _data.getUuid(rootView))
+        refresh();
+    
+    if (_data.isWindowLocked(_tree) != (_lockedButton != nullptr))
+        setupLockedButton();
+    
+    /// A reloaded layout may have moved the window
+    _window.updateBounds();
 }
 
 
@@ -487,19 +524,12 @@ void WindowComponent::itemDragExit(const SourceDetails &dragSourceDetails)
 
 void WindowComponent::itemDragMove(const SourceDetails &dragSourceDetails)
 {
-    auto location = getDragLocation(getMouseXYRelative());
-    auto treeThatIsMoving = dragSourceDetails.description[0].toString();
-    auto [treeToDropAt, index] = _data.getTreeForDockLocation(_data.getUuid(_tree), location);
-    
-//    DBG("Tree to Drop At: " << _data.getName(treeToDropAt)
-//        <<", Dragging: " << treeThatIsMoving
-//        << ", Location: " << _data.dropLocationToString(location)
-//        << ", Point: " << localPointToGlobal(getMouseXYRelative()).toString());
-
-    if (treeToDropAt == treeThatIsMoving || _data.getUuid(_tree) == treeThatIsMoving)
-        hideDropHandle();
+    /// Worked out when the drag started, unless this window wasn't around then
+    auto position = getMouseXYRelative();
+    if (auto zone = _manager._dropZones.findZone(_data.getUuid(_tree), position))
+        showDropZone(*zone);
     else
-        showDropHandleAt(treeToDropAt, index, location);
+        showDropZone(getDropZone(getDragLocation(position), dragSourceDetails.description[0].toString()));
 }
 
 
@@ -529,23 +559,62 @@ void WindowComponent::itemDropped(const SourceDetails &dragSourceDetails)
 
 const DropLocation WindowComponent::getDragLocation(const juce::Point<int>& position) const
 {
+    for (const auto& area : getDropAreas())
+        if (area.area.contains(position))
+            return area.location;
+    
+    return DropLocation::none;
+}
+
+
+const juce::Array<DropZoneIndex::Zone> WindowComponent::getDropAreas() const
+{
+    /// In the order they're checked
     auto peerBounds = getLocalBounds();
     const int rootHitSize = 10;
     auto rootTop = peerBounds.removeFromTop(rootHitSize);
     auto rootBottom = peerBounds.removeFromBottom(rootHitSize);
     auto rootLeft = peerBounds.removeFromLeft(rootHitSize);
     auto rootRight = peerBounds.removeFromRight(rootHitSize);
+    
+    juce::Array<DropZoneIndex::Zone> areas;
+    areas.add({rootTop, DropLocation::rootTop});
+    areas.add({rootBottom, DropLocation::rootBottom});
+    areas.add({rootLeft, DropLocation::rootLeft});
+    areas.add({rootRight, DropLocation::rootRight});
+    return areas;
+}
 
-    if (rootTop.contains(position))
-        return DropLocation::rootTop;
-    else if (rootBottom.contains(position))
-        return DropLocation::rootBottom;
-    else if (rootLeft.contains(position))
-        return DropLocation::rootLeft;
-    else if (rootRight.contains(position))
-        return DropLocation::rootRight;
-    else
-        return DropLocation::none;
+
+const DropZoneIndex::Zone WindowComponent::getDropZone(DropLocation location, const juce::String& draggingId) const
+{
+    auto uuid = _data.getUuid(_tree);
+    auto [treeToDropAt, index] = _data.getTreeForDockLocation(uuid, location);
+    
+    DropZoneIndex::Zone zone;
+    zone.location = location;
+    zone.treeToDropAt = treeToDropAt;
+    zone.index = index;
+    zone.showsHandle = treeToDropAt != draggingId && uuid != draggingId;
+    if (zone.showsHandle)
+        zone.handleBounds = getDropHandleBounds(treeToDropAt, index, location);
+    return zone;
+}
+
+
+void WindowComponent::addDropZones(DropZoneIndex& index, const juce::String& draggingId) const
+{
+    auto zones = getDropAreas();
+    for (auto& zone : zones)
+    {
+        auto area = zone.area;
+        zone = getDropZone(zone.location, draggingId);
+        zone.area = area;
+    }
+    
+    index.addTarget(_data.getUuid(_tree), zones, getDropZone(DropLocation::none, draggingId));
+    if (_dockingComponent)
+        _dockingComponent->addDropZones(index, draggingId);
 }
 
 
@@ -560,7 +629,7 @@ const DropLocation WindowComponent::getDragLocation(const juce::Point<int>& posi
  -------------------------------------------------------------
  */
 
-DockingWindow::DockingWindow(DockManager& manager, DockManagerData& data, const juce::ValueTree& tree) : juce::DocumentWindow("", juce::Colours::lightgrey, juce::DocumentWindow::allButtons),  _manager(manager), _data(data), _tree(tree), _rootComponent(*this, _manager, _data, _tree)
+DockingWindow::DockingWindow(DockManager& manager, DockManagerData& data, const juce::ValueTree& tree) : juce::DocumentWindow("", juce::Colours::lightgrey, juce::DocumentWindow::allButtons, !DOCKS_HEADLESS),  _manager(manager), _data(data), _tree(tree), _rootComponent(*this, _manager, _data, _tree)
 {
     auto id = _data.getUuid(_tree);
     auto name = _data.getName(_tree);
@@ -619,6 +688,18 @@ void DockingWindow::resized()
 }
 
 
+void DockingWindow::updateBounds()
+{
+    auto position = _data.getPosition(_tree);
+    auto size = _data.getSize(_tree);
+    if (size.isOrigin()) {return;}
+    
+    auto bounds = juce::Rectangle<float>(position.getX(), position.getY(), size.getX(), size.getY()).toNearestInt();
+    if (bounds != getBounds())
+        setBounds(bounds);
+}
+
+
 
 
 /**
@@ -639,6 +720,7 @@ void DockingWindow::minimiseButtonPressed()
     juce::DocumentWindow::minimiseButtonPressed();
     _data.setWindowMinimized(_data.getUuid(_tree), true);
     _data.setWindowMaximized(_data.getUuid(_tree), false);
+    _manager.updateViewVisibility(_tree);
 }
 
 
@@ -647,6 +729,15 @@ void DockingWindow::maximiseButtonPressed()
     juce::DocumentWindow::maximiseButtonPressed();
     _data.setWindowMinimized(_data.getUuid(_tree), false);
     _data.setWindowMaximized(_data.getUuid(_tree), true);
+    _manager.updateViewVisibility(_tree);
+}
+
+
+void DockingWindow::minimisationStateChanged(bool isNowMinimised)
+{
+    /// Also restored from the taskbar or dock, not just the buttons
+    _data.setWindowMinimized(_data.getUuid(_tree), isNowMinimised);
+    _manager.updateViewVisibility(_tree);
 }
 
 
@@ -43,7 +43,7 @@ private:
  -------------------------------------------------------------
  */
 
-class WindowComponent : public juce::Component, public juce::ValueTree::Listener, public juce::DragAndDropTarget
+class WindowComponent : public juce::Component, public juce::ValueTree::Listener, public juce::DragAndDropTarget, private DockManagerData::TransactionListener
 {
 public:
     WindowComponent(DockingWindow& window, DockManager& manager, DockManagerData& data, const juce::ValueTree& tree);
@@ -51,7 +51,13 @@ public:
 
     /// Drop Handle
     void showDropHandleAt(const juce::String& uuid, int index, DropLocation type);
+    void showDropHandle(const juce::Rectangle<int>& bounds, DropLocation type);
+    void showDropZone(const DropZoneIndex::Zone& zone);
     void hideDropHandle();
+    const juce::Rectangle<int> getDropHandleBounds(const juce::String& uuid, int index, DropLocation type) const;
+    
+    /// Drop Zones, for this window and everything in it
+    void addDropZones(DropZoneIndex& index, const juce::String& draggingId) const;
     
     /// Refresh
     void refresh();
@@ -69,6 +75,7 @@ private:
     /// Setup
     void setupMenu();
     void setupFooter(); 
+    void setupLockedButton();
     
     /// Component Overrides
     void resized() override;
@@ -81,6 +88,9 @@ private:
     void valueTreeChildOrderChanged(juce::ValueTree& parentTreeWhoseChildrenHaveMoved, int oldIndex, int newIndex) override;
     void valueTreePropertyChanged(juce::ValueTree& treeWhosePropertyHasChanged, const juce::Identifier& property) override;
     
+    /// Transactions
+    void transactionDidCommit(const juce::ValueTree& affectedTree) override;
+    
     /// Drag and Drop Target
     bool isInterestedInDragSource(const SourceDetails &dragSourceDetails) override;
     void itemDragEnter(const SourceDetails &dragSourceDetails) override;
@@ -90,6 +100,8 @@ private:
     
     /// Get Drag Location
     const DropLocation getDragLocation(const juce::Point<int>& position) const;
+    const juce::Array<DropZoneIndex::Zone> getDropAreas() const;
+    const DropZoneIndex::Zone getDropZone(DropLocation location, const juce::String& draggingId) const;
     
 private:
     
@@ -148,8 +160,11 @@ public:
     DockingWindow(DockManager& manager, DockManagerData& data, const juce::ValueTree& tree);
     ~DockingWindow();
     
+    const juce::ValueTree& getTree() const {return _tree;}
     void layoutDidLoad() {_rootComponent.layoutDidLoad();}
+    void updateBounds();
     void resetAllDisplayNames() {_rootComponent.resetAllDisplayNames();}
+    void addDropZones(DropZoneIndex& index, const juce::String& draggingId) const {_rootComponent.addDropZones(index, draggingId);}
     
     /// Overlay
     void showOverlay(bool show, const juce::String& textToShow);
@@ -158,6 +173,7 @@ private:
     void closeButtonPressed() override;
     void minimiseButtonPressed() override;
     void maximiseButtonPressed() override;
+    void minimisationStateChanged(bool isNowMinimised) override;
     void moved() override;
     void resized() override;
 
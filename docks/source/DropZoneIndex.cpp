@@ -0,0 +1,60 @@
+#include "DropZoneIndex.h"
+
+
+/**
+ ===================================
+ MARK: - Building -
+ ===================================
+ */
+
+void DropZoneIndex::clear()
+{
+    _zones.clearQuick();
+    _targets.clear();
+}
+
+
+void DropZoneIndex::addTarget(const juce::String& targetId, const juce::Array<Zone>& zones, const Zone& fallback)
+{
+    auto start = _zones.size();
+    for (const auto& zone : zones)
+        if (!zone.area.isEmpty())
+            _zones.add(zone);
+
+    _zones.add(fallback);
+    _targets.set(targetId, {start, _zones.size()});
+}
+
+
+const bool DropZoneIndex::isEmpty() const
+{
+    return _zones.isEmpty();
+}
+
+
+const int DropZoneIndex::getNumZones() const
+{
+    return _zones.size();
+}
+
+
+
+
+
+/**
+ ===================================
+ MARK: - Query -
+ ===================================
+ */
+
+const DropZoneIndex::Zone* DropZoneIndex::findZone(const juce::String& targetId, const juce::Point<int>& position) const
+{
+    if (!_targets.contains(targetId)) {return nullptr;}
+    auto range = _targets[targetId];
+
+    for (auto i = range.getStart(); i < range.getEnd() - 1; i++)
+        if (_zones.getReference(i).area.contains(position))
+            return &_zones.getReference(i);
+
+    return &_zones.getReference(range.getEnd() - 1);
+}
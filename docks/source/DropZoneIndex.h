@@ -0,0 +1,56 @@
+#pragma once
+#include <juce_gui_basics/juce_gui_basics.h>
+#include "DockManagerData.h"
+
+
+/**
+ -------------------------------------------------------------
+ ===================================
+ MARK: - Drop Zone Index -
+ ===================================
+ -------------------------------------------------------------
+ */
+
+/**
+ Drop Zone Index
+ Every place a drag can drop, worked out once when the drag starts. Each drop target adds its
+ zones in the order its own hit test checks them, already resolved to the tree, index and handle
+ the drop would use, so a mouse move only has to find the first zone under the mouse
+ */
+class DropZoneIndex
+{
+public:
+
+    struct Zone
+    {
+        Zone() = default;
+        Zone(const juce::Rectangle<int>& a, DropLocation l) : area(a), location(l) {}
+
+        juce::Rectangle<int> area;              /// In the drop target's own space
+        DropLocation location = DropLocation::none;
+        juce::String treeToDropAt;
+        int index = 0;
+        bool showsHandle = false;
+        juce::Rectangle<int> handleBounds;      /// In the window component's space
+    };
+
+    DropZoneIndex() = default;
+
+    /// Building, the fallback is used anywhere none of the target's zones are
+    void clear();
+    void addTarget(const juce::String& targetId, const juce::Array<Zone>& zones, const Zone& fallback);
+    const bool isEmpty() const;
+    const int getNumZones() const;
+
+    /// Returns nullptr for targets which weren't around when the index was built
+    const Zone* findZone(const juce::String& targetId, const juce::Point<int>& position) const;
+
+private:
+
+    /// Zones for all targets in one array, each target's are contiguous and end with its fallback
+    juce::Array<Zone> _zones;
+    juce::HashMap<juce::String, juce::Range<int>> _targets;
+
+    /// Utility
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DropZoneIndex)
+};
@@ -7,8 +7,8 @@
 
 TabComponent::TabComponent(DockManager& manager, DockManagerData& data, const juce::ValueTree& tree) : _manager(manager), _data(data), _tree(tree), _closeButton("Close", juce::Colours::darkgrey.brighter(), juce::Colours::white, juce::Colours::blue)
 {
-    
-    _tree.addListener(this);
+    DockCounters::tabComponents++;
+    _manager._dispatcher.addListener(_tree, this);
     
     /// Close Button
     juce::Path p;
@@ -26,7 +26,7 @@ TabComponent::TabComponent(DockManager& manager, DockManagerData& data, const ju
 
 TabComponent::~TabComponent()
 {
-    _tree.removeListener(this);
+    _manager._dispatcher.removeListener(_tree, this);
 }
 
 
@@ -64,6 +64,16 @@ const juce::String TabComponent::getDisplayName() const
 }
 
 
+void TabComponent::setTree(const juce::ValueTree& tree)
+{
+    if (tree == _tree) {return;}
+    _manager._dispatcher.removeListener(_tree, this);
+    _tree = tree;
+    _manager._dispatcher.addListener(_tree, this);
+    repaint();
+}
+
+
 
 /**
  ===================================
@@ -158,14 +168,35 @@ void TabComponent::valueTreePropertyChanged(juce::ValueTree& treeWhosePropertyHa
  -------------------------------------------------------------
  */
 
+/// The tab strip, which lets the header know when it scrolls
+class TabViewport : public juce::Viewport
+{
+public:
+    std::function<void()> onVisibleAreaChanged = []{};
+private:
+    void visibleAreaChanged(const juce::Rectangle<int>&) override {onVisibleAreaChanged();}
+};
+
+
 HeaderComponent::HeaderComponent(DockManager& manager, DockManagerData& data, const juce::ValueTree& tree) : _manager(manager), _data(data), _tree(tree)
 {
-    _tree.addListener(this);
-    _tabViewport = std::make_unique<juce::Viewport>();
+    _manager._dispatcher.addListener(_tree, this);
+    _manager._dispatcher.addTransactionListener(_tree, this);
+    auto tabViewport = std::make_unique<TabViewport>();
+    tabViewport->onVisibleAreaChanged = [this] {tabStripDidScroll();};
+    _tabViewport = std::move(tabViewport);
     _tabHousing = std::make_unique<juce::Component>();
     _tabViewport->setViewedComponent(_tabHousing.get());
     _tabViewport->setScrollBarsShown(false, false, false, true);
     addChildComponent(_tabViewport.get());
+    
+    /// Overflow
+    _overflowButton = std::make_unique<juce::ShapeButton>("Overflow", juce::Colours::darkgrey.brighter(), juce::Colours::white, juce::Colours::blue);
+    juce::Path p;
+    p.addTriangle(0, 0, 10, 0, 5, 6);
+    _overflowButton->setShape(p, true, true, false);
+    _overflowButton->onClick = [this] {getOverflowMenu().showMenuAsync(juce::PopupMenu::Options().withTargetComponent(_overflowButton.get()));};
+    addChildComponent(_overflowButton.get());
     setupTabs();
     setHasFocusOutline(false);
 }
@@ -174,11 +205,13 @@ HeaderComponent::HeaderComponent(DockManager& manager, DockManagerData& data, co
 HeaderComponent::~HeaderComponent()
 {
     _tabs.clear();
+    _draggedTab = nullptr;
     _tabHousing = nullptr;
     if(_tabViewport)
         _tabViewport->setViewedComponent(nullptr);
     _tabViewport = nullptr;
-    _tree.removeListener(this);
+    _manager._dispatcher.removeListener(_tree, this);
+    _manager._dispatcher.removeTransactionListener(_tree, this);
 }
 
 
@@ -233,20 +266,26 @@ const juce::String HeaderComponent::getDisplayName() const
 }
 
 
+const int HeaderComponent::getNumTabs() const
+{
+    return _tree.getNumChildren();
+}
+
+
 const int HeaderComponent::getTabButtonWidth() const
 {
-    if (_tabs.size() == 0)
+    if (getNumTabs() == 0)
         return _maxTabWidth;
     
     auto parentWidth = getParentWidth();
-    return juce::jmax(juce::jmin(parentWidth / _tabs.size(), _maxTabWidth), _minTabWidth);
+    return juce::jmax(juce::jmin(parentWidth / getNumTabs(), _maxTabWidth), _minTabWidth);
 
 }
 
 
 const int HeaderComponent::getTabIndex(const juce::Point<int>& atPoint) const
 {
-    if (_tabs.isEmpty()) {return 0;}
+    if (getNumTabs() == 0) {return 0;}
     return atPoint.x / getTabButtonWidth();
 }
 
@@ -259,11 +298,38 @@ const int HeaderComponent::getTabX(int atIndex) const
 
 const int HeaderComponent::getNumVisibleTabs() const
 {
-    int i = 0;
+    auto numTabs = getNumTabs();
     for (auto tab : _tabs)
-        if (tab->isVisible())
-            i++;
-    return i;
+        if (!tab->isVisible())
+            numTabs--;
+    return numTabs;
+}
+
+
+const bool HeaderComponent::isVirtual() const
+{
+    return _manager._virtualTabStrip;
+}
+
+
+const juce::Range<int> HeaderComponent::getTabRange() const
+{
+    if (!isVirtual()) {return {0, getNumTabs()};}
+    if (!_tabViewport || _tabViewport->getWidth() == 0) {return {};}
+    
+    /// What can be seen, and a few either side so short scrolls don't need new tabs. The length
+    /// stays the same at either end, so scrolling never needs more tabs than the strip started with
+    auto width = getTabButtonWidth();
+    auto viewArea = _tabViewport->getViewArea();
+    auto length = viewArea.getWidth() / width + 2 + _virtualTabMargin * 2;
+    auto first = juce::jlimit(0, juce::jmax(0, getNumTabs() - length), viewArea.getX() / width - _virtualTabMargin);
+    return {first, juce::jmin(getNumTabs(), first + length)};
+}
+
+
+const bool HeaderComponent::hasOverflow() const
+{
+    return isVirtual() && getTabX(getNumTabs()) > getWidth() - 4;
 }
 
 
@@ -330,16 +396,35 @@ void HeaderComponent::paint(juce::Graphics &g)
 
 void HeaderComponent::resized()
 {
-    if (_tabs.size() == 0) {return;}
+    if (!shouldShowTabs() || getNumTabs() == 0) {return;}
     auto width = getTabButtonWidth();
+    auto stripBounds = getLocalBounds().reduced(2, 1);
+    
+    if (_overflowButton)
+    {
+        _overflowButton->setVisible(hasOverflow());
+        if (_overflowButton->isVisible())
+            _overflowButton->setBounds(stripBounds.removeFromRight(getHeight()).reduced(5));
+    }
 
     if (_tabViewport)
-        _tabViewport->setBounds(getLocalBounds().reduced(2, 1));
+        _tabViewport->setBounds(stripBounds);
     
     if (_tabHousing)
-        _tabHousing->setSize(width * _tabs.size() + 10, getHeight());
+        _tabHousing->setSize(width * getNumTabs() + 10, getHeight());
+
+    if (isVirtual())
+        syncTabs();
+    
+    layoutTabs();
+    updateTabStripVisibility();
+}
+
 
-    juce::Rectangle<int> bounds = {0, 0, width * _tabs.size(), getHeight()};
+void HeaderComponent::layoutTabs()
+{
+    auto width = getTabButtonWidth();
+    juce::Rectangle<int> bounds = {getTabX(_firstTab), 0, width * _tabs.size(), getHeight()};
     for (auto tab : _tabs)
     {
         if (!tab->isVisible()) {continue;}
@@ -349,14 +434,80 @@ void HeaderComponent::resized()
 }
 
 
+void HeaderComponent::tabStripDidScroll()
+{
+    if (isVirtual())
+    {
+        syncTabs();
+        layoutTabs();
+    }
+    
+    updateTabStripVisibility();
+}
+
+
+void HeaderComponent::updateTabStripVisibility()
+{
+    if (getNumTabs() == 0 || !_tabViewport || _tabViewport->getWidth() == 0) {return;}
+    
+    /// Tabs are all the same width, so those in the strip are one run of them
+    auto width = getTabButtonWidth();
+    auto viewArea = _tabViewport->getViewArea();
+    auto tabsInStrip = juce::Range<int>(viewArea.getX() / width, (viewArea.getRight() + width - 1) / width).getIntersectionWith({0, getNumTabs()});
+    
+    /// From the tree rather than the tabs, which may not all exist. Only tabs which crossed the edge of the strip are passed on
+    auto setInTabStrip = [this](int index, bool isInTabStrip)
+    {
+        auto child = _tree.getChild(index);
+        auto uuid = _data.getUuid(child);
+        auto wasInTabStrip = _tabsOutOfStrip.count(uuid) == 0;
+        if (isInTabStrip == wasInTabStrip) {return;}
+        
+        if (isInTabStrip)
+            _tabsOutOfStrip.erase(uuid);
+        else
+            _tabsOutOfStrip.insert(uuid);
+        _manager.tabStripVisibilityChanged(child, isInTabStrip);
+    };
+    
+    if (_tabsHaveChanged)
+    {
+        /// Any tab may have moved, and those which went aren't kept
+        auto tabsOutOfStrip = std::move(_tabsOutOfStrip);
+        _tabsOutOfStrip.clear();
+        for (auto i = 0; i < getNumTabs(); i++)
+        {
+            auto uuid = _data.getUuid(_tree.getChild(i));
+            if (tabsOutOfStrip.count(uuid) > 0)
+                _tabsOutOfStrip.insert(uuid);
+            setInTabStrip(i, tabsInStrip.contains(i));
+        }
+    }
+    else
+    {
+        /// Only the tabs which were in the strip, or are now
+        for (auto i = _tabsInStrip.getStart(); i < _tabsInStrip.getEnd(); i++)
+            if (!tabsInStrip.contains(i))
+                setInTabStrip(i, false);
+        
+        for (auto i = tabsInStrip.getStart(); i < tabsInStrip.getEnd(); i++)
+            if (!_tabsInStrip.contains(i))
+                setInTabStrip(i, true);
+    }
+    
+    _tabsInStrip = tabsInStrip;
+    _tabsHaveChanged = false;
+}
+
+
 void HeaderComponent::animatedResize()
 {
     if (_tabs.size() == 0) {return;}
     
     auto width = getTabButtonWidth();
-    juce::Rectangle<int> bounds = {0, 0, width * _tabs.size(), getHeight()};
+    juce::Rectangle<int> bounds = {getTabX(_firstTab), 0, width * _tabs.size(), getHeight()};
     auto& animator = juce::Desktop::getInstance().getAnimator();
-    int index = 0;
+    int index = _firstTab;
     for (auto i = 0; i < _tabs.size(); i++)
     {
         auto tab = _tabs[i];
@@ -380,23 +531,101 @@ void HeaderComponent::animatedResize()
 
 void HeaderComponent::setupTabs()
 {
+    _tabsHaveChanged = true;
     bool showTabs = shouldShowTabs();
     if (_tabViewport)
         _tabViewport->setVisible(showTabs);
     
     if (!showTabs) {repaint(); return;}
 
-    _tabs.clear();
-    auto selected = _data.getSelectedId(_tree);
+    syncTabs();
+    resized();
+}
+
+
+void HeaderComponent::syncTabs()
+{
+    /// Tabs follow the tree's children in range, those already showing one of them keep it
+    auto range = getTabRange();
+    juce::OwnedArray<TabComponent> tabs;
+    for (auto index = range.getStart(); index < range.getEnd(); index++)
+    {
+        auto child = _tree.getChild(index);
+        auto existing = 0;
+        while (existing < _tabs.size() && _tabs[existing]->getTree() != child)
+            existing++;
+        
+        if (existing == _tabs.size() && _draggedTab && _draggedTab->getTree() == child)
+            tabs.add(_draggedTab.release());
+        else
+            tabs.add(existing < _tabs.size() ? _tabs.removeAndReturn(existing) : nullptr);
+    }
+    
+    /// The dragged tab is never reused for another tree, or deleted, while the drag is still going
+    auto dragSourceIndex = _tabs.indexOf(_dragSource);
+    if (dragSourceIndex >= 0)
+        _draggedTab.reset(_tabs.removeAndReturn(dragSourceIndex));
     
+    /// Tabs left over are reused for the rest, and only then are new ones built
+    for (auto i = 0; i < tabs.size(); i++)
+    {
+        if (tabs[i] != nullptr) {continue;}
+        auto child = _tree.getChild(range.getStart() + i);
+        if (!_tabs.isEmpty())
+        {
+            auto tab = tabs.set(i, _tabs.removeAndReturn(_tabs.size() - 1));
+            tab->setTree(child);
+        }
+        else
+        {
+            auto tab = tabs.set(i, new TabComponent(_manager, _data, child));
+            tab->addMouseListener(this, true);
+            _tabHousing->addAndMakeVisible(tab);
+        }
+    }
+    
+    /// Whatever wasn't needed goes
+    _tabs.swapWith(tabs);
+    _firstTab = range.getStart();
+}
+
+
+void HeaderComponent::scrollToTab(int index)
+{
+    if (!_tabViewport || !juce::isPositiveAndBelow(index, getNumTabs())) {return;}
+    auto viewArea = _tabViewport->getViewArea();
+    auto x = getTabX(index);
+    auto right = getTabX(index + 1);
+    
+    if (x < viewArea.getX())
+        _tabViewport->setViewPosition(x, 0);
+    else if (right > viewArea.getRight())
+        _tabViewport->setViewPosition(right - viewArea.getWidth(), 0);
+}
+
+
+juce::PopupMenu HeaderComponent::getOverflowMenu()
+{
+    /// Built from the tree, most tabs in a virtual strip don't have a component
+    juce::PopupMenu menu;
+    auto selected = _data.getSelectedId(_tree);
     for (auto child : _tree)
     {
-        auto tab = _tabs.add(new TabComponent(_manager, _data, child));
-        tab->addMouseListener(this, true);
-        _tabHousing->addAndMakeVisible(tab);
+        auto uuid = _data.getUuid(child);
+        auto name = _manager._delegate.getDisplayNameForView(_data.getName(child));
+        menu.addItem(name, true, uuid == selected, [this, uuid] {selectTabFromOverflow(uuid);});
     }
     
-    resized();
+    return menu;
+}
+
+
+void HeaderComponent::selectTabFromOverflow(const juce::String& uuid)
+{
+    auto child = _tree.getChildWithProperty(dockNode::getId<dockSchema::uuid>(), uuid);
+    if (!child.isValid()) {return;}
+    _data.setSelected(_tree, uuid);
+    scrollToTab(_tree.indexOf(child));
 }
 
 
@@ -411,33 +640,37 @@ void HeaderComponent::setupTabs()
 
 void HeaderComponent::valueTreeChildAdded(juce::ValueTree& parentTree, juce::ValueTree& childWhichHasBeenAdded)
 {
-    if (parentTree != _tree) {return;}
+    if (parentTree != _tree || _data.isInTransaction()) {return;}
     if (PRINT_TREE_LISTENERS) DBG("Value Tree Child Added: Header " << _data.getUuid(childWhichHasBeenAdded));
+    DockCounters::treeCallbacks++;
     setupTabs();
 }
 
 
 void HeaderComponent::valueTreeChildRemoved(juce::ValueTree& parentTree, juce::ValueTree& childWhichHasBeenRemoved, int indexFromWhichChildWasRemoved)
 {
-    if (parentTree != _tree) {return;}
+    if (parentTree != _tree || _data.isInTransaction()) {return;}
     if (PRINT_TREE_LISTENERS) DBG("Value Tree Child Removed: Header " << _data.getUuid(childWhichHasBeenRemoved));
+    DockCounters::treeCallbacks++;
     setupTabs();
 }
 
 
 void HeaderComponent::valueTreeParentChanged(juce::ValueTree& treeWhoseParentHasChanged)
 {
-    if (treeWhoseParentHasChanged != _tree) {return;}
+    if (treeWhoseParentHasChanged != _tree || _data.isInTransaction()) {return;}
     if (PRINT_TREE_LISTENERS) DBG("Value Tree Child Parent Changed: Header " << _data.getUuid(treeWhoseParentHasChanged));
-    
+    DockCounters::treeCallbacks++;
     setupTabs();
 }
 
 
 void HeaderComponent::valueTreeChildOrderChanged(juce::ValueTree& parentTreeWhoseChildrenHaveMoved, int oldIndex, int newIndex)
 {
-    if (parentTreeWhoseChildrenHaveMoved != _tree) {return;}
+    if (parentTreeWhoseChildrenHaveMoved != _tree || _data.isInTransaction()) {return;}
     if (PRINT_TREE_LISTENERS) DBG("Value Tree Order Changed: Header " << _data.getUuid(parentTreeWhoseChildrenHaveMoved));
+    DockCounters::treeCallbacks++;
+    setupTabs();
 }
 
 
@@ -445,7 +678,7 @@ void HeaderComponent::valueTreePropertyChanged(juce::ValueTree& treeWhosePropert
 {
     if (treeWhosePropertyHasChanged != _tree) {return;}
     if (PRINT_TREE_LISTENERS) DBG("Value Tree Property Changed: Header " << _data.getUuid(treeWhosePropertyHasChanged) << " " << property.toString());
-    if (property.toString() == dockProps::selectedProperty)
+    if (dockNode::is<dockSchema::selected>(property))
         repaint();
 }
 
@@ -453,6 +686,23 @@ void HeaderComponent::valueTreePropertyChanged(juce::ValueTree& treeWhosePropert
 
 
 
+/**
+ ===================================
+ MARK: - Transactions -
+ ===================================
+ */
+
+void HeaderComponent::transactionDidCommit(const juce::ValueTree& affectedTree)
+{
+    if (affectedTree != _tree) {return;}
+    DockCounters::treeCallbacks++;
+    setupTabs();
+}
+
+
+
+
+
 /**
  ===================================
  MARK: - Mouse -
@@ -596,12 +846,16 @@ void HeaderComponent::dragOperationStarted(const juce::DragAndDropTarget::Source
 {
     if (details.sourceComponent == nullptr) {return;}
     if (auto comp = dynamic_cast<TabComponent*>(details.sourceComponent.get()))
+    {
         comp->setVisible(false);
+        _dragSource = comp;
+    }
     else if (auto comp = dynamic_cast<HeaderComponent*>(details.sourceComponent.get()))
         comp->setVisible(false);
     
     /// Tell Manager to create view when this completes
     _manager.setCreateNewView(true);
+    _manager.buildDropZones(details.description[0].toString());
     
     /// Animate the views
     animatedResize();
@@ -613,6 +867,11 @@ void HeaderComponent::dragOperationEnded(const juce::DragAndDropTarget::SourceDe
     _draggingIndex = -1;
     _isDragging = false;
     _draggingLocation = {};
+    _manager.clearDropZones();
+    
+    /// Scrolled out of the strip, the dragged tab isn't needed anymore
+    _dragSource = nullptr;
+    _draggedTab = nullptr;
     
     if (auto comp = details.sourceComponent)
         comp->setVisible(true);
@@ -2,6 +2,8 @@
 
 /// includes
 #include <juce_gui_basics/juce_gui_basics.h>
+#include "DockManagerData.h"
+#include <unordered_set>
 
 
 /// Forward Definitions
@@ -31,6 +33,9 @@ public:
     const juce::String getDisplayName() const;
     const bool getSelected() const;
     const juce::ValueTree getTree() const; 
+    
+    /// Setters, a tab can be reused for another tree
+    void setTree(const juce::ValueTree& tree);
 private:
     
     /// Component Overrides
@@ -75,8 +80,9 @@ private:
  -------------------------------------------------------------
  */
 
-class HeaderComponent : public juce::Component, private juce::ValueTree::Listener, public juce::DragAndDropTarget, public juce::DragAndDropContainer
+class HeaderComponent : public juce::Component, private juce::ValueTree::Listener, public juce::DragAndDropTarget, public juce::DragAndDropContainer, private DockManagerData::TransactionListener
 {
+    friend class test_DockManager;
 public:
     HeaderComponent(DockManager& manager, DockManagerData& data, const juce::ValueTree& tree);
     ~HeaderComponent();
@@ -87,9 +93,18 @@ private:
     void paint(juce::Graphics &g) override;
     void resized() override;
     void animatedResize();
+    void layoutTabs();
+    void tabStripDidScroll();
+    void updateTabStripVisibility();
     
     /// Setup
     void setupTabs();
+    void syncTabs();
+    
+    /// Virtual Tab Strip
+    void scrollToTab(int index);
+    juce::PopupMenu getOverflowMenu();
+    void selectTabFromOverflow(const juce::String& uuid);
         
     /**
      ===================================
@@ -105,10 +120,14 @@ private:
     const juce::String getViewName() const;
     const juce::String getDisplayName() const;
     
+    const int getNumTabs() const;
     const int getTabButtonWidth() const;
     const int getTabIndex(const juce::Point<int>& atPoint) const;
     const int getTabX(int atIndex) const;
     const int getNumVisibleTabs() const;
+    const bool isVirtual() const;
+    const juce::Range<int> getTabRange() const;
+    const bool hasOverflow() const;
 
     /// Value Tree Listener
     void valueTreeChildAdded(juce::ValueTree& parentTree, juce::ValueTree& childWhichHasBeenAdded) override;
@@ -117,6 +136,9 @@ private:
     void valueTreeChildOrderChanged(juce::ValueTree& parentTreeWhoseChildrenHaveMoved, int oldIndex, int newIndex) override;
     void valueTreePropertyChanged(juce::ValueTree& treeWhosePropertyHasChanged, const juce::Identifier& property) override;
     
+    /// Transactions
+    void transactionDidCommit(const juce::ValueTree& affectedTree) override;
+    
     /// Mouse
     void mouseDown(const juce::MouseEvent& event) override;
     void mouseDrag(const juce::MouseEvent& event) override;
@@ -148,15 +170,29 @@ private:
     juce::OwnedArray<TabComponent> _tabs;
     std::unique_ptr<juce::Component> _tabHousing = nullptr;
     std::unique_ptr<juce::Viewport> _tabViewport = nullptr;
+
+    /// Tab Strip Visibility, the run of tabs last in the strip, and the tabs the delegate was told are out of it
+    juce::Range<int> _tabsInStrip;
+    std::unordered_set<juce::String> _tabsOutOfStrip;
+    bool _tabsHaveChanged = true;
+    
+    /// Virtual Tab Strip, _tabs only covers the children from _firstTab on
+    int _firstTab = 0;
+    std::unique_ptr<juce::ShapeButton> _overflowButton;
     
     /// Drag and Drop
     bool _isDragging = false;
     juce::Point<int> _draggingLocation;
     int _draggingIndex = -1;
+    
+    /// The tab dragged out of this header keeps its tree until the drop, held here while it's scrolled out of the strip
+    TabComponent* _dragSource = nullptr;
+    std::unique_ptr<TabComponent> _draggedTab;
 
     /// Sizes
     const int _minTabWidth = 75;
     const int _maxTabWidth = 120;
+    const int _virtualTabMargin = 2;
     
     /// Utility
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(HeaderComponent)
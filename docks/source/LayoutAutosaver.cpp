@@ -0,0 +1,213 @@
+#include "LayoutAutosaver.h"
+
+
+LayoutAutosaver::LayoutAutosaver(const juce::ValueTree& layout, const juce::File& file, LayoutFormat format)
+    : juce::Thread("Layout Autosave"), _layout(layout), _file(file), _format(format)
+{
+    startThread();
+}
+
+
+LayoutAutosaver::~LayoutAutosaver()
+{
+    /// Nothing is lost by closing straight after a change
+    flush();
+    stopThread(-1);
+}
+
+
+
+
+
+/**
+ ===================================
+ MARK: - Timing -
+ ===================================
+ */
+
+void LayoutAutosaver::setTiming(int debounceMs, int maxLatencyMs)
+{
+    /// A max latency below the debounce just saves sooner
+    _debounceMs = juce::jmax(0, debounceMs);
+    _maxLatencyMs = juce::jmax(0, maxLatencyMs);
+}
+
+
+const int LayoutAutosaver::getDebounce() const
+{
+    return _debounceMs;
+}
+
+
+const int LayoutAutosaver::getMaxLatency() const
+{
+    return _maxLatencyMs;
+}
+
+
+void LayoutAutosaver::setClock(std::function<juce::uint32()> clock)
+{
+    _clock = std::move(clock);
+}
+
+
+void LayoutAutosaver::setLayoutHash(std::function<juce::uint64()> layoutHash)
+{
+    _layoutHash = std::move(layoutHash);
+    _hasQueuedHash = false;
+}
+
+
+void LayoutAutosaver::layoutDidChange()
+{
+    auto now = _clock();
+    if (!_isPending)
+    {
+        _isPending = true;
+        _firstChangeTime = now;
+    }
+
+    /// Every change pushes the save back, but never past the max latency from the first one
+    auto delay = juce::jmax(0, juce::jmin(_debounceMs, _maxLatencyMs - (int) (now - _firstChangeTime)));
+    _saveTime = now + (juce::uint32) delay;
+    startTimer(juce::jmax(1, delay));
+}
+
+
+const bool LayoutAutosaver::hasPendingChanges() const
+{
+    return _isPending;
+}
+
+
+const int LayoutAutosaver::getMillisecondsUntilSave() const
+{
+    if (!_isPending) {return -1;}
+    return juce::jmax(0, (int) (_saveTime - _clock()));
+}
+
+
+void LayoutAutosaver::timerCallback()
+{
+    stopTimer();
+    queueSnapshot();
+}
+
+
+
+
+
+/**
+ ===================================
+ MARK: - Saving -
+ ===================================
+ */
+
+bool LayoutAutosaver::flush(int timeoutMs)
+{
+    stopTimer();
+    if (_isPending)
+        queueSnapshot();
+
+    /// Written here rather than waiting for the thread, unless it has already taken the snapshot
+    writeQueuedSnapshot();
+
+    int sequence;
+    {
+        const juce::ScopedLock lock(_queueLock);
+        sequence = _queuedSequence;
+    }
+
+    auto start = juce::Time::getMillisecondCounter();
+    while (_writtenSequence < sequence)
+    {
+        auto waited = (int) (juce::Time::getMillisecondCounter() - start);
+        if (timeoutMs >= 0 && waited >= timeoutMs) {return false;}
+        _didWrite.wait(timeoutMs < 0 ? 100 : juce::jmin(100, timeoutMs - waited));
+    }
+
+    return _lastSaveSucceeded;
+}
+
+
+const int LayoutAutosaver::getNumSaves() const
+{
+    return _numSaves;
+}
+
+
+const bool LayoutAutosaver::lastSaveSucceeded() const
+{
+    return _lastSaveSucceeded;
+}
+
+
+const juce::File& LayoutAutosaver::getFile() const
+{
+    return _file;
+}
+
+
+void LayoutAutosaver::queueSnapshot()
+{
+    /// Copying is all the message thread does, from here the copy belongs to the background thread
+    _isPending = false;
+    if (_layoutHash != nullptr)
+    {
+        /// Changed back to what was last saved, so long as that did get saved
+        auto hash = _layoutHash();
+        if (_hasQueuedHash && hash == _queuedHash && _lastSaveSucceeded) {return;}
+        _queuedHash = hash;
+        _hasQueuedHash = true;
+    }
+    
+    auto snapshot = _layout.createCopy();
+    {
+        const juce::ScopedLock lock(_queueLock);
+        _queuedSnapshot = std::move(snapshot);
+        _queuedSequence++;
+    }
+
+    notify();
+}
+
+
+void LayoutAutosaver::writeQueuedSnapshot()
+{
+    juce::ValueTree snapshot;
+    int sequence;
+    {
+        const juce::ScopedLock lock(_queueLock);
+        std::swap(snapshot, _queuedSnapshot);
+        sequence = _queuedSequence;
+    }
+
+    if (!snapshot.isValid()) {return;}
+
+    /// Written next to the file and swapped in, so the file is always a whole layout
+    const juce::ScopedLock lock(_writeLock);
+    if (sequence <= _writtenSequence) {return;}
+    _lastSaveSucceeded = DockManagerData::writeLayout(snapshot, _file, _format);
+    _numSaves++;
+    _writtenSequence = sequence;
+    _didWrite.signal();
+}
+
+
+
+
+
+/**
+ ===================================
+ MARK: - Thread -
+ ===================================
+ */
+
+void LayoutAutosaver::run()
+{
+    while (!threadShouldExit())
+    {
+        wait(-1);
+        writeQueuedSnapshot();
+    }
+}
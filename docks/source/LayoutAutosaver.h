@@ -0,0 +1,99 @@
+#pragma once
+#include <juce_gui_basics/juce_gui_basics.h>
+#include "DockManagerData.h"
+
+
+/**
+ -------------------------------------------------------------
+ ===================================
+ MARK: - Layout Autosaver -
+ ===================================
+ -------------------------------------------------------------
+ */
+
+/**
+ Layout Autosaver
+ Saves a layout to a file once it stops changing for the debounce time. A layout which never stops
+ changing, ie while a window is dragged, is still saved once the max latency has passed since its first
+ unsaved change. The message thread only copies the tree; writing it, and swapping the finished file in
+ for the old one, happens on a background thread. If saves overlap, only the newest is written
+ */
+class LayoutAutosaver : private juce::Timer, private juce::Thread
+{
+    friend class test_DockManagerData;
+    
+public:
+
+    LayoutAutosaver(const juce::ValueTree& layout, const juce::File& file, LayoutFormat format = LayoutFormat::xml);
+    ~LayoutAutosaver() override;
+
+    /// Timing, in milliseconds
+    void setTiming(int debounceMs, int maxLatencyMs);
+    const int getDebounce() const;
+    const int getMaxLatency() const;
+
+    /// Clock, in milliseconds, the timing is measured against. Defaults to Time::getMillisecondCounter()
+    void setClock(std::function<juce::uint32()> clock);
+
+    /// Layout Hash, a save is skipped if the layout's hash is the same as for the last one
+    void setLayoutHash(std::function<juce::uint64()> layoutHash);
+
+    /// Call for every change, the save is pushed back to the debounce time but never past the max latency
+    void layoutDidChange();
+    const bool hasPendingChanges() const;
+    const int getMillisecondsUntilSave() const;
+
+    /// Snapshots any pending change now, and waits for everything queued to be written
+    bool flush(int timeoutMs = -1);
+
+    /// Saves
+    const int getNumSaves() const;
+    const bool lastSaveSucceeded() const;
+    const juce::File& getFile() const;
+
+private:
+
+    /// Timer
+    void timerCallback() override;
+
+    /// Thread
+    void run() override;
+
+    /// Saving
+    void queueSnapshot();
+    void writeQueuedSnapshot();
+
+private:
+
+    juce::ValueTree _layout;
+    const juce::File _file;
+    const LayoutFormat _format;
+
+    /// Timing
+    int _debounceMs = 3000;
+    int _maxLatencyMs = 10000;
+    bool _isPending = false;
+    juce::uint32 _firstChangeTime = 0;
+    juce::uint32 _saveTime = 0;
+    std::function<juce::uint32()> _clock = [] {return juce::Time::getMillisecondCounter();};
+
+    /// Layout Hash
+    std::function<juce::uint64()> _layoutHash;
+    juce::uint64 _queuedHash = 0;
+    bool _hasQueuedHash = false;
+
+    /// Queued snapshot, handed to the background thread
+    juce::CriticalSection _queueLock;
+    juce::ValueTree _queuedSnapshot;
+    int _queuedSequence = 0;
+
+    /// Writing, a snapshot older than the one last written is dropped
+    juce::CriticalSection _writeLock;
+    std::atomic<int> _writtenSequence {0};
+    std::atomic<int> _numSaves {0};
+    std::atomic<bool> _lastSaveSucceeded {true};
+    juce::WaitableEvent _didWrite;
+
+    /// Utility
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LayoutAutosaver)
+};
@@ -0,0 +1,324 @@
+#include "LayoutJournal.h"
+#include "BinaryLayout.h"
+
+
+namespace
+{
+    const char journalMagic[] = {'D', 'K', 'J', 'L'};
+    constexpr size_t journalHeaderSize = sizeof(journalMagic) + sizeof(juce::uint32);
+    constexpr size_t recordHeaderSize = 2 * sizeof(juce::uint32);
+
+    /// Kept on the snapshot's root, so a journal is only replayed over the snapshot it follows
+    const juce::Identifier journalGenerationProperty = "journalGeneration";
+
+    /// Record Types
+    const juce::Identifier setRecord = "set";
+    const juce::Identifier unsetRecord = "unset";
+    const juce::Identifier addRecord = "add";
+    const juce::Identifier removeRecord = "remove";
+    const juce::Identifier moveRecord = "move";
+
+    /// Record Properties
+    const juce::Identifier pathProperty = "path";
+    const juce::Identifier propertyProperty = "property";
+    const juce::Identifier indexProperty = "index";
+    const juce::Identifier toProperty = "to";
+    const juce::Identifier valueRecord = "value";
+}
+
+
+LayoutJournal::LayoutJournal(DockManagerData& data, const juce::File& file, int maxJournalBytes, LayoutFormat format)
+    : _data(data), _file(file), _journalFile(getJournalFile(file)), _maxJournalBytes(maxJournalBytes), _format(format)
+{
+    /// Carries on from the snapshot which is there, if any
+    juce::FileInputStream stream(_file);
+    if (stream.openedOk())
+        _generation = (int) DockManagerData::readLayout(stream).getProperty(journalGenerationProperty, 0);
+
+    compact();
+    _data.setChangeRecorder(this);
+}
+
+
+LayoutJournal::~LayoutJournal()
+{
+    _data.setChangeRecorder(nullptr);
+}
+
+
+
+
+
+/**
+ ===================================
+ MARK: - Recovery -
+ ===================================
+ */
+
+juce::ValueTree LayoutJournal::recover(const juce::File& file)
+{
+    juce::FileInputStream snapshotStream(file);
+    if (!snapshotStream.openedOk()) {return {};}
+
+    auto layout = DockManagerData::readLayout(snapshotStream);
+    if (!layout.isValid()) {return {};}
+
+    auto generation = (int) layout.getProperty(journalGenerationProperty, 0);
+    layout.removeProperty(journalGenerationProperty, nullptr);
+
+    juce::MemoryBlock journal;
+    if (!getJournalFile(file).loadFileAsData(journal) || journal.getSize() < journalHeaderSize) {return layout;}
+
+    /// A journal left over from before the last compaction is already in the snapshot
+    auto data = static_cast<const char*>(journal.getData());
+    if (std::memcmp(data, journalMagic, sizeof(journalMagic)) != 0) {return layout;}
+    if ((int) juce::ByteOrder::littleEndianInt(data + sizeof(journalMagic)) != generation) {return layout;}
+
+    /// Up to the first record which isn't whole, a crash can only have cut the last one short
+    auto position = journalHeaderSize;
+    while (journal.getSize() - position >= recordHeaderSize)
+    {
+        auto size = (size_t) juce::ByteOrder::littleEndianInt(data + position);
+        auto checksum = juce::ByteOrder::littleEndianInt(data + position + sizeof(juce::uint32));
+        auto record = data + position + recordHeaderSize;
+        if (size > journal.getSize() - position - recordHeaderSize || getChecksum(record, size) != checksum) {break;}
+        if (!replayRecord(layout, BinaryLayout::read(record, size))) {break;}
+        position += recordHeaderSize + size;
+    }
+
+    return layout;
+}
+
+
+juce::File LayoutJournal::getJournalFile(const juce::File& file)
+{
+    return file.getSiblingFile(file.getFileName() + ".journal");
+}
+
+
+const bool LayoutJournal::replayRecord(juce::ValueTree& root, const juce::ValueTree& record)
+{
+    auto tree = findPath(root, record.getProperty(pathProperty));
+    if (!tree.isValid()) {return false;}
+
+    const auto& type = record.getType();
+    if (type == setRecord)
+    {
+        auto value = record.getChildWithName(valueRecord);
+        if (value.getNumProperties() != 1) {return false;}
+        auto name = value.getPropertyName(0);
+        tree.setProperty(name, value.getProperty(name), nullptr);
+    }
+
+    else if (type == unsetRecord)
+    {
+        tree.removeProperty(record.getProperty(propertyProperty).toString(), nullptr);
+    }
+
+    else if (type == addRecord)
+    {
+        int index = record.getProperty(indexProperty);
+        if (record.getNumChildren() != 1 || !juce::isPositiveAndNotGreaterThan(index, tree.getNumChildren())) {return false;}
+        tree.addChild(record.getChild(0).createCopy(), index, nullptr);
+    }
+
+    else if (type == removeRecord)
+    {
+        int index = record.getProperty(indexProperty);
+        if (!juce::isPositiveAndBelow(index, tree.getNumChildren())) {return false;}
+        tree.removeChild(index, nullptr);
+    }
+
+    else if (type == moveRecord)
+    {
+        int index = record.getProperty(indexProperty);
+        int newIndex = record.getProperty(toProperty);
+        if (!juce::isPositiveAndBelow(index, tree.getNumChildren()) || !juce::isPositiveAndBelow(newIndex, tree.getNumChildren())) {return false;}
+        tree.moveChild(index, newIndex, nullptr);
+    }
+
+    else
+    {
+        return false;
+    }
+
+    return true;
+}
+
+
+
+
+
+/**
+ ===================================
+ MARK: - Compaction -
+ ===================================
+ */
+
+bool LayoutJournal::compact()
+{
+    /// The snapshot goes first, until the new journal starts the old one is simply ignored
+    auto snapshot = _data.getTree().createCopy();
+    snapshot.setProperty(journalGenerationProperty, _generation + 1, nullptr);
+    if (!DockManagerData::writeLayout(snapshot, _file, _format))
+    {
+        _stream.reset();
+        return false;
+    }
+
+    _generation++;
+    return startJournal();
+}
+
+
+const bool LayoutJournal::isOpen() const
+{
+    return _stream != nullptr;
+}
+
+
+const juce::int64 LayoutJournal::getJournalSize() const
+{
+    return _stream != nullptr ? _stream->getPosition() : 0;
+}
+
+
+const int LayoutJournal::getGeneration() const
+{
+    return _generation;
+}
+
+
+bool LayoutJournal::startJournal()
+{
+    _stream.reset();
+    _journalFile.deleteFile();
+
+    _stream = std::make_unique<juce::FileOutputStream>(_journalFile);
+    if (!_stream->openedOk())
+    {
+        _stream.reset();
+        return false;
+    }
+
+    _stream->write(journalMagic, sizeof(journalMagic));
+    _stream->writeInt(_generation);
+    _stream->flush();
+    return true;
+}
+
+
+
+
+
+/**
+ ===================================
+ MARK: - Records -
+ ===================================
+ */
+
+void LayoutJournal::appendRecord(const juce::ValueTree& record)
+{
+    if (_stream == nullptr) {return;}
+
+    _recordBuffer.reset();
+    BinaryLayout::write(record, _recordBuffer);
+
+    /// Written and flushed whole, so a crash can only cut the last record short
+    _stream->writeInt((int) _recordBuffer.getDataSize());
+    _stream->writeInt((int) getChecksum(_recordBuffer.getData(), _recordBuffer.getDataSize()));
+    _stream->write(_recordBuffer.getData(), _recordBuffer.getDataSize());
+    _stream->flush();
+
+    if (_stream->getPosition() > _maxJournalBytes)
+        compact();
+}
+
+
+const juce::String LayoutJournal::getPath(const juce::ValueTree& tree)
+{
+    juce::Array<int> indexes;
+    for (auto child = tree; child.getParent().isValid(); child = child.getParent())
+        indexes.add(child.getParent().indexOf(child));
+
+    juce::String path;
+    for (auto i = indexes.size(); --i >= 0;)
+        path << indexes[i] << (i > 0 ? "." : "");
+    return path;
+}
+
+
+juce::ValueTree LayoutJournal::findPath(const juce::ValueTree& root, const juce::String& path)
+{
+    auto tree = root;
+    if (path.isEmpty()) {return tree;}
+
+    for (const auto& index : juce::StringArray::fromTokens(path, ".", ""))
+    {
+        if (!index.containsOnly("0123456789")) {return {};}
+        tree = tree.getChild(index.getIntValue());
+    }
+
+    return tree;
+}
+
+
+const juce::uint32 LayoutJournal::getChecksum(const void* data, size_t size)
+{
+    /// FNV-1a, enough to tell a record which was cut short
+    juce::uint32 hash = 2166136261u;
+    auto bytes = static_cast<const juce::uint8*>(data);
+    for (size_t i = 0; i < size; i++)
+        hash = (hash ^ bytes[i]) * 16777619u;
+    return hash;
+}
+
+
+
+
+
+/**
+ ===================================
+ MARK: - Value Tree Listener -
+ ===================================
+ */
+
+void LayoutJournal::valueTreePropertyChanged(juce::ValueTree& treeWhosePropertyHasChanged, const juce::Identifier& property)
+{
+    if (!treeWhosePropertyHasChanged.hasProperty(property))
+    {
+        appendRecord(juce::ValueTree(unsetRecord, {{pathProperty, getPath(treeWhosePropertyHasChanged)},
+                                                   {propertyProperty, property.toString()}}));
+        return;
+    }
+
+    juce::ValueTree value(valueRecord);
+    value.setProperty(property, treeWhosePropertyHasChanged.getProperty(property), nullptr);
+    juce::ValueTree record(setRecord, {{pathProperty, getPath(treeWhosePropertyHasChanged)}});
+    record.appendChild(value, nullptr);
+    appendRecord(record);
+}
+
+
+void LayoutJournal::valueTreeChildAdded(juce::ValueTree& parentTree, juce::ValueTree& childWhichHasBeenAdded)
+{
+    juce::ValueTree record(addRecord, {{pathProperty, getPath(parentTree)},
+                                       {indexProperty, parentTree.indexOf(childWhichHasBeenAdded)}});
+    record.appendChild(childWhichHasBeenAdded.createCopy(), nullptr);
+    appendRecord(record);
+}
+
+
+void LayoutJournal::valueTreeChildRemoved(juce::ValueTree& parentTree, juce::ValueTree& childWhichHasBeenRemoved, int indexFromWhichChildWasRemoved)
+{
+    appendRecord(juce::ValueTree(removeRecord, {{pathProperty, getPath(parentTree)},
+                                                {indexProperty, indexFromWhichChildWasRemoved}}));
+}
+
+
+void LayoutJournal::valueTreeChildOrderChanged(juce::ValueTree& parentTreeWhoseChildrenHaveMoved, int oldIndex, int newIndex)
+{
+    appendRecord(juce::ValueTree(moveRecord, {{pathProperty, getPath(parentTreeWhoseChildrenHaveMoved)},
+                                              {indexProperty, oldIndex},
+                                              {toProperty, newIndex}}));
+}
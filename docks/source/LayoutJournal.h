@@ -0,0 +1,75 @@
+#pragma once
+#include <juce_gui_basics/juce_gui_basics.h>
+#include "DockManagerData.h"
+
+
+/**
+ -------------------------------------------------------------
+ ===================================
+ MARK: - Layout Journal -
+ ===================================
+ -------------------------------------------------------------
+ */
+
+/**
+ Layout Journal
+ Appends a record of every change to the layout to a journal beside the snapshot file, so a crash
+ between saves loses nothing. A record is the one change, a property set or a tree added, removed or
+ moved, found by its path of child indexes, so its cost doesn't grow with the layout. Once the journal
+ passes maxJournalBytes it's folded into a new snapshot and started again
+
+ The journal is "DKJL" and the snapshot's generation, then records of their size, a checksum and the
+ change as a BinaryLayout tree. A journal from another generation than its snapshot is ignored, and
+ replay stops at the first record which didn't get written whole
+ */
+class LayoutJournal : private juce::ValueTree::Listener
+{
+public:
+
+    /// Starts with a snapshot of the layout as it is
+    LayoutJournal(DockManagerData& data, const juce::File& file, int maxJournalBytes = 1 << 20, LayoutFormat format = LayoutFormat::binary);
+    ~LayoutJournal() override;
+
+    /// Recovery, the snapshot with every whole record in its journal replayed over it
+    static juce::ValueTree recover(const juce::File& file);
+    static juce::File getJournalFile(const juce::File& file);
+
+    /// Compaction, folds the journal into a new snapshot
+    bool compact();
+    const bool isOpen() const;
+    const juce::int64 getJournalSize() const;
+    const int getGeneration() const;
+
+private:
+
+    /// Value Tree Listener, called by DockManagerData before anything else hears of the change
+    void valueTreePropertyChanged(juce::ValueTree& treeWhosePropertyHasChanged, const juce::Identifier& property) override;
+    void valueTreeChildAdded(juce::ValueTree& parentTree, juce::ValueTree& childWhichHasBeenAdded) override;
+    void valueTreeChildRemoved(juce::ValueTree& parentTree, juce::ValueTree& childWhichHasBeenRemoved, int indexFromWhichChildWasRemoved) override;
+    void valueTreeChildOrderChanged(juce::ValueTree& parentTreeWhoseChildrenHaveMoved, int oldIndex, int newIndex) override;
+
+    /// Records
+    void appendRecord(const juce::ValueTree& record);
+    static const juce::String getPath(const juce::ValueTree& tree);
+    static juce::ValueTree findPath(const juce::ValueTree& root, const juce::String& path);
+    static const bool replayRecord(juce::ValueTree& root, const juce::ValueTree& record);
+    static const juce::uint32 getChecksum(const void* data, size_t size);
+
+    /// Journal File
+    bool startJournal();
+
+private:
+
+    DockManagerData& _data;
+    const juce::File _file;
+    const juce::File _journalFile;
+    const int _maxJournalBytes;
+    const LayoutFormat _format;
+
+    int _generation = 0;
+    std::unique_ptr<juce::FileOutputStream> _stream;
+    juce::MemoryOutputStream _recordBuffer;
+
+    /// Utility
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LayoutJournal)
+};
@@ -0,0 +1,175 @@
+#include "LayoutSolver.h"
+
+
+LayoutSolver::LayoutSolver(const DockManagerData& data) : _data(data)
+{
+}
+
+
+
+
+
+/**
+ ===================================
+ MARK: - Solve -
+ ===================================
+ */
+
+void LayoutSolver::solve(const juce::ValueTree& rootView, const juce::Rectangle<int>& bounds)
+{
+    _rects.clearQuick();
+    _resizers.clearQuick();
+    _indexes.clear();
+    if (rootView.isValid())
+        solveTree(rootView, bounds, {}, 0, true);
+}
+
+
+void LayoutSolver::solveWindow(const juce::ValueTree& window, const juce::Rectangle<int>& contentBounds, int footerHeight, int menuHeight)
+{
+    /// As WindowComponent::resized
+    auto bounds = contentBounds;
+    bounds.removeFromBottom(footerHeight);
+    bounds.removeFromTop(menuHeight);
+
+    auto bottomTrim = footerHeight > 0 ? 0 : windowTrim;
+    solve(window.getChild(0), bounds.withTrimmedLeft(windowTrim)
+                                    .withTrimmedTop(windowTrim)
+                                    .withTrimmedRight(windowTrim)
+                                    .withTrimmedBottom(bottomTrim));
+}
+
+
+void LayoutSolver::solveTree(const juce::ValueTree& tree, const juce::Rectangle<int>& bounds, juce::Point<int> origin, int depth, bool isVisible)
+{
+    /// Each tree is laid out in its own space, as its component would be, and then moved into place
+    auto position = origin + bounds.getPosition();
+    auto area = bounds.withZeroOrigin();
+    auto uuid = _data.getUuid(tree);
+
+    Rects rects;
+    rects.uuid = uuid;
+    rects.bounds = bounds + origin;
+    rects.depth = depth;
+    rects.isVisible = isVisible;
+    if (shouldShowHeader(tree))
+        rects.header = area.removeFromTop(headerHeight).reduced(1) + position;
+    rects.content = area.reduced(1) + position;
+
+    /// Children are worked out before any of them is solved, they share the split layout
+    auto numChildren = tree.getNumChildren();
+    juce::Array<juce::Rectangle<int>> childBounds;
+    childBounds.ensureStorageAllocated(numChildren);
+    auto type = _data.getDockType(tree);
+    switch (type)
+    {
+        case DockTypes::none:
+        {
+            childBounds.insertMultiple(0, area, numChildren);
+            break;
+        }
+        case DockTypes::tabs:
+        {
+            childBounds.insertMultiple(0, area.reduced(1), numChildren);
+            break;
+        }
+        case DockTypes::horizontal:
+        case DockTypes::vertical:
+        {
+            /// Each child is followed by a resizer bar, the one before last always takes up the slack
+            auto vertical = type == DockTypes::vertical;
+            auto numResizers = juce::jmax(0, numChildren - 1);
+            _splitLayout.setNumItems(numChildren + numResizers);
+            auto item = 0;
+            for (auto i = 0; i < numChildren; i++)
+            {
+                auto size = 0.0f;
+                auto isFixed = getSplitSize(tree.getChild(i), vertical, size) && i != numChildren - 2;
+                _splitLayout.setItem(item++, nullptr, size, isFixed);
+                if (i < numResizers)
+                    _splitLayout.setItem(item++, nullptr, (float) resizerSize, true);
+            }
+
+            _splitLayout.performLayout(area, (float) (vertical ? bounds.getWidth() : bounds.getHeight()), vertical);
+
+            auto firstResizer = _resizers.size();
+            for (auto i = 0; i < _splitLayout.getNumItems(); i++)
+            {
+                if (i % 2 == 0)
+                    childBounds.add(_splitLayout.getItemBounds(i));
+                else
+                    _resizers.add(_splitLayout.getItemBounds(i) + position);
+            }
+
+            rects.resizers = {firstResizer, _resizers.size()};
+            break;
+        }
+    }
+
+    _indexes.set(uuid, _rects.size());
+    _rects.add(rects);
+
+    auto selectedId = type == DockTypes::tabs ? _data.getSelectedId(tree) : juce::String();
+    for (auto i = 0; i < numChildren; i++)
+    {
+        auto child = tree.getChild(i);
+        auto isChildVisible = isVisible && (type != DockTypes::tabs || _data.getUuid(child) == selectedId);
+        solveTree(child, childBounds[i], position, depth + 1, isChildVisible);
+    }
+}
+
+
+const bool LayoutSolver::shouldShowHeader(const juce::ValueTree& tree) const
+{
+    /// As DockingComponent::shouldShowHeader
+    auto type = _data.getDockType(tree);
+    return type == DockTypes::tabs
+            || (tree.getNumChildren() == 0 && _data.getDockType(tree.getParent()) != DockTypes::tabs);
+}
+
+
+const bool LayoutSolver::getSplitSize(const juce::ValueTree& child, bool vertical, float& size) const
+{
+    if (!(vertical ? dockNode::has<dockSchema::height>(child) : dockNode::has<dockSchema::width>(child))) {return false;}
+    size = vertical ? _data.getHeight(child) : _data.getWidth(child);
+    return true;
+}
+
+
+
+
+
+/**
+ ===================================
+ MARK: - Results -
+ ===================================
+ */
+
+const juce::Array<LayoutSolver::Rects>& LayoutSolver::getAllRects() const
+{
+    return _rects;
+}
+
+
+const LayoutSolver::Rects* LayoutSolver::getRects(const juce::String& uuid) const
+{
+    if (!_indexes.contains(uuid)) {return nullptr;}
+    return &_rects.getReference(_indexes[uuid]);
+}
+
+
+const juce::Rectangle<int> LayoutSolver::getResizerBounds(int index) const
+{
+    return _resizers[index];
+}
+
+
+const LayoutSolver::Rects* LayoutSolver::getRectsAt(const juce::Point<int>& position) const
+{
+    /// Parents come first, so the last match is the deepest
+    const Rects* found = nullptr;
+    for (const auto& rects : _rects)
+        if (rects.isVisible && rects.bounds.contains(position))
+            found = &rects;
+    return found;
+}
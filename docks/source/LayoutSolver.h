@@ -0,0 +1,85 @@
+#pragma once
+#include <juce_gui_basics/juce_gui_basics.h>
+#include "DockManagerData.h"
+#include "SplitLayout.h"
+
+
+/**
+ -------------------------------------------------------------
+ ===================================
+ MARK: - Layout Solver -
+ ===================================
+ -------------------------------------------------------------
+ */
+
+/**
+ Layout Solver
+ Works out where everything in a window goes from the tree alone, the same way DockingComponent::resized
+ and WindowComponent::resized would, without building a component. Headers, resizer gaps and fixed
+ and flexible tracks all come out as they would on screen, so hit testing, drop previews, tests and
+ benchmarks can run without a native peer
+ */
+class LayoutSolver
+{
+public:
+
+    /// The sizes the docking components lay out with
+    static constexpr int headerHeight = 25;
+    static constexpr int resizerSize = 5;
+    static constexpr int windowTrim = 5;
+
+    struct Rects
+    {
+        juce::String uuid;
+        juce::Rectangle<int> bounds;        /// The docking component
+        juce::Rectangle<int> header;        /// Empty when it has no header
+        juce::Rectangle<int> content;       /// Where its view goes
+        juce::Range<int> resizers;          /// Indexes for getResizerBounds
+        int depth = 0;
+        bool isVisible = true;              /// False in tabs which aren't selected
+    };
+
+    LayoutSolver(const DockManagerData& data);
+
+    /**
+     Solve
+     Lays out a root view and everything in it, in one pass
+     @param bounds: the root view's bounds, everything comes out in the same space
+     */
+    void solve(const juce::ValueTree& rootView, const juce::Rectangle<int>& bounds);
+
+    /**
+     Solve Window
+     @param contentBounds: the window's content, as the window component would be given
+     @param footerHeight: the footer, or the locked button, if the window has one
+     @param menuHeight: the menu bar, if the window shows one
+     */
+    void solveWindow(const juce::ValueTree& window, const juce::Rectangle<int>& contentBounds, int footerHeight = 0, int menuHeight = 0);
+
+    /// Results, in the order the trees are visited, parents first
+    const juce::Array<Rects>& getAllRects() const;
+    const Rects* getRects(const juce::String& uuid) const;
+    const juce::Rectangle<int> getResizerBounds(int index) const;
+
+    /// Hit Testing, the deepest visible view at a position
+    const Rects* getRectsAt(const juce::Point<int>& position) const;
+
+private:
+
+    void solveTree(const juce::ValueTree& tree, const juce::Rectangle<int>& bounds, juce::Point<int> origin, int depth, bool isVisible);
+    const bool shouldShowHeader(const juce::ValueTree& tree) const;
+    const bool getSplitSize(const juce::ValueTree& child, bool vertical, float& size) const;
+
+private:
+
+    const DockManagerData& _data;
+    SplitLayout _splitLayout;
+
+    /// Results
+    juce::Array<Rects> _rects;
+    juce::Array<juce::Rectangle<int>> _resizers;
+    juce::HashMap<juce::String, int> _indexes;
+
+    /// Utility
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LayoutSolver)
+};
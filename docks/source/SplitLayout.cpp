@@ -0,0 +1,165 @@
+#include "SplitLayout.h"
+
+
+/**
+ ===================================
+ MARK: - Items -
+ ===================================
+ */
+
+void SplitLayout::setNumItems(int numItems)
+{
+    if (numItems == _numItems) {return;}
+    if (numItems > _items.size())
+        _items.resize(numItems);
+
+    _numItems = numItems;
+    _isDirty = true;
+    _hasLaidOutItems = false;
+}
+
+
+void SplitLayout::setItem(int index, juce::Component* component, float size, bool isFixed)
+{
+    jassert(juce::isPositiveAndBelow(index, _numItems));
+    auto& item = _items.getReference(index);
+    if (item.component == component && item.isFixed == isFixed && (!isFixed || item.size == size)) {return;}
+
+    item.component = component;
+    item.size = size;
+    item.isFixed = isFixed;
+    item.isLaidOut = false;
+    _isDirty = true;
+}
+
+
+const int SplitLayout::getNumItems() const
+{
+    return _numItems;
+}
+
+
+
+
+
+/**
+ ===================================
+ MARK: - Layout -
+ ===================================
+ */
+
+const bool SplitLayout::performLayout(const juce::Rectangle<int>& bounds, float crossSize, bool vertical)
+{
+    if (isUpToDate(bounds, crossSize, vertical)) {return false;}
+    auto fractionSize = getFractionSize(0, _numItems - 1, (float) (vertical ? bounds.getHeight() : bounds.getWidth()));
+
+    _lastBounds = bounds;
+    _lastCrossSize = crossSize;
+    _lastVertical = vertical;
+
+    /// Positions add up from the start and only the edges get rounded, so neighbours always meet
+    auto position = 0.0f;
+    for (auto i = 0; i < _numItems; i++)
+    {
+        auto& item = _items.getReference(i);
+        auto size = item.isFixed ? std::round(item.size) : fractionSize;
+        layoutItem(item, position, size);
+        position += size;
+    }
+
+    _isDirty = false;
+    _hasLaidOutItems = true;
+    return true;
+}
+
+
+const bool SplitLayout::performLayout(int firstItem, int lastItem)
+{
+    if (!_hasLaidOutItems || !juce::isPositiveAndBelow(firstItem, _numItems) || !juce::isPositiveAndBelow(lastItem, _numItems) || lastItem < firstItem) {return false;}
+
+    /// Works out the whole layout again without moving anything, as only these may have moved
+    auto fractionSize = getFractionSize(0, _numItems - 1, (float) (_lastVertical ? _lastBounds.getHeight() : _lastBounds.getWidth()));
+    auto position = 0.0f;
+    for (auto i = 0; i < _numItems; i++)
+    {
+        const auto& item = _items.getReference(i);
+        auto size = item.isFixed ? std::round(item.size) : fractionSize;
+        if ((i < firstItem || i > lastItem) && (!item.isLaidOut || item.start != position || item.length != size)) {return false;}
+        position += size;
+    }
+
+    position = _items.getReference(firstItem).start;
+    for (auto i = firstItem; i <= lastItem; i++)
+    {
+        auto& item = _items.getReference(i);
+        auto size = item.isFixed ? std::round(item.size) : fractionSize;
+        layoutItem(item, position, size);
+        position += size;
+    }
+
+    _isDirty = false;
+    return true;
+}
+
+
+const float SplitLayout::getFractionSize(int firstItem, int lastItem, float space) const
+{
+    /// Fixed items are rounded to whole pixels and fractional ones share what's left, as Grid's Px and Fr tracks are
+    auto fixedSize = 0.0f;
+    auto numFractions = 0.0f;
+    for (auto i = firstItem; i <= lastItem; i++)
+    {
+        const auto& item = _items.getReference(i);
+        if (item.isFixed)
+            fixedSize += std::round(item.size);
+        else
+            numFractions += 1.0f;
+    }
+
+    return numFractions > 0.0f ? juce::jlimit(0.0f, space, space - fixedSize) / numFractions : 0.0f;
+}
+
+
+void SplitLayout::layoutItem(Item& item, float start, float length)
+{
+    auto crossSize = std::round(_lastCrossSize);
+    auto area = _lastVertical ? juce::Rectangle<float>(0.0f, start, crossSize, length)
+                              : juce::Rectangle<float>(start, 0.0f, length, crossSize);
+
+    item.start = start;
+    item.length = length;
+    item.isLaidOut = true;
+    item.bounds = (area + _lastBounds.getPosition().toFloat()).toNearestIntEdges();
+    if (item.component)
+        item.component->setBounds(item.bounds);
+}
+
+
+const juce::Rectangle<int> SplitLayout::getItemBounds(int index) const
+{
+    if (!juce::isPositiveAndBelow(index, _numItems)) {return {};}
+    return _items.getReference(index).bounds;
+}
+
+
+void SplitLayout::invalidate()
+{
+    _isDirty = true;
+    _hasLaidOutItems = false;
+}
+
+
+const bool SplitLayout::isUpToDate(const juce::Rectangle<int>& bounds, float crossSize, bool vertical) const
+{
+    if (_isDirty || bounds != _lastBounds || crossSize != _lastCrossSize || vertical != _lastVertical) {return false;}
+
+    /// Something else may have moved a component since
+    for (auto i = 0; i < _numItems; i++)
+    {
+        const auto& item = _items.getReference(i);
+        if (item.component && item.component->getBounds() != item.bounds)
+            return false;
+    }
+
+    return true;
+}
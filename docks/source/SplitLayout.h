@@ -0,0 +1,72 @@
+#pragma once
+#include <juce_gui_basics/juce_gui_basics.h>
+
+
+/**
+ -------------------------------------------------------------
+ ===================================
+ MARK: - Split Layout -
+ ===================================
+ -------------------------------------------------------------
+ */
+
+/**
+ Split Layout
+ Lays out a row, or a column, of components the same way a juce::Grid with one Px or
+ Fr(1) track per component would, Px sizes rounded to whole pixels, in a single pass and
+ without allocating. The last layout is kept, so laying out again with nothing changed
+ does no work at all
+ */
+class SplitLayout
+{
+public:
+
+    SplitLayout() = default;
+
+    /// Items, fixed items take their size, the rest share whatever is left evenly
+    void setNumItems(int numItems);
+    void setItem(int index, juce::Component* component, float size, bool isFixed);
+    const int getNumItems() const;
+
+    /// Layout, the cross size is the size of every item across the split. Returns false if nothing needed doing
+    const bool performLayout(const juce::Rectangle<int>& bounds, float crossSize, bool vertical);
+    
+    /// Lays out only the items from first to last again, ie the two either side of a resizer while it's
+    /// dragged. Returns false if anything else would move too, then only a whole layout will do
+    const bool performLayout(int firstItem, int lastItem);
+    const juce::Rectangle<int> getItemBounds(int index) const;
+    void invalidate();
+
+private:
+
+    struct Item
+    {
+        juce::Component* component = nullptr;
+        float size = 0.0f;
+        bool isFixed = false;
+        float start = 0.0f;
+        float length = 0.0f;
+        bool isLaidOut = false;
+        juce::Rectangle<int> bounds;
+    };
+
+    const bool isUpToDate(const juce::Rectangle<int>& bounds, float crossSize, bool vertical) const;
+    const float getFractionSize(int firstItem, int lastItem, float space) const;
+    void layoutItem(Item& item, float start, float length);
+
+private:
+
+    /// Items, storage only ever grows so it's reused between layouts
+    juce::Array<Item> _items;
+    int _numItems = 0;
+
+    /// Last Layout
+    bool _isDirty = true;
+    bool _hasLaidOutItems = false;
+    juce::Rectangle<int> _lastBounds;
+    float _lastCrossSize = 0.0f;
+    bool _lastVertical = false;
+
+    /// Utility
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SplitLayout)
+};
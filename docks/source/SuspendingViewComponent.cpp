@@ -0,0 +1,115 @@
+#include "SuspendingViewComponent.h"
+
+
+SuspendingViewComponent::SuspendingViewComponent(std::unique_ptr<juce::Component> content)
+{
+    setContent(std::move(content));
+}
+
+
+SuspendingViewComponent::~SuspendingViewComponent()
+{
+    if (_content)
+        removeChildComponent(_content.get());
+}
+
+
+
+
+
+/**
+ ===================================
+ MARK: - Content -
+ ===================================
+ */
+
+void SuspendingViewComponent::setContent(std::unique_ptr<juce::Component> content)
+{
+    if (_content)
+        removeChildComponent(_content.get());
+
+    _content = std::move(content);
+    if (!_content) {return;}
+
+    addChildComponent(_content.get());
+    _content->setVisible(!isSuspended());
+    resized();
+}
+
+
+juce::Component* SuspendingViewComponent::getContent() const
+{
+    return _content.get();
+}
+
+
+
+
+
+/**
+ ===================================
+ MARK: - Visibility -
+ ===================================
+ */
+
+void SuspendingViewComponent::setViewVisibility(ViewVisibility visibility)
+{
+    auto wasSuspended = isSuspended();
+    _visibility = visibility;
+    if (wasSuspended == isSuspended()) {return;}
+
+    if (_content)
+        _content->setVisible(!isSuspended());
+
+    if (isSuspended())
+        suspend();
+    else
+        resume();
+}
+
+
+const SuspendingViewComponent::ViewVisibility SuspendingViewComponent::getViewVisibility() const
+{
+    return _visibility;
+}
+
+
+const bool SuspendingViewComponent::isSuspended() const
+{
+    return _visibility != ViewVisibility::shown;
+}
+
+
+void SuspendingViewComponent::viewVisibilityChanged(juce::Component& view, ViewVisibility visibility)
+{
+    if (auto suspending = dynamic_cast<SuspendingViewComponent*>(&view))
+        suspending->setViewVisibility(visibility);
+}
+
+
+void SuspendingViewComponent::suspend()
+{
+    onSuspend();
+}
+
+
+void SuspendingViewComponent::resume()
+{
+    onResume();
+}
+
+
+
+
+
+/**
+ ===================================
+ MARK: - Component Overrides -
+ ===================================
+ */
+
+void SuspendingViewComponent::resized()
+{
+    if (_content)
+        _content->setBounds(getLocalBounds());
+}
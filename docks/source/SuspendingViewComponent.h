@@ -0,0 +1,63 @@
+#pragma once
+#include <juce_gui_basics/juce_gui_basics.h>
+#include "DockManager.h"
+
+
+/**
+ -------------------------------------------------------------
+ ===================================
+ MARK: - Suspending View Component -
+ ===================================
+ -------------------------------------------------------------
+ */
+
+/**
+ Suspending View Component
+ Wraps a view so it can stop working while it can't be seen. Return one from Delegate::createView,
+ and pass Delegate::viewVisibilityChanged on with SuspendingViewComponent::viewVisibilityChanged.
+ While suspended the content is hidden, so it stops painting, and suspend() lets it stop its timers
+ and subscriptions until resume()
+ */
+class SuspendingViewComponent : public juce::Component
+{
+public:
+    using ViewVisibility = DockManager::Delegate::ViewVisibility;
+
+    SuspendingViewComponent(std::unique_ptr<juce::Component> content = nullptr);
+    ~SuspendingViewComponent() override;
+
+    /// Content
+    void setContent(std::unique_ptr<juce::Component> content);
+    juce::Component* getContent() const;
+
+    /// Visibility
+    void setViewVisibility(ViewVisibility visibility);
+    const ViewVisibility getViewVisibility() const;
+    const bool isSuspended() const;
+
+    /// Passes a Delegate::viewVisibilityChanged on, if the view is one of these
+    static void viewVisibilityChanged(juce::Component& view, ViewVisibility visibility);
+
+    /// Called when the view can't be seen anymore, and when it can again
+    std::function<void()> onSuspend = []{};
+    std::function<void()> onResume = []{};
+
+protected:
+
+    /// Override to stop and restart work, by default these call the callbacks
+    virtual void suspend();
+    virtual void resume();
+
+private:
+
+    /// Component Overrides
+    void resized() override;
+
+private:
+
+    std::unique_ptr<juce::Component> _content;
+    ViewVisibility _visibility = ViewVisibility::shown;
+
+    /// Utility
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SuspendingViewComponent)
+};
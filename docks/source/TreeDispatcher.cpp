@@ -0,0 +1,218 @@
+#include "TreeDispatcher.h"
+
+
+TreeDispatcher::TreeDispatcher(DockManagerData& data) : _data(data)
+{
+    _data.addTreeListener(this);
+    _data.addTransactionListener(this);
+}
+
+
+TreeDispatcher::~TreeDispatcher()
+{
+    _data.removeTreeListener(this);
+    _data.removeTransactionListener(this);
+}
+
+
+
+
+
+/**
+ ===================================
+ MARK: - Registration -
+ ===================================
+ */
+
+void TreeDispatcher::addListener(const juce::ValueTree& tree, juce::ValueTree::Listener* listener)
+{
+    add(_listeners, tree, listener);
+}
+
+
+void TreeDispatcher::removeListener(const juce::ValueTree& tree, juce::ValueTree::Listener* listener)
+{
+    remove(_listeners, tree, listener);
+}
+
+
+const int TreeDispatcher::getNumListeners(const juce::ValueTree& tree) const
+{
+    return count(_listeners, tree);
+}
+
+
+void TreeDispatcher::addTransactionListener(const juce::ValueTree& tree, DockManagerData::TransactionListener* listener)
+{
+    add(_transactionListeners, tree, listener);
+}
+
+
+void TreeDispatcher::removeTransactionListener(const juce::ValueTree& tree, DockManagerData::TransactionListener* listener)
+{
+    remove(_transactionListeners, tree, listener);
+}
+
+
+const int TreeDispatcher::getNumTransactionListeners(const juce::ValueTree& tree) const
+{
+    return count(_transactionListeners, tree);
+}
+
+
+template <typename ListenerType>
+void TreeDispatcher::add(Registrations<ListenerType>& registrations, const juce::ValueTree& tree, ListenerType* listener)
+{
+    auto uuid = _data.getUuid(tree);
+    if (isRegistered(registrations, uuid, tree, listener)) {return;}
+    registrations[uuid].add({tree, listener});
+}
+
+
+template <typename ListenerType>
+void TreeDispatcher::remove(Registrations<ListenerType>& registrations, const juce::ValueTree& tree, ListenerType* listener)
+{
+    auto isListener = [&](const Registration<ListenerType>& r) {return r.tree == tree && r.listener == listener;};
+    auto found = registrations.find(_data.getUuid(tree));
+    if (found != registrations.end() && found->second.removeIf(isListener) > 0)
+    {
+        if (found->second.isEmpty())
+            registrations.erase(found);
+        return;
+    }
+
+    /// Its uuid changed where the data couldn't hear it, ie while it was out of the layout
+    for (auto it = registrations.begin(); it != registrations.end();)
+    {
+        it->second.removeIf(isListener);
+        it = it->second.isEmpty() ? registrations.erase(it) : std::next(it);
+    }
+}
+
+
+template <typename ListenerType>
+const int TreeDispatcher::count(const Registrations<ListenerType>& registrations, const juce::ValueTree& tree) const
+{
+    auto found = registrations.find(_data.getUuid(tree));
+    if (found == registrations.end()) {return 0;}
+
+    auto numListeners = 0;
+    for (const auto& registration : found->second)
+        if (registration.tree == tree)
+            numListeners++;
+
+    return numListeners;
+}
+
+
+template <typename ListenerType>
+const bool TreeDispatcher::isRegistered(const Registrations<ListenerType>& registrations, const juce::String& uuid, const juce::ValueTree& tree, ListenerType* listener)
+{
+    auto found = registrations.find(uuid);
+    if (found == registrations.end()) {return false;}
+
+    for (const auto& registration : found->second)
+        if (registration.tree == tree && registration.listener == listener)
+            return true;
+
+    return false;
+}
+
+
+template <typename ListenerType>
+void TreeDispatcher::uuidDidChange(Registrations<ListenerType>& registrations, const juce::ValueTree& tree, const juce::String& uuid)
+{
+    /// Registrations stay with their tree, whatever it's called
+    juce::Array<Registration<ListenerType>> moved;
+    for (auto it = registrations.begin(); it != registrations.end();)
+    {
+        if (it->first != uuid)
+        {
+            for (const auto& registration : it->second)
+                if (registration.tree == tree)
+                    moved.add(registration);
+            it->second.removeIf([&](const Registration<ListenerType>& r) {return r.tree == tree;});
+        }
+        it = it->second.isEmpty() ? registrations.erase(it) : std::next(it);
+    }
+
+    for (const auto& registration : moved)
+        if (!isRegistered(registrations, uuid, tree, registration.listener))
+            registrations[uuid].add(registration);
+}
+
+
+
+
+
+/**
+ ===================================
+ MARK: - Routing -
+ ===================================
+ */
+
+template <typename ListenerType, typename Callback>
+void TreeDispatcher::callListeners(const Registrations<ListenerType>& registrations, const juce::ValueTree& tree, Callback&& callback)
+{
+    auto uuid = _data.getUuid(tree);
+    auto found = registrations.find(uuid);
+    if (found == registrations.end()) {return;}
+
+    /// Callbacks may add or remove listeners, so only call those still registered
+    auto registered = found->second;
+    for (const auto& registration : registered)
+    {
+        if (registration.tree != tree || !isRegistered(registrations, uuid, tree, registration.listener)) {continue;}
+        DockCounters::dispatchedCalls++;
+        callback(*registration.listener);
+    }
+}
+
+
+void TreeDispatcher::valueTreeChildAdded(juce::ValueTree& parentTree, juce::ValueTree& childWhichHasBeenAdded)
+{
+    onStructureChanged();
+    if (_data.isInTransaction()) {return;}
+    callListeners(_listeners, parentTree, [&](juce::ValueTree::Listener& l) {l.valueTreeChildAdded(parentTree, childWhichHasBeenAdded);});
+
+    /// Only the tree which moved, everything below it kept its parent
+    callListeners(_listeners, childWhichHasBeenAdded, [&](juce::ValueTree::Listener& l) {l.valueTreeParentChanged(childWhichHasBeenAdded);});
+}
+
+
+void TreeDispatcher::valueTreeChildRemoved(juce::ValueTree& parentTree, juce::ValueTree& childWhichHasBeenRemoved, int indexFromWhichChildWasRemoved)
+{
+    onStructureChanged();
+    if (_data.isInTransaction()) {return;}
+    callListeners(_listeners, parentTree, [&](juce::ValueTree::Listener& l) {l.valueTreeChildRemoved(parentTree, childWhichHasBeenRemoved, indexFromWhichChildWasRemoved);});
+    callListeners(_listeners, childWhichHasBeenRemoved, [&](juce::ValueTree::Listener& l) {l.valueTreeParentChanged(childWhichHasBeenRemoved);});
+}
+
+
+void TreeDispatcher::valueTreeChildOrderChanged(juce::ValueTree& parentTreeWhoseChildrenHaveMoved, int oldIndex, int newIndex)
+{
+    onStructureChanged();
+    if (_data.isInTransaction()) {return;}
+    callListeners(_listeners, parentTreeWhoseChildrenHaveMoved, [&](juce::ValueTree::Listener& l) {l.valueTreeChildOrderChanged(parentTreeWhoseChildrenHaveMoved, oldIndex, newIndex);});
+}
+
+
+void TreeDispatcher::valueTreePropertyChanged(juce::ValueTree& treeWhosePropertyHasChanged, const juce::Identifier& property)
+{
+    if (dockNode::is<dockSchema::uuid>(property))
+    {
+        auto uuid = _data.getUuid(treeWhosePropertyHasChanged);
+        uuidDidChange(_listeners, treeWhosePropertyHasChanged, uuid);
+        uuidDidChange(_transactionListeners, treeWhosePropertyHasChanged, uuid);
+    }
+
+    onPropertyChanged();
+    if (_data.isInTransaction()) {return;}
+    callListeners(_listeners, treeWhosePropertyHasChanged, [&](juce::ValueTree::Listener& l) {l.valueTreePropertyChanged(treeWhosePropertyHasChanged, property);});
+}
+
+
+void TreeDispatcher::transactionDidCommit(const juce::ValueTree& affectedTree)
+{
+    callListeners(_transactionListeners, affectedTree, [&](DockManagerData::TransactionListener& l) {l.transactionDidCommit(affectedTree);});
+}
@@ -0,0 +1,93 @@
+#pragma once
+#include <juce_gui_basics/juce_gui_basics.h>
+#include "DockManagerData.h"
+#include <unordered_map>
+
+
+/**
+ -------------------------------------------------------------
+ ===================================
+ MARK: - Tree Dispatcher -
+ ===================================
+ -------------------------------------------------------------
+ */
+
+/**
+ Tree Dispatcher
+ Listens once to the data, after it has indexed each change, and routes each change and each
+ committed tree straight to the listeners registered for that tree, by uuid. A listener only hears
+ about its own tree, never about every change further down it or every tree in a commit, and
+ nothing is routed while a transaction is open
+ */
+class TreeDispatcher : private juce::ValueTree::Listener, private DockManagerData::TransactionListener
+{
+public:
+
+    TreeDispatcher(DockManagerData& data);
+    ~TreeDispatcher();
+
+    /// Registration
+    void addListener(const juce::ValueTree& tree, juce::ValueTree::Listener* listener);
+    void removeListener(const juce::ValueTree& tree, juce::ValueTree::Listener* listener);
+    const int getNumListeners(const juce::ValueTree& tree) const;
+
+    /// Commits of their own tree only, transactionDidEnd() goes to the data's listeners
+    void addTransactionListener(const juce::ValueTree& tree, DockManagerData::TransactionListener* listener);
+    void removeTransactionListener(const juce::ValueTree& tree, DockManagerData::TransactionListener* listener);
+    const int getNumTransactionListeners(const juce::ValueTree& tree) const;
+
+    /// Any property changed anywhere, even inside a transaction
+    std::function<void()> onPropertyChanged = []{};
+
+    /// Any child added, removed or moved anywhere, even inside a transaction
+    std::function<void()> onStructureChanged = []{};
+
+private:
+
+    /// Value Tree Listener
+    void valueTreeChildAdded(juce::ValueTree& parentTree, juce::ValueTree& childWhichHasBeenAdded) override;
+    void valueTreeChildRemoved(juce::ValueTree& parentTree, juce::ValueTree& childWhichHasBeenRemoved, int indexFromWhichChildWasRemoved) override;
+    void valueTreeChildOrderChanged(juce::ValueTree& parentTreeWhoseChildrenHaveMoved, int oldIndex, int newIndex) override;
+    void valueTreePropertyChanged(juce::ValueTree& treeWhosePropertyHasChanged, const juce::Identifier& property) override;
+
+    /// Transaction Listener
+    void transactionDidCommit(const juce::ValueTree& affectedTree) override;
+
+    /// Listeners by the uuid of their tree
+    template <typename ListenerType>
+    struct Registration
+    {
+        juce::ValueTree tree;
+        ListenerType* listener;
+    };
+
+    template <typename ListenerType>
+    using Registrations = std::unordered_map<juce::String, juce::Array<Registration<ListenerType>>>;
+
+    template <typename ListenerType>
+    void add(Registrations<ListenerType>& registrations, const juce::ValueTree& tree, ListenerType* listener);
+    template <typename ListenerType>
+    void remove(Registrations<ListenerType>& registrations, const juce::ValueTree& tree, ListenerType* listener);
+    template <typename ListenerType>
+    const int count(const Registrations<ListenerType>& registrations, const juce::ValueTree& tree) const;
+    template <typename ListenerType>
+    static const bool isRegistered(const Registrations<ListenerType>& registrations, const juce::String& uuid, const juce::ValueTree& tree, ListenerType* listener);
+    template <typename ListenerType>
+    static void uuidDidChange(Registrations<ListenerType>& registrations, const juce::ValueTree& tree, const juce::String& uuid);
+
+    /// Routing
+    template <typename ListenerType, typename Callback>
+    void callListeners(const Registrations<ListenerType>& registrations, const juce::ValueTree& tree, Callback&& callback);
+
+private:
+
+    /// Data
+    DockManagerData& _data;
+
+    /// Listeners
+    Registrations<juce::ValueTree::Listener> _listeners;
+    Registrations<DockManagerData::TransactionListener> _transactionListeners;
+
+    /// Utility
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TreeDispatcher)
+};
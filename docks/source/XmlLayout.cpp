@@ -0,0 +1,226 @@
+#include "XmlLayout.h"
+
+
+namespace
+{
+    /// As XmlElement, attributes wrap onto a new line once a line gets longer than this
+    constexpr int xmlLineWrapLength = 60;
+    const char xmlNewLine[] = "\r\n";
+    const char xmlHeader[] = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>";
+
+
+    /// The characters XmlElement writes as they are, everything else is escaped
+    const bool isLegalXmlChar(juce::uint32 c)
+    {
+        static const unsigned char legalChars[] = {0, 0, 0, 0, 187, 255, 255, 175, 255, 255, 255, 191, 254, 255, 255, 127};
+        return c < sizeof(legalChars) * 8 && (legalChars[c >> 3] & (1 << (c & 7))) != 0;
+    }
+
+
+    /**
+     XmlWriter
+     Collects everything in a fixed buffer and hands it to the stream in large blocks,
+     rather than a virtual write for every byte
+     */
+    struct XmlWriter
+    {
+        explicit XmlWriter(juce::OutputStream& s) : stream(s) {}
+
+        juce::OutputStream& stream;
+        char buffer[4096];
+        size_t numBuffered = 0;
+        juce::int64 position = 0;
+        bool failed = false;
+
+        void write(const char* data, size_t numBytes)
+        {
+            position += (juce::int64) numBytes;
+            if (numBytes > sizeof(buffer) - numBuffered)
+            {
+                flush();
+                if (numBytes >= sizeof(buffer))
+                {
+                    failed |= !stream.write(data, numBytes);
+                    return;
+                }
+            }
+
+            std::memcpy(buffer + numBuffered, data, numBytes);
+            numBuffered += numBytes;
+        }
+
+        void writeByte(char byte)
+        {
+            if (numBuffered == sizeof(buffer))
+                flush();
+
+            buffer[numBuffered++] = byte;
+            position++;
+        }
+
+        void writeString(const juce::String& string)
+        {
+            write(string.toRawUTF8(), string.getNumBytesAsUTF8());
+        }
+
+        void writeSpaces(int numSpaces)
+        {
+            for (auto i = 0; i < numSpaces; i++)
+                writeByte(' ');
+        }
+
+        void writeNumber(juce::int64 number)
+        {
+            char digits[24];
+            auto end = digits + sizeof(digits);
+            auto start = end;
+            auto magnitude = number < 0 ? 0 - (juce::uint64) number : (juce::uint64) number;
+            do
+            {
+                *--start = (char) ('0' + magnitude % 10);
+                magnitude /= 10;
+            }
+            while (magnitude != 0);
+
+            if (number < 0)
+                *--start = '-';
+
+            write(start, (size_t) (end - start));
+        }
+
+        /// XmlOutputFunctions::escapeIllegalXmlChars, for attribute values
+        void writeEscaped(const juce::String& text)
+        {
+            auto t = text.getCharPointer();
+            for (;;)
+            {
+                auto c = (juce::uint32) t.getAndAdvance();
+                if (c == 0) {return;}
+
+                if (isLegalXmlChar(c))
+                {
+                    writeByte((char) c);
+                    continue;
+                }
+
+                switch (c)
+                {
+                    case '&': write("&amp;", 5); break;
+                    case '"': write("&quot;", 6); break;
+                    case '>': write("&gt;", 4); break;
+                    case '<': write("&lt;", 4); break;
+                    default:
+                        write("&#", 2);
+                        writeNumber((juce::int64) c);
+                        writeByte(';');
+                        break;
+                }
+            }
+        }
+
+        /// The same text as var::toString(), without making a String for the common types
+        void writeValue(const juce::var& value)
+        {
+            if (value.isString())
+                writeEscaped(value.toString());
+            else if (value.isInt() || value.isInt64())
+                writeNumber((juce::int64) value);
+            else if (value.isBool())
+                writeByte((bool) value ? '1' : '0');
+            else if (!value.isVoid())
+                writeEscaped(value.toString());
+        }
+
+        void flush()
+        {
+            if (numBuffered == 0) {return;}
+            failed |= !stream.write(buffer, numBuffered);
+            numBuffered = 0;
+        }
+    };
+
+
+    /// XmlElement::writeElementAsText, for the element ValueTree::createXml would make of the tree
+    void writeXmlTree(XmlWriter& writer, const juce::ValueTree& tree, int indentationLevel)
+    {
+        const auto& tagName = tree.getType().toString();
+        writer.writeSpaces(indentationLevel);
+        writer.writeByte('<');
+        writer.writeString(tagName);
+
+        auto attributeIndent = indentationLevel + tagName.length() + 1;
+        auto lineLength = 0;
+        for (auto i = 0; i < tree.getNumProperties(); i++)
+        {
+            if (lineLength > xmlLineWrapLength)
+            {
+                writer.write(xmlNewLine, 2);
+                writer.writeSpaces(attributeIndent);
+                lineLength = 0;
+            }
+
+            auto start = writer.position;
+            auto name = tree.getPropertyName(i);
+            const auto& value = tree.getProperty(name);
+            writer.writeByte(' ');
+
+            /// Binary data is base64 encoded, and says so in its name
+            auto binary = value.getBinaryData();
+            if (binary != nullptr)
+                writer.write("base64:", 7);
+
+            writer.writeString(name.toString());
+            writer.write("=\"", 2);
+            if (binary != nullptr)
+                writer.writeEscaped(binary->toBase64Encoding());
+            else
+                writer.writeValue(value);
+
+            writer.writeByte('"');
+            lineLength += (int) (writer.position - start);
+        }
+
+        if (tree.getNumChildren() == 0)
+        {
+            writer.write("/>", 2);
+            return;
+        }
+
+        writer.writeByte('>');
+        for (const auto& child : tree)
+        {
+            writer.write(xmlNewLine, 2);
+            writeXmlTree(writer, child, indentationLevel + 2);
+        }
+
+        writer.write(xmlNewLine, 2);
+        writer.writeSpaces(indentationLevel);
+        writer.write("</", 2);
+        writer.writeString(tagName);
+        writer.writeByte('>');
+    }
+}
+
+
+
+
+
+/**
+ ===================================
+ MARK: - Writing -
+ ===================================
+ */
+
+bool XmlLayout::write(const juce::ValueTree& tree, juce::OutputStream& stream)
+{
+    if (!tree.isValid()) {return false;}
+
+    XmlWriter writer(stream);
+    writer.write(xmlHeader, sizeof(xmlHeader) - 1);
+    writer.write(xmlNewLine, 2);
+    writer.write(xmlNewLine, 2);
+    writeXmlTree(writer, tree, 0);
+    writer.write(xmlNewLine, 2);
+    writer.flush();
+    return !writer.failed;
+}
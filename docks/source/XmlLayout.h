@@ -0,0 +1,30 @@
+#pragma once
+#include <juce_gui_basics/juce_gui_basics.h>
+
+
+/**
+ -------------------------------------------------------------
+ ===================================
+ MARK: - Xml Layout -
+ ===================================
+ -------------------------------------------------------------
+ */
+
+/**
+ Xml Layout
+ Writes a layout as XML straight from the tree, without building an XmlElement of it first.
+ The bytes are the same as tree.createXml()->writeTo(stream) with the default TextFormat, so
+ layouts saved either way can't be told apart. Everything goes through one buffer on the stack,
+ so the only allocations left are for doubles and binary properties, which juce::var formats
+ */
+class XmlLayout
+{
+public:
+
+    /// Writing
+    static bool write(const juce::ValueTree& tree, juce::OutputStream& stream);
+
+private:
+
+    XmlLayout() = delete;
+};
@@ -0,0 +1,413 @@
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+#include "catch2.hpp"
+#include "../source/DockManager.h"
+
+
+/// Mock Delegate
+class BenchManagerDelegate : public DockManager::Delegate
+{
+public:
+    const juce::StringArray getAvailableViews() const override { return {"Elements", "Canvas", "Cues", "Palette", "CueLists", "ElementLists"}; }
+    std::shared_ptr<juce::Component> createView(const juce::String &nameOfViewToCreate) override { return nullptr; }
+    const juce::String getDefaultWindowName() const override {return "Window";}
+};
+
+
+/// Benchmarking class with access to the unbatched paths
+class bench_DockManager : public DockManager
+{
+public:
+    bench_DockManager(DockManager::Delegate& delegate) : DockManager(delegate) {}
+    
+    /// create3By3 one call at a time, as it ran before presets were batched
+    void create3By3Unbatched(const juce::StringArray& views)
+    {
+        juce::Rectangle<float> bounds;
+        if (auto display = juce::Desktop::getInstance().getDisplays().getPrimaryDisplay())
+            bounds = display->userArea.toFloat();
+        
+        auto [windowId, rootId] = _data.addNewWindow("Window", bounds);
+        auto leftColumn = _data.dockNewView(rootId, DropLocation::rootRight, views[0]);
+        auto centerColumn = _data.dockNewView(rootId, DropLocation::rootRight, views[2]);
+        auto rightColumn = _data.dockNewView(rootId, DropLocation::rootRight, views[4]);
+        _data.dockNewView(leftColumn, DropLocation::viewBottom, views[1]);
+        _data.dockNewView(centerColumn, DropLocation::viewBottom, views[3]);
+        _data.dockNewView(rightColumn, DropLocation::viewBottom, views[5]);
+    }
+    
+    /// openLayout as it ran before transactions
+    void openLayoutUnbatched(const juce::String& xmlLayout)
+    {
+        _components.clear();
+        _windows.clear();
+        auto xml = juce::parseXML(xmlLayout);
+        auto tree = _data.getTree();
+        tree.removeAllChildren(nullptr);
+        tree.copyPropertiesAndChildrenFrom(juce::ValueTree::fromXml(*xml), nullptr);
+    }
+    
+    const juce::String getLayoutXml() {return _data.getTree().toXmlString();}
+    void clearWindows() {_data.clearWindows();}
+    void removeLastWindow()
+    {
+        auto rootTree = _data.getTree();
+        _data.removeWindow(_data.getUuid(rootTree.getChild(rootTree.getNumChildren() - 1)));
+    }
+    
+    /// Adds windows of ten views each, in one transaction
+    void addViews(int numViews)
+    {
+        DockManagerData::ScopedTransaction transaction(_data);
+        juce::String rootId;
+        for (auto i = 0; i < numViews; i++)
+        {
+            if (i % 10 == 0)
+                rootId = _data.addNewWindow("Window" + juce::String(i / 10)).second;
+            _data.addView(rootId, "View" + juce::String(i), DockTypes::none);
+        }
+    }
+    
+    /// Every docking component, to check a layout was built all the way down
+    const int getNumDockingComponents() const {return _dockingComponents.size();}
+    const int getNumWindows() const {return _windows.size();}
+    DockManagerData& getData() {return _data;}
+    const TreeDispatcher& getDispatcher() const {return _dispatcher;}
+    
+    /// Drag moves, the way they ran before the drop zone index, and through it
+    DockingComponent* getDockingComponent(const juce::String& uuid) {return _dockingComponents[uuid].lock().get();}
+    void buildDropZones(const juce::String& draggingId) {DockManager::buildDropZones(draggingId);}
+    const DropZoneIndex& getDropZones() const {return _dropZones;}
+    DropZoneIndex::Zone getLiveDropZone(DockingComponent* component, juce::Point<int> position, const juce::String& draggingId)
+    {
+        return component->getDropZone(component->getDragLocation(position), draggingId);
+    }
+    
+    /// Every open window, to check which ones survive a reload
+    juce::Array<DockingWindow*> getWindows()
+    {
+        juce::Array<DockingWindow*> windows;
+        for (WindowMap::Iterator it(_windows); it.next();)
+            windows.add(it.getValue().get());
+        return windows;
+    }
+};
+
+
+/// Listener and layout traffic for a single call
+struct Traffic
+{
+    int treeCallbacks = 0;
+    int layoutPasses = 0;
+};
+
+
+template <typename Func>
+Traffic measureTraffic(Func&& func)
+{
+    DockCounters::reset();
+    func();
+    return {DockCounters::treeCallbacks, DockCounters::layoutPasses};
+}
+
+
+/// Counts the calls JUCE would make if every registration listened on its own tree
+class PerTreeListeners
+{
+public:
+    PerTreeListeners(const juce::ValueTree& rootTree, const TreeDispatcher& dispatcher) {attach(rootTree, dispatcher);}
+    ~PerTreeListeners()
+    {
+        for (auto& listener : _listeners)
+            listener->tree.removeListener(listener.get());
+    }
+    
+    int calls = 0;
+    
+private:
+    struct Counter : public juce::ValueTree::Listener
+    {
+        Counter(const juce::ValueTree& t, int& c) : tree(t), calls(c) {tree.addListener(this);}
+        void valueTreePropertyChanged(juce::ValueTree&, const juce::Identifier&) override {calls++;}
+        void valueTreeChildAdded(juce::ValueTree&, juce::ValueTree&) override {calls++;}
+        void valueTreeChildRemoved(juce::ValueTree&, juce::ValueTree&, int) override {calls++;}
+        void valueTreeChildOrderChanged(juce::ValueTree&, int, int) override {calls++;}
+        void valueTreeParentChanged(juce::ValueTree&) override {calls++;}
+        juce::ValueTree tree;
+        int& calls;
+    };
+    
+    void attach(const juce::ValueTree& tree, const TreeDispatcher& dispatcher)
+    {
+        for (auto i = 0; i < dispatcher.getNumListeners(tree); i++)
+            _listeners.push_back(std::make_unique<Counter>(tree, calls));
+        for (const auto& child : tree)
+            attach(child, dispatcher);
+    }
+    
+    std::vector<std::unique_ptr<Counter>> _listeners;
+};
+
+
+
+
+/**
+ ===================================
+ MARK: - Presets -
+ ===================================
+ Run with: [!benchmark]
+ */
+
+TEST_CASE("bench_presetTransaction", "[!benchmark]")
+{
+    auto delegate = BenchManagerDelegate();
+    auto manager = bench_DockManager(delegate);
+    auto views = delegate.getAvailableViews();
+    
+    auto unbatched = measureTraffic([&] {manager.create3By3Unbatched(views);});
+    manager.clearWindows();
+    auto batched = measureTraffic([&] {manager.create3By3("Window", views);});
+    CHECK(manager.getNumWindows() == 1);
+    manager.clearWindows();
+    
+    WARN("create3By3 callbacks: " << unbatched.treeCallbacks << " -> " << batched.treeCallbacks
+         << ", layout passes: " << unbatched.layoutPasses << " -> " << batched.layoutPasses);
+    CHECK(batched.treeCallbacks < unbatched.treeCallbacks);
+    CHECK(batched.layoutPasses < unbatched.layoutPasses);
+    
+    BENCHMARK("create3By3 unbatched")
+    {
+        manager.create3By3Unbatched(views);
+        manager.clearWindows();
+    };
+    
+    BENCHMARK("create3By3 transaction")
+    {
+        manager.create3By3("Window", views);
+        manager.clearWindows();
+    };
+}
+
+
+
+
+/**
+ ===================================
+ MARK: - Layout Sizes -
+ ===================================
+ */
+
+TEST_CASE("bench_managerOperations", "[!benchmark]")
+{
+    for (auto numViews : {10, 100, 1000})
+    {
+        auto delegate = BenchManagerDelegate();
+        auto manager = bench_DockManager(delegate);
+        auto views = delegate.getAvailableViews();
+        manager.addViews(numViews);
+        auto numComponents = manager.getNumDockingComponents();
+        REQUIRE(numComponents >= numViews);
+        
+        juce::MemoryOutputStream saved;
+        manager.saveLayout(saved);
+        BENCHMARK("saveLayout - " + juce::String(numViews).toStdString() + " views")
+        {
+            juce::MemoryOutputStream stream;
+            manager.saveLayout(stream);
+            return stream.getDataSize();
+        };
+        
+        /// Not reconciled, so every window and docking component is built again
+        BENCHMARK("openLayout and build components - " + juce::String(numViews).toStdString() + " views")
+        {
+            juce::MemoryInputStream stream(saved.getData(), saved.getDataSize(), false);
+            manager.openLayout(stream, false);
+        };
+        CHECK(manager.getNumDockingComponents() == numComponents);
+        
+        /// Each preset in a window of its own beside the layout, which is then removed
+        BENCHMARK("preset builders - " + juce::String(numViews).toStdString() + " views")
+        {
+            for (auto preset : {&DockManager::create2Up, &DockManager::create3Up, &DockManager::create4Up, &DockManager::create2By2,
+                                &DockManager::create3By3, &DockManager::create2Rows, &DockManager::create3Rows})
+            {
+                (manager.*preset)("Preset", views);
+                manager.removeLastWindow();
+            }
+        };
+        CHECK(manager.getNumDockingComponents() == numComponents);
+    }
+}
+
+
+
+
+/**
+ ===================================
+ MARK: - Open Layout -
+ ===================================
+ */
+
+TEST_CASE("bench_openLayoutTransaction", "[!benchmark]")
+{
+    auto delegate = BenchManagerDelegate();
+    auto manager = bench_DockManager(delegate);
+    auto views = delegate.getAvailableViews();
+    
+    /// Three 3x3 windows
+    for (auto i = 0; i < 3; i++)
+        manager.create3By3("Window", views);
+    auto layout = manager.getLayoutXml();
+    
+    auto unbatched = measureTraffic([&] {manager.openLayoutUnbatched(layout);});
+    CHECK(manager.getNumWindows() == 3);
+    auto stream = juce::MemoryInputStream(layout.toRawUTF8(), layout.getNumBytesAsUTF8(), false);
+    auto batched = measureTraffic([&] {manager.openLayout(stream, false);});
+    CHECK(manager.getNumWindows() == 3);
+    
+    /// Reloading the same layout keeps every window
+    auto windows = manager.getWindows();
+    stream.setPosition(0);
+    auto reconciled = measureTraffic([&] {manager.openLayout(stream, true);});
+    CHECK(manager.getNumWindows() == 3);
+    for (auto window : manager.getWindows())
+        CHECK(windows.contains(window));
+    
+    /// Whole windows were already attached at once, so the saving here is in callbacks
+    WARN("openLayout callbacks: " << unbatched.treeCallbacks << " -> " << batched.treeCallbacks
+         << ", layout passes: " << unbatched.layoutPasses << " -> " << batched.layoutPasses);
+    CHECK(batched.treeCallbacks < unbatched.treeCallbacks);
+    CHECK(batched.layoutPasses <= unbatched.layoutPasses);
+    
+    WARN("openLayout reconcile callbacks: " << reconciled.treeCallbacks << ", layout passes: " << reconciled.layoutPasses);
+    CHECK(reconciled.treeCallbacks < batched.treeCallbacks);
+    CHECK(reconciled.layoutPasses < batched.layoutPasses);
+    
+    BENCHMARK("openLayout unbatched")
+    {
+        manager.openLayoutUnbatched(layout);
+    };
+    
+    BENCHMARK("openLayout transaction")
+    {
+        auto input = juce::MemoryInputStream(layout.toRawUTF8(), layout.getNumBytesAsUTF8(), false);
+        manager.openLayout(input, false);
+    };
+    
+    BENCHMARK("openLayout reconcile")
+    {
+        auto input = juce::MemoryInputStream(layout.toRawUTF8(), layout.getNumBytesAsUTF8(), false);
+        manager.openLayout(input, true);
+    };
+}
+
+
+
+
+
+/**
+ ===================================
+ MARK: - Tree Dispatch -
+ ===================================
+ */
+
+TEST_CASE("bench_treeDispatch", "[!benchmark]")
+{
+    auto delegate = BenchManagerDelegate();
+    auto manager = bench_DockManager(delegate);
+    auto views = delegate.getAvailableViews();
+    for (auto i = 0; i < 3; i++)
+        manager.create3By3("Window", views);
+    
+    auto& data = manager.getData();
+    auto deepest = data.getTree().getChild(2);
+    while (deepest.getNumChildren() > 0)
+        deepest = deepest.getChild(deepest.getNumChildren() - 1);
+    auto parentId = data.getUuid(deepest.getParent());
+    
+    /// Calls per operation, with every registration on its own tree and through the dispatcher
+    auto compare = [&](const juce::String& name, std::function<void()> operation)
+    {
+        int perTree = 0;
+        {
+            PerTreeListeners listeners(data.getTree(), manager.getDispatcher());
+            operation();
+            perTree = listeners.calls;
+        }
+        
+        DockCounters::reset();
+        operation();
+        int dispatched = DockCounters::dispatchedCalls;
+        
+        WARN(name << " callbacks: " << perTree << " -> " << dispatched);
+        CHECK(dispatched < perTree);
+    };
+    
+    auto width = 100.0f;
+    compare("resize", [&] {data.setWidth(deepest, width++);});
+    compare("rename", [&] {data.setName(deepest, "Renamed" + juce::String(width++));});
+    compare("addView", [&] {data.addView(parentId, "Added", DockTypes::none);});
+    
+    BENCHMARK("resize dispatched")
+    {
+        data.setWidth(deepest, width++);
+    };
+    
+    PerTreeListeners listeners(data.getTree(), manager.getDispatcher());
+    BENCHMARK("resize with per tree listeners")
+    {
+        data.setWidth(deepest, width++);
+    };
+}
+
+
+
+
+
+/**
+ ===================================
+ MARK: - Drop Zones -
+ ===================================
+ */
+
+TEST_CASE("bench_dropZones", "[!benchmark]")
+{
+    for (auto numRows : {2, 10, 40})
+    {
+        auto delegate = BenchManagerDelegate();
+        auto manager = bench_DockManager(delegate);
+        auto& data = manager.getData();
+        
+        /// Five columns of rows, the drag moves over the last view
+        auto [windowId, rootId] = data.addNewWindow("Window", {0, 0, 2000, 4000});
+        juce::String lastId;
+        for (auto column = 0; column < 5; column++)
+        {
+            lastId = data.dockNewView(rootId, DropLocation::rootRight, "Elements");
+            for (auto row = 1; row < numRows; row++)
+                lastId = data.dockNewView(lastId, DropLocation::viewBottom, "Canvas");
+        }
+        
+        auto component = manager.getDockingComponent(lastId);
+        REQUIRE(component != nullptr);
+        auto numViews = 5 * numRows;
+        auto position = component->getLocalBounds().getCentre();
+        auto draggingId = data.getUuid(data.getTree().getChild(0).getChild(0).getChild(0));
+        
+        BENCHMARK("move live, " + juce::String(numViews).toStdString() + " views")
+        {
+            return manager.getLiveDropZone(component, position, draggingId);
+        };
+        
+        BENCHMARK("build index, " + juce::String(numViews).toStdString() + " views")
+        {
+            manager.buildDropZones(draggingId);
+            return manager.getDropZones().getNumZones();
+        };
+        
+        manager.buildDropZones(draggingId);
+        BENCHMARK("move indexed, " + juce::String(numViews).toStdString() + " views")
+        {
+            return manager.getDropZones().findZone(lastId, position);
+        };
+    }
+}
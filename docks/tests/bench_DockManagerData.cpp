@@ -0,0 +1,418 @@
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+#include "catch2.hpp"
+#include "../source/DockManagerData.h"
+#include "../source/BinaryLayout.h"
+#include "../source/LayoutJournal.h"
+#include <regex>
+
+
+/// Benchmarking class with access to both lookups
+class bench_DockManagerData : public DockManagerData
+{
+public:
+    juce::ValueTree findIndexed(const juce::String& uuid) const {return DockManagerData::findTree(uuid);}
+    juce::ValueTree findRecursive(const juce::String& uuid) {return DockManagerData::findTree(dockProps::uuidProperty, uuid, getTree());}
+    juce::ValueTree findMatchingIndexed(const juce::String& regex) const {return DockManagerData::findTreeMatching(regex);}
+    juce::ValueTree findMatchingRecursive(const juce::String& regex)
+    {
+        auto expr = std::regex(regex.toStdString());
+        return DockManagerData::findTree(getTree(), [expr](const juce::ValueTree& tree)->bool {
+            if (!tree.hasProperty(dockProps::nameProperty)) {return false;}
+            auto name = tree.getProperty(dockProps::nameProperty).toString().toStdString();
+            return std::regex_match(name.begin(), name.end(), expr);
+        });
+    }
+
+    void checkForOrphanedTrees() {DockManagerData::checkForOrphanedTrees();}
+    void setChecksWholeLayout(bool checksWholeLayout) {_checksWholeLayout = checksWholeLayout;}
+
+    static juce::ValueTree readLayout(const juce::MemoryOutputStream& saved)
+    {
+        juce::MemoryInputStream stream(saved.getData(), saved.getDataSize(), false);
+        return DockManagerData::readLayout(stream);
+    }
+
+    /// Adds windows of ten views each, returns every view id
+    juce::StringArray addViews(int numViews)
+    {
+        juce::StringArray ids;
+        juce::String rootId;
+        for (auto i = 0; i < numViews; i++)
+        {
+            if (i % 10 == 0)
+                rootId = addNewWindow("Window" + juce::String(i / 10)).second;
+            ids.add(addView(rootId, "View" + juce::String(i), DockTypes::none));
+        }
+        return ids;
+    }
+
+    /// Every tree in the layout, to check an operation leaves it the size it found it
+    static int countTrees(const juce::ValueTree& tree)
+    {
+        auto count = 1;
+        for (const auto& child : tree)
+            count += countTrees(child);
+        return count;
+    }
+};
+
+
+
+
+/**
+ ===================================
+ MARK: - Find Tree -
+ ===================================
+ Run with: [!benchmark]
+ */
+
+TEST_CASE("bench_findTree", "[!benchmark]")
+{
+    for (auto numViews : {10, 100, 1000})
+    {
+        auto data = bench_DockManagerData();
+        auto ids = data.addViews(numViews);
+        auto last = ids[ids.size() - 1];
+        REQUIRE(data.findIndexed(last) == data.findRecursive(last));
+
+        BENCHMARK("findTree indexed - " + juce::String(numViews).toStdString() + " views")
+        {
+            return data.findIndexed(last);
+        };
+
+        BENCHMARK("findTree recursive - " + juce::String(numViews).toStdString() + " views")
+        {
+            return data.findRecursive(last);
+        };
+    }
+}
+
+
+
+/**
+ ===================================
+ MARK: - Layout Operations -
+ ===================================
+ */
+
+TEST_CASE("bench_layoutOperations", "[!benchmark]")
+{
+    for (auto numViews : {10, 100, 1000})
+    {
+        auto data = bench_DockManagerData();
+        auto ids = data.addViews(numViews);
+        auto first = ids[0];
+        auto moving = ids[numViews - 1];
+        auto neighbour = ids[numViews - 2];
+
+        /// Into the first view's tabs and back beside its neighbour, so the layout is the same each time round
+        auto dockAndBack = [&]
+        {
+            data.dockView(moving, first, DropLocation::tabs, {}, 1);
+            data.dockView(moving, neighbour, DropLocation::viewRight, {});
+        };
+
+        dockAndBack();
+        auto numTrees = bench_DockManagerData::countTrees(data.getTree());
+        dockAndBack();
+        REQUIRE(bench_DockManagerData::countTrees(data.getTree()) == numTrees);
+
+        BENCHMARK("dockView there and back - " + juce::String(numViews).toStdString() + " views")
+        {
+            dockAndBack();
+        };
+
+        /// Added back where it was removed from, so the next run removes the same view
+        auto windowRoot = data.getUuid(data.findIndexed(neighbour).getParent());
+        auto removing = data.addView(windowRoot, "Removing", DockTypes::none);
+        BENCHMARK("removeView and add again - " + juce::String(numViews).toStdString() + " views")
+        {
+            data.removeView(removing);
+            removing = data.addView(windowRoot, "Removing", DockTypes::none);
+        };
+
+        /// Nothing to collapse, only the path down to the one change is walked, or the whole layout as it used to be
+        auto renamed = data.findIndexed(moving);
+        auto name = 0;
+        BENCHMARK("checkForOrphanedTrees after a change - " + juce::String(numViews).toStdString() + " views")
+        {
+            data.setName(renamed, "Renamed" + juce::String(name++));
+            data.checkForOrphanedTrees();
+        };
+
+        data.setChecksWholeLayout(true);
+        BENCHMARK("checkForOrphanedTrees whole layout - " + juce::String(numViews).toStdString() + " views")
+        {
+            data.setName(renamed, "Renamed" + juce::String(name++));
+            data.checkForOrphanedTrees();
+        };
+        data.setChecksWholeLayout(false);
+
+        juce::MemoryOutputStream saved;
+        REQUIRE(data.saveLayout(saved));
+        BENCHMARK("saveLayout - " + juce::String(numViews).toStdString() + " views")
+        {
+            juce::MemoryOutputStream stream;
+            return data.saveLayout(stream);
+        };
+
+        /// Reading and indexing the whole layout again, it isn't reconciled unless asked
+        BENCHMARK("openLayout - " + juce::String(numViews).toStdString() + " views")
+        {
+            juce::MemoryInputStream stream(saved.getData(), saved.getDataSize(), false);
+            return data.openLayout(stream);
+        };
+    }
+}
+
+
+
+/**
+ ===================================
+ MARK: - Find Tree Matching -
+ ===================================
+ */
+
+TEST_CASE("bench_findTreeMatching", "[!benchmark]")
+{
+    for (auto numViews : {10, 100, 1000})
+    {
+        auto data = bench_DockManagerData();
+        auto ids = data.addViews(numViews);
+        auto regex = juce::String("View") + juce::String(numViews - 1);
+        REQUIRE(data.findMatchingIndexed(regex) == data.findMatchingRecursive(regex));
+
+        BENCHMARK("findTreeMatching cached - " + juce::String(numViews).toStdString() + " views")
+        {
+            return data.findMatchingIndexed(regex);
+        };
+
+        BENCHMARK("findTreeMatching uncached - " + juce::String(numViews).toStdString() + " views")
+        {
+            return data.findMatchingRecursive(regex);
+        };
+    }
+}
+
+
+
+
+
+/**
+ ===================================
+ MARK: - Layout Formats -
+ ===================================
+ */
+
+TEST_CASE("bench_layoutFormats", "[!benchmark]")
+{
+    for (auto numViews : {100, 1000, 10000})
+    {
+        auto data = bench_DockManagerData();
+        data.addViews(numViews);
+
+        juce::MemoryOutputStream xml, binary;
+        REQUIRE(data.saveLayout(xml, LayoutFormat::xml));
+        REQUIRE(data.saveLayout(binary, LayoutFormat::binary));
+        WARN(numViews << " views - xml " << (int) xml.getDataSize() << " bytes, binary " << (int) binary.getDataSize() << " bytes");
+
+        REQUIRE(bench_DockManagerData::readLayout(binary).isEquivalentTo(data.getTree()));
+
+        /// Reading alone, opening also rebuilds the index which is the same for both
+        BENCHMARK("read xml - " + juce::String(numViews).toStdString() + " views")
+        {
+            return bench_DockManagerData::readLayout(xml);
+        };
+
+        BENCHMARK("read binary - " + juce::String(numViews).toStdString() + " views")
+        {
+            return bench_DockManagerData::readLayout(binary);
+        };
+
+        BENCHMARK("save xml - " + juce::String(numViews).toStdString() + " views")
+        {
+            juce::MemoryOutputStream stream;
+            return data.saveLayout(stream, LayoutFormat::xml);
+        };
+
+        BENCHMARK("save xml via createXml - " + juce::String(numViews).toStdString() + " views")
+        {
+            juce::MemoryOutputStream stream;
+            data.getTree().createXml()->writeTo(stream);
+            return stream.getDataSize();
+        };
+
+        BENCHMARK("save binary - " + juce::String(numViews).toStdString() + " views")
+        {
+            juce::MemoryOutputStream stream;
+            return data.saveLayout(stream, LayoutFormat::binary);
+        };
+    }
+}
+
+
+
+
+/**
+ ===================================
+ MARK: - Journal -
+ ===================================
+ */
+
+TEST_CASE("bench_journal", "[!benchmark]")
+{
+    auto file = juce::File::getSpecialLocation(juce::File::tempDirectory).getNonexistentChildFile("bench_journal", ".layout");
+    for (auto numViews : {100, 1000, 10000})
+    {
+        auto data = bench_DockManagerData();
+        auto ids = data.addViews(numViews);
+        auto tree = data.findIndexed(ids[numViews / 2]);
+        auto width = 100.0f;
+
+        /// A change costs the same however large the layout, a snapshot grows with it
+        BENCHMARK("resize - " + juce::String(numViews).toStdString() + " views")
+        {
+            data.setWidth(tree, width += 1.0f);
+        };
+
+        {
+            LayoutJournal journal(data, file, 1 << 30);
+            BENCHMARK("resize journaled - " + juce::String(numViews).toStdString() + " views")
+            {
+                data.setWidth(tree, width += 1.0f);
+            };
+        }
+
+        BENCHMARK("resize and save binary - " + juce::String(numViews).toStdString() + " views")
+        {
+            data.setWidth(tree, width += 1.0f);
+            juce::MemoryOutputStream stream;
+            return data.saveLayout(stream, LayoutFormat::binary);
+        };
+    }
+
+    file.deleteFile();
+    LayoutJournal::getJournalFile(file).deleteFile();
+}
+
+
+
+
+/**
+ ===================================
+ MARK: - Layout Hashes -
+ ===================================
+ */
+
+TEST_CASE("bench_layoutHash", "[!benchmark]")
+{
+    for (auto numViews : {100, 1000, 10000})
+    {
+        auto data = bench_DockManagerData();
+        auto ids = data.addViews(numViews);
+        auto tree = data.findIndexed(ids[numViews / 2]);
+        auto width = 100.0f;
+
+        /// Only the trees above a change are hashed again
+        BENCHMARK("layout hash after a resize - " + juce::String(numViews).toStdString() + " views")
+        {
+            data.setWidth(tree, width += 1.0f);
+            return data.getLayoutHash();
+        };
+
+        BENCHMARK("layout hash from scratch - " + juce::String(numViews).toStdString() + " views")
+        {
+            return data.getHash(data.getTree().createCopy());
+        };
+    }
+}
+
+
+
+
+/**
+ ===================================
+ MARK: - Dock Schema -
+ ===================================
+ */
+
+TEST_CASE("bench_propertyReads", "[!benchmark]")
+{
+    auto data = bench_DockManagerData();
+    auto ids = data.addViews(10);
+    auto tree = data.findIndexed(ids[5]);
+    data.setWidth(tree, 200.0f);
+    REQUIRE(dockNode::get<dockSchema::width>(tree) == (float) tree.getProperty(dockProps::widthProperty));
+
+    /// As a layout pass reads a child, by its text ids and by the schema
+    BENCHMARK("read size and type by text ids")
+    {
+        auto width = tree.hasProperty(dockProps::widthProperty) ? (float) tree.getProperty(dockProps::widthProperty) : 0.0f;
+        auto height = tree.hasProperty(dockProps::heightProperty) ? (float) tree.getProperty(dockProps::heightProperty) : 0.0f;
+        auto type = (int) tree.getProperty(dockProps::dockType);
+        return width + height + type;
+    };
+
+    BENCHMARK("read size and type by schema")
+    {
+        auto width = dockNode::get<dockSchema::width>(tree);
+        auto height = dockNode::get<dockSchema::height>(tree);
+        auto type = (int) dockNode::get<dockSchema::dockType>(tree);
+        return width + height + type;
+    };
+}
+
+
+
+
+/**
+ ===================================
+ MARK: - Uuids -
+ ===================================
+ */
+
+TEST_CASE("bench_uuidKeys", "[!benchmark]")
+{
+    for (auto numViews : {100, 1000, 10000})
+    {
+        juce::StringArray texts;
+        juce::Array<DockUuid> uuids;
+        juce::HashMap<juce::String, int> textMap;
+        juce::HashMap<DockUuid, int, DockUuid::HashFunction> uuidMap;
+        for (auto i = 0; i < numViews; i++)
+        {
+            texts.add(juce::Uuid().toString());
+            uuids.add(DockUuid(texts[i]));
+            textMap.set(texts[i], i);
+            uuidMap.set(uuids[i], i);
+        }
+
+        /// A juce::String key shares the tree's text, the 128 bits need none
+        WARN("per key - string " << (int) sizeof(juce::String) << " bytes, uuid " << (int) sizeof(DockUuid) << " bytes");
+
+        BENCHMARK("lookup string keys - " + juce::String(numViews).toStdString() + " views")
+        {
+            auto sum = 0;
+            for (const auto& text : texts)
+                sum += textMap[text];
+            return sum;
+        };
+
+        BENCHMARK("lookup uuid keys - " + juce::String(numViews).toStdString() + " views")
+        {
+            auto sum = 0;
+            for (const auto& uuid : uuids)
+                sum += uuidMap[uuid];
+            return sum;
+        };
+
+        /// As most lookups are, from the text a tree keeps
+        BENCHMARK("lookup uuid keys from text - " + juce::String(numViews).toStdString() + " views")
+        {
+            auto sum = 0;
+            for (const auto& text : texts)
+                sum += uuidMap[DockUuid(text)];
+            return sum;
+        };
+    }
+}
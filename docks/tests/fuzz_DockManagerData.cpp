@@ -0,0 +1,218 @@
+#include "catch2.hpp"
+#include "../source/DockManagerData.h"
+
+
+/// Fuzzing class, applies seeded random operations the way a user would and checks the layout after each
+class fuzz_DockManagerData : public DockManagerData
+{
+public:
+    fuzz_DockManagerData(juce::int64 seed) : _random(seed) {}
+
+    /// Applies one operation, returns what it was
+    const juce::String applyRandomOperation()
+    {
+        auto views = getTrees([this](const juce::ValueTree& tree) {return isView(tree);});
+        if (views.isEmpty())
+        {
+            auto rootId = addNewWindow("Window").second;
+            dockNewView(rootId, DropLocation::rootLeft, getNextName());
+            return "addNewWindow";
+        }
+
+        auto view = views[_random.nextInt(views.size())];
+        auto other = views[_random.nextInt(views.size())];
+        auto location = (DropLocation) _random.nextInt((int) DropLocation::none);
+        switch (_random.nextInt(6))
+        {
+            case 0:
+            {
+                /// Where a drop on the other view lands, as the components ask for it, and never inside itself
+                auto target = DockManagerData::findTree(getTreeForDockLocation(getUuid(other), location).first);
+                if (!target.isValid() || target == view || target.isAChildOf(view)) {return "dockView (skipped)";}
+                dockView(getUuid(view), getUuid(target), location, getRandomPoint());
+                return "dockView " + dropLocationToString(location);
+            }
+
+            case 1:
+                dockNewView(getUuid(other), location, getNextName());
+                return "dockNewView " + dropLocationToString(location);
+
+            case 2:
+                removeView(getUuid(view));
+                return "removeView";
+
+            case 3:
+                openInNewWindow(getUuid(view), getRandomPoint(), {0, 0, 400, 300});
+                return "openInNewWindow";
+
+            case 4:
+            {
+                auto tabs = getTrees([this](const juce::ValueTree& tree) {return getDockType(tree) == DockTypes::tabs && tree.getNumChildren() > 0;});
+                if (tabs.isEmpty()) {return "setSelected (skipped)";}
+                auto tree = tabs[_random.nextInt(tabs.size())];
+                setSelected(tree, getUuid(tree.getChild(_random.nextInt(tree.getNumChildren()))));
+                return "setSelected";
+            }
+
+            default:
+                setSize(view, {100.0f + _random.nextFloat() * 500.0f, 100.0f + _random.nextFloat() * 500.0f});
+                return "setSize";
+        }
+    }
+
+    /// The first invariant the layout breaks, empty if it keeps them all
+    const juce::String checkInvariants()
+    {
+        juce::StringArray uuids;
+        for (const auto& tree : getTrees([](const juce::ValueTree&) {return true;}))
+        {
+            auto uuid = getUuid(tree);
+            auto type = getDockType(tree);
+            if (uuid.isEmpty() || uuids.contains(uuid))
+                return "uuid missing or repeated: " + uuid;
+            uuids.add(uuid);
+
+            if (DockManagerData::findTree(uuid) != tree)
+                return "not indexed: " + uuid;
+
+            if (isWindow(tree) && (tree.getNumChildren() == 0 || tree.getChild(0).getNumChildren() == 0))
+                return "empty window: " + uuid;
+
+            if (!isWindow(tree) && !isRootTree(tree) && type != DockTypes::none && getName(tree).isEmpty() && tree.getNumChildren() == 1)
+                return "split or tabs with a single child: " + uuid;
+
+            if (type == DockTypes::tabs && tree.getNumChildren() == 0)
+                return "empty tabs: " + uuid;
+
+            if (type == DockTypes::tabs && !tree.getChildWithProperty(dockProps::uuidProperty, getSelectedId(tree)).isValid())
+                return "selected tab isn't one of its tabs: " + uuid;
+        }
+
+        return {};
+    }
+
+    /// The layout without its uuids, which differ from run to run, and with selected tabs by index
+    const juce::String getComparableLayout()
+    {
+        std::function<juce::ValueTree(const juce::ValueTree&)> copy = [&](const juce::ValueTree& tree)
+        {
+            auto comparable = juce::ValueTree(tree.getType());
+            comparable.copyPropertiesFrom(tree, nullptr);
+            comparable.removeProperty(dockProps::uuidProperty, nullptr);
+            if (tree.hasProperty(dockProps::selectedProperty))
+                comparable.setProperty(dockProps::selectedProperty, tree.indexOf(tree.getChildWithProperty(dockProps::uuidProperty, getSelectedId(tree))), nullptr);
+            for (const auto& child : tree)
+                comparable.appendChild(copy(child), nullptr);
+            return comparable;
+        };
+        return copy(getTree()).toXmlString();
+    }
+
+    void setChecksWholeLayout(bool checksWholeLayout) {_checksWholeLayout = checksWholeLayout;}
+    void setWalksSmallLayouts(bool walksSmallLayouts) {_walksSmallLayouts = walksSmallLayouts;}
+
+private:
+
+    const juce::Array<juce::ValueTree> getTrees(std::function<bool(const juce::ValueTree&)> matches)
+    {
+        juce::Array<juce::ValueTree> trees;
+        std::function<void(const juce::ValueTree&)> addTrees = [&](const juce::ValueTree& tree)
+        {
+            for (const auto& child : tree)
+            {
+                if (matches(child))
+                    trees.add(child);
+                addTrees(child);
+            }
+        };
+        addTrees(getTree());
+        return trees;
+    }
+
+    const juce::String getNextName() {return "View" + juce::String(_numNames++);}
+    juce::Point<float> getRandomPoint() {return {_random.nextFloat() * 1000.0f, _random.nextFloat() * 1000.0f};}
+
+    juce::Random _random;
+    int _numNames = 0;
+};
+
+
+/// Runs a seed's operations, checking the layout after each
+struct FuzzRun
+{
+    int numOperations = 0;
+    double seconds = 0;
+    double slowestSeconds = 0;
+    juce::String slowestOperation;
+};
+
+
+FuzzRun fuzz_runSeed(juce::int64 seed, int numOperations)
+{
+    FuzzRun run;
+    auto data = fuzz_DockManagerData(seed);
+    for (auto i = 0; i < numOperations; i++)
+    {
+        auto start = juce::Time::getHighResolutionTicks();
+        auto operation = data.applyRandomOperation();
+        auto seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+
+        run.numOperations++;
+        run.seconds += seconds;
+        if (seconds > run.slowestSeconds)
+        {
+            run.slowestSeconds = seconds;
+            run.slowestOperation = operation + " (step " + juce::String(i) + ")";
+        }
+
+        INFO("seed " << seed << ", step " << i << ", " << operation);
+        REQUIRE(data.checkInvariants() == "");
+    }
+    return run;
+}
+
+
+
+
+/**
+ ===================================
+ MARK: - Fuzzing -
+ ===================================
+ A failure names its seed and step, pass the seed to --rng-seed to run it alone: [fuzz]
+ */
+
+TEST_CASE("fuzz_layoutInvariants")
+{
+    for (auto seed = 1; seed <= 20; seed++)
+        fuzz_runSeed(seed, 200);
+}
+
+
+TEST_CASE("fuzz_orphanChecksMatchWholeLayout")
+{
+    /// Only down the paths to what changed, or the whole layout each time, the layouts come out the same
+    for (auto seed = 1; seed <= 20; seed++)
+    {
+        auto data = fuzz_DockManagerData(seed);
+        auto wholeLayout = fuzz_DockManagerData(seed);
+        data.setWalksSmallLayouts(false);
+        wholeLayout.setChecksWholeLayout(true);
+        for (auto i = 0; i < 300; i++)
+        {
+            auto operation = data.applyRandomOperation();
+            CHECK(wholeLayout.applyRandomOperation() == operation);
+
+            INFO("seed " << seed << ", step " << i << ", " << operation);
+            REQUIRE(data.getComparableLayout() == wholeLayout.getComparableLayout());
+        }
+    }
+}
+
+
+TEST_CASE("fuzz_layoutThroughput", "[.][fuzz]")
+{
+    auto seed = Catch::rngSeed() != 0 ? (juce::int64) Catch::rngSeed() : 1;
+    auto run = fuzz_runSeed(seed, 20000);
+    WARN("seed " << seed << ": " << run.numOperations << " operations, " << juce::roundToInt(run.numOperations / run.seconds) << " per second, slowest "
+         << run.slowestOperation << " at " << run.slowestSeconds * 1000.0 << " ms");
+}
@@ -0,0 +1,201 @@
+#include "catch2.hpp"
+#include "../source/DockManagerData.h"
+#include "../source/XmlLayout.h"
+#include <cstdlib>
+#include <new>
+
+
+/**
+ -------------------------------------------------------------
+ ===================================
+ MARK: - Allocation Counting -
+ ===================================
+ -------------------------------------------------------------
+ Replaces the global operator new and delete, every form of them, so this file is only built into
+ the Tests app. Nothing is counted unless a test_AllocationCounter is alive on the allocating thread
+ */
+
+struct test_AllocationCounter
+{
+    test_AllocationCounter() : _previous(current) {current = this;}
+    ~test_AllocationCounter() {current = _previous;}
+
+    int numAllocations = 0;
+    static thread_local test_AllocationCounter* current;
+
+private:
+    test_AllocationCounter* _previous;
+    JUCE_DECLARE_NON_COPYABLE(test_AllocationCounter)
+};
+
+thread_local test_AllocationCounter* test_AllocationCounter::current = nullptr;
+
+
+static void* test_allocate(std::size_t size, std::size_t alignment = 0)
+{
+    if (auto counter = test_AllocationCounter::current)
+        counter->numAllocations++;
+
+    size = size > 0 ? size : 1;
+    if (alignment <= alignof(std::max_align_t))
+        return std::malloc(size);
+
+   #if JUCE_WINDOWS
+    return _aligned_malloc(size, alignment);
+   #else
+    /// aligned_alloc wants a multiple of the alignment
+    return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+   #endif
+}
+
+
+static void test_free(void* memory, std::size_t alignment = 0) noexcept
+{
+   #if JUCE_WINDOWS
+    if (alignment > alignof(std::max_align_t))
+    {
+        _aligned_free(memory);
+        return;
+    }
+   #endif
+    juce::ignoreUnused(alignment);
+    std::free(memory);
+}
+
+
+static void* test_allocateOrThrow(std::size_t size, std::size_t alignment = 0)
+{
+    if (auto memory = test_allocate(size, alignment))
+        return memory;
+    throw std::bad_alloc();
+}
+
+
+void* operator new(std::size_t size) {return test_allocateOrThrow(size);}
+void* operator new[](std::size_t size) {return test_allocateOrThrow(size);}
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {return test_allocate(size);}
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {return test_allocate(size);}
+void* operator new(std::size_t size, std::align_val_t alignment) {return test_allocateOrThrow(size, (std::size_t) alignment);}
+void* operator new[](std::size_t size, std::align_val_t alignment) {return test_allocateOrThrow(size, (std::size_t) alignment);}
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {return test_allocate(size, (std::size_t) alignment);}
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {return test_allocate(size, (std::size_t) alignment);}
+
+void operator delete(void* memory) noexcept {test_free(memory);}
+void operator delete[](void* memory) noexcept {test_free(memory);}
+void operator delete(void* memory, std::size_t) noexcept {test_free(memory);}
+void operator delete[](void* memory, std::size_t) noexcept {test_free(memory);}
+void operator delete(void* memory, const std::nothrow_t&) noexcept {test_free(memory);}
+void operator delete[](void* memory, const std::nothrow_t&) noexcept {test_free(memory);}
+void operator delete(void* memory, std::align_val_t alignment) noexcept {test_free(memory, (std::size_t) alignment);}
+void operator delete[](void* memory, std::align_val_t alignment) noexcept {test_free(memory, (std::size_t) alignment);}
+void operator delete(void* memory, std::size_t, std::align_val_t alignment) noexcept {test_free(memory, (std::size_t) alignment);}
+void operator delete[](void* memory, std::size_t, std::align_val_t alignment) noexcept {test_free(memory, (std::size_t) alignment);}
+void operator delete(void* memory, std::align_val_t alignment, const std::nothrow_t&) noexcept {test_free(memory, (std::size_t) alignment);}
+void operator delete[](void* memory, std::align_val_t alignment, const std::nothrow_t&) noexcept {test_free(memory, (std::size_t) alignment);}
+
+
+
+
+
+/**
+ ===================================
+ MARK: - Counting -
+ ===================================
+ */
+
+TEST_CASE("allocations_countEveryForm")
+{
+    struct alignas(64) Aligned {char bytes[64];};
+
+    /// Kept somewhere the optimiser can't see through, or it may leave out a new and delete pair
+    static void* volatile kept;
+    auto keep = [](auto* memory) {kept = memory; return memory;};
+
+    /// Counts are read before checking them, as checking allocates too
+    int numAllocations, numInner, numOuter;
+    {
+        test_AllocationCounter counter;
+        delete keep(new int(1));
+        delete[] keep(new int[4]);
+        delete keep(new Aligned());
+        delete[] keep(new Aligned[2]);
+        ::operator delete(keep(::operator new(8, std::nothrow)));
+        numAllocations = counter.numAllocations;
+
+        /// Only the innermost counter on this thread
+        {
+            test_AllocationCounter inner;
+            delete keep(new int(2));
+            numInner = inner.numAllocations;
+        }
+        numOuter = counter.numAllocations;
+    }
+
+    CHECK(numAllocations == 5);
+    CHECK(numInner == 1);
+    CHECK(numOuter == 5);
+
+    /// And nothing once none is alive
+    delete keep(new int(3));
+    CHECK(test_AllocationCounter::current == nullptr);
+}
+
+
+
+
+
+/**
+ ===================================
+ MARK: - Layout Formats -
+ ===================================
+ */
+
+struct test_AllocationsData : public DockManagerData
+{
+    using DockManagerData::findTree;
+};
+
+
+TEST_CASE("layoutFormat_xmlAllocations")
+{
+    /// Names which need escaping, and enough properties to wrap the attributes onto new lines
+    test_AllocationsData data;
+    auto random = juce::Random(7);
+    const char* names[] = {"Plain", "A & B", "<Tag>", "\"Quoted\"", "Line\nBreak", "Caf\xc3\xa9", ""};
+    auto [windowId, rootId] = data.addNewWindow("Window & <1>");
+    auto parents = juce::StringArray(rootId);
+    for (auto i = 0; i < 500; i++)
+    {
+        auto type = random.nextInt(4) == 0 ? DockTypes::tabs : DockTypes::none;
+        auto name = juce::String::fromUTF8(names[random.nextInt(juce::numElementsInArray(names))]) + juce::String(i);
+        auto view = data.addView(parents[random.nextInt(parents.size())], name, type);
+        if (type == DockTypes::tabs)
+            parents.add(view);
+
+        auto tree = data.findTree(view);
+        if (random.nextBool())
+            tree.setProperty("count", random.nextInt() - random.nextInt(), nullptr);
+        if (random.nextBool())
+            tree.setProperty("flag", random.nextBool(), nullptr);
+        if (random.nextInt(4) == 0)
+            tree.setProperty("aVeryLongPropertyNameToWrapTheLine", juce::String::repeatedString("x", random.nextInt(80)), nullptr);
+    }
+
+    /// Both write into memory which is already there, so only the writing itself allocates
+    juce::MemoryOutputStream viaXml(1 << 20), streamed(1 << 20);
+    int viaXmlAllocations, streamedAllocations;
+    {
+        test_AllocationCounter counter;
+        data.getTree().createXml()->writeTo(viaXml);
+        viaXmlAllocations = counter.numAllocations;
+    }
+    {
+        test_AllocationCounter counter;
+        REQUIRE(XmlLayout::write(data.getTree(), streamed));
+        streamedAllocations = counter.numAllocations;
+    }
+
+    WARN("createXml " << viaXmlAllocations << " allocations, streamed " << streamedAllocations);
+    CHECK(streamed.getDataSize() == viaXml.getDataSize());
+    CHECK(streamedAllocations * 4 < viaXmlAllocations);
+}
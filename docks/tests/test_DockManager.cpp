@@ -1,6 +1,10 @@
 
 #include "catch2.hpp"
 #include "../source/DockManager.h"
+#include "../source/SuspendingViewComponent.h"
+#include "../source/BinaryLayout.h"
+#include "../source/LayoutJournal.h"
+#include "../source/LayoutAutosaver.h"
 
 /// Mock Delegate
 class TestManagerDelegate : public DockManager::Delegate
@@ -12,12 +16,105 @@ public:
 };
 
 
+/// Mock Delegate which builds real views, and remembers which
+class ViewCountingDelegate : public TestManagerDelegate
+{
+public:
+    std::shared_ptr<juce::Component> createView(const juce::String &nameOfViewToCreate) override
+    {
+        /// Containers get asked too, only the views in tabs count here
+        if (!nameOfViewToCreate.startsWith("View")) {return nullptr;}
+        created.add(nameOfViewToCreate);
+        return std::make_shared<juce::Component>();
+    }
+    juce::StringArray created;
+};
+
+
+/// Mock Delegate which wraps its views, and follows the tab strip
+class VisibilityDelegate : public TestManagerDelegate
+{
+public:
+    std::shared_ptr<juce::Component> createView(const juce::String &nameOfViewToCreate) override
+    {
+        if (!nameOfViewToCreate.startsWith("View")) {return nullptr;}
+        auto view = std::make_shared<SuspendingViewComponent>(std::make_unique<juce::Component>());
+        view->onSuspend = [this] {numSuspended++;};
+        views.set(nameOfViewToCreate, view.get());
+        return view;
+    }
+    void viewVisibilityChanged(const juce::String& nameOfView, juce::Component& view, ViewVisibility visibility) override
+    {
+        SuspendingViewComponent::viewVisibilityChanged(view, visibility);
+    }
+    void tabStripVisibilityChanged(const juce::String& nameOfView, bool isInTabStrip) override
+    {
+        numTabStripChanges++;
+        if (isInTabStrip)
+            outOfTabStrip.removeString(nameOfView);
+        else
+            outOfTabStrip.add(nameOfView);
+    }
+    juce::HashMap<juce::String, SuspendingViewComponent*> views;
+    juce::StringArray outOfTabStrip;
+    int numTabStripChanges = 0;
+    int numSuspended = 0;
+};
+
+
+/// Any tree in the layout, the data's own search is protected
+juce::ValueTree findTree(DockManagerData& data, const juce::String& uuid)
+{
+    std::function<juce::ValueTree(const juce::ValueTree&)> search = [&](const juce::ValueTree& tree) {
+        if (data.getUuid(tree) == uuid) {return tree;}
+        for (auto child : tree)
+            if (auto found = search(child); found.isValid())
+                return found;
+        return juce::ValueTree();
+    };
+    return search(data.getTree());
+}
+
+
 /// Testing class with access to DockManager internals
 class test_DockManager : public DockManager
 {
 public:
     test_DockManager(DockManager::Delegate& delegate) : DockManager(delegate) {}
     void printTree() {DockManager::printTree();}
+    DockManagerData& getData() {return _data;}
+    DockingComponent* getDockingComponent(const juce::String& uuid) {return _dockingComponents[uuid].lock().get();}
+    void dragResizer(DockingComponent* component, juce::Point<float> delta, int index) {component->resizerDidDrag(delta, index);}
+    void releaseResizer(DockingComponent* component) {component->resizerMouseUp();}
+    juce::Component* getView(DockingComponent* component) {return component->_view.get();}
+    const bool prewarmNextView() {return DockManager::prewarmNextView();}
+    void updateViewVisibility(const juce::ValueTree& tree) {DockManager::updateViewVisibility(tree);}
+    juce::StringArray getTabIds(DockingComponent* component)
+    {
+        juce::StringArray ids;
+        for (auto tab : component->_header->_tabs)
+            ids.add(tab->getUuid());
+        return ids;
+    }
+    WindowComponent* getWindowComponent(DockingComponent* component) {return component->findParentComponentOfClass<WindowComponent>();}
+    juce::Component* getHeader(DockingComponent* component) {return component->_header.get();}
+    const juce::Array<std::shared_ptr<juce::Component>>& getResizerBars(DockingComponent* component) {return component->_resizerBars;}
+    void buildDropZones(const juce::String& draggingId) {DockManager::buildDropZones(draggingId);}
+    const DropZoneIndex& getDropZones() const {return _dropZones;}
+    DropZoneIndex::Zone getLiveDropZone(DockingComponent* component, juce::Point<int> position, const juce::String& draggingId)
+    {
+        return component->getDropZone(component->getDragLocation(position), draggingId);
+    }
+    TabComponent* getTab(DockingComponent* component, int index) {return component->_header->_tabs[index];}
+    const bool isInTabStrip(DockingComponent* component, juce::Component* tab) {return component->_header->_tabHousing->getIndexOfChildComponent(tab) >= 0;}
+    void startTabDrag(DockingComponent* component, TabComponent* tab) {component->_header->dragOperationStarted({{}, tab, {}});}
+    void endTabDrag(DockingComponent* component, TabComponent* tab) {component->_header->dragOperationEnded({{}, tab, {}});}
+    void scrollToTab(DockingComponent* component, int index) {component->_header->_tabViewport->setViewPosition(component->_header->getTabX(index), 0);}
+    juce::PopupMenu getOverflowMenu(DockingComponent* component) {return component->_header->getOverflowMenu();}
+    void selectTabFromOverflow(DockingComponent* component, const juce::String& uuid) {component->_header->selectTabFromOverflow(uuid);}
+    const int getNumAutosaves() const {return _autosaver->getNumSaves();}
+    const int getNumListeners(const juce::ValueTree& tree) const {return _dispatcher.getNumListeners(tree);}
+    const int getNumTransactionListeners(const juce::ValueTree& tree) const {return _dispatcher.getNumTransactionListeners(tree);}
 
 };
 
@@ -70,6 +167,851 @@ TEST_CASE("closeAllWindows")
 }
 
 
+/**
+ ===================================
+ MARK: - Docking -
+ ===================================
+ */
+
+TEST_CASE("dockView_keepsMovedComponents")
+{
+    auto delegate = TestManagerDelegate();
+    auto manager = test_DockManager(delegate);
+    auto& data = manager.getData();
+    
+    /// A tab group of five views next to a view, and a second window
+    auto [windowId, rootId] = data.addNewWindow("Window1");
+    auto split = data.addView(rootId, "", DockTypes::horizontal);
+    data.addView(split, "Elements", DockTypes::none);
+    auto group = data.addView(split, "Group", DockTypes::tabs);
+    juce::StringArray groupIds {group};
+    for (auto i = 0; i < 5; i++)
+        groupIds.add(data.addView(group, "View" + juce::String(i), DockTypes::none));
+    auto [otherWindowId, otherRootId] = data.addNewWindow("Window2");
+    auto canvas = data.addView(otherRootId, "Canvas", DockTypes::none);
+    
+    juce::Array<DockingComponent*> components;
+    for (const auto& id : groupIds)
+        components.add(manager.getDockingComponent(id));
+    CHECK_FALSE(components.contains(nullptr));
+    
+    /// Only the new split is built, the group comes along as it is
+    DockCounters::reset();
+    data.dockView(group, canvas, DropLocation::viewRight, {}, 0);
+    CHECK(DockCounters::dockingComponents <= 1);
+    for (auto i = 0; i < groupIds.size(); i++)
+        CHECK(manager.getDockingComponent(groupIds[i]) == components[i]);
+    
+    auto movedGroup = manager.getDockingComponent(group);
+    REQUIRE(movedGroup != nullptr);
+    CHECK(movedGroup->getTree().getParent() == manager.getDockingComponent(canvas)->getTree().getParent());
+    CHECK(movedGroup->getParentComponent() == manager.getDockingComponent(data.getUuid(movedGroup->getTree().getParent())));
+}
+
+
+TEST_CASE("removeView_dropsComponents")
+{
+    auto delegate = TestManagerDelegate();
+    auto manager = test_DockManager(delegate);
+    auto& data = manager.getData();
+    
+    auto [windowId, rootId] = data.addNewWindow("Window1");
+    auto split = data.addView(rootId, "", DockTypes::horizontal);
+    data.addView(split, "Elements", DockTypes::none);
+    auto canvas = data.addView(split, "Canvas", DockTypes::none);
+    CHECK(manager.getDockingComponent(canvas) != nullptr);
+    
+    /// Removed trees are not held on to
+    data.removeView(canvas);
+    CHECK(manager.getDockingComponent(canvas) == nullptr);
+}
+
+
+TEST_CASE("dispatcher_followsUuidChanges")
+{
+    auto delegate = TestManagerDelegate();
+    auto manager = test_DockManager(delegate);
+    auto& data = manager.getData();
+    
+    auto [windowId, rootId] = data.addNewWindow("Window1");
+    auto split = data.addView(rootId, "", DockTypes::horizontal);
+    data.addView(split, "Elements", DockTypes::none);
+    auto canvas = data.addView(split, "Canvas", DockTypes::none);
+    auto canvasTree = findTree(data, canvas);
+    auto component = manager.getDockingComponent(canvas);
+    REQUIRE(component != nullptr);
+    auto numListeners = manager.getNumListeners(canvasTree);
+    CHECK(numListeners > 0);
+    
+    /// The component keeps hearing about its tree under the new uuid
+    canvasTree.setProperty(dockProps::uuidProperty, "renamedCanvas", nullptr);
+    CHECK(manager.getNumListeners(canvasTree) == numListeners);
+    DockCounters::reset();
+    data.setWidth(canvasTree, 123.0f);
+    CHECK(DockCounters::dispatchedCalls == numListeners);
+    
+    /// Destroying it leaves nothing registered, even once the uuid comes back
+    data.removeView("renamedCanvas");
+    CHECK(manager.getNumListeners(canvasTree) == 0);
+    canvasTree.setProperty(dockProps::uuidProperty, canvas, nullptr);
+    CHECK(manager.getNumListeners(canvasTree) == 0);
+}
+
+
+TEST_CASE("dispatcher_routesCommitsPerTree")
+{
+    auto delegate = TestManagerDelegate();
+    auto manager = test_DockManager(delegate);
+    auto& data = manager.getData();
+    
+    auto [windowId, rootId] = data.addNewWindow("Window1");
+    auto split = data.addView(rootId, "", DockTypes::horizontal);
+    juce::StringArray views;
+    for (auto i = 0; i < 50; i++)
+        views.add(data.addView(split, "View" + juce::String(i), DockTypes::none));
+    auto first = findTree(data, views[0]);
+    auto second = findTree(data, views[1]);
+    CHECK(manager.getNumTransactionListeners(first) > 0);
+    
+    /// A commit reaches the components of the trees it touched, not every component
+    DockCounters::reset();
+    {
+        DockManagerData::ScopedTransaction transaction(data);
+        first.setProperty(dockProps::nameProperty, "First", nullptr);
+        second.setProperty(dockProps::nameProperty, "Second", nullptr);
+        first.setProperty(dockProps::nameProperty, "Renamed", nullptr);
+    }
+    CHECK(DockCounters::dispatchedCalls == manager.getNumTransactionListeners(first) + manager.getNumTransactionListeners(second));
+    CHECK(manager.getDockingComponent(views[0])->getName() == "Renamed");
+    CHECK(manager.getDockingComponent(views[1])->getName() == "Second");
+    
+    /// Destroyed components are no longer registered
+    data.removeView(views[0]);
+    CHECK(manager.getNumTransactionListeners(first) == 0);
+}
+
+
+TEST_CASE("dropZones_matchLiveHitTest")
+{
+    auto delegate = TestManagerDelegate();
+    auto manager = test_DockManager(delegate);
+    auto& data = manager.getData();
+    
+    /// Columns of rows, with a tab group in the middle
+    auto [windowId, rootId] = data.addNewWindow("Window1", {0, 0, 900, 700});
+    juce::StringArray ids;
+    for (auto column = 0; column < 3; column++)
+    {
+        auto id = data.dockNewView(rootId, DropLocation::rootRight, "Column" + juce::String(column));
+        ids.add(id);
+        for (auto row = 0; row < 2; row++)
+            ids.add(id = data.dockNewView(id, DropLocation::viewBottom, "Row" + juce::String(row)));
+    }
+    auto group = data.addView(ids[4], "Group", DockTypes::tabs);
+    for (auto i = 0; i < 3; i++)
+        ids.add(data.addView(group, "View" + juce::String(i), DockTypes::none));
+    
+    /// Dragging one of the views, so some zones hide the handle
+    auto draggingId = ids[2];
+    manager.buildDropZones(draggingId);
+    const auto& zones = manager.getDropZones();
+    REQUIRE_FALSE(zones.isEmpty());
+    
+    auto numChecked = 0;
+    for (auto child : data.getTree().getChild(0))
+    {
+        std::function<void(const juce::ValueTree&)> check = [&](const juce::ValueTree& tree) {
+            for (auto subtree : tree)
+                check(subtree);
+            
+            auto component = manager.getDockingComponent(data.getUuid(tree));
+            if (component == nullptr || component->getBounds().isEmpty()) {return;}
+            for (auto x = -5; x < component->getWidth() + 5; x += 11)
+            {
+                for (auto y = -5; y < component->getHeight() + 5; y += 11)
+                {
+                    auto indexed = zones.findZone(component->getUuid(), {x, y});
+                    REQUIRE(indexed != nullptr);
+                    auto live = manager.getLiveDropZone(component, {x, y}, draggingId);
+                    INFO(component->getName() << " at " << x << ", " << y);
+                    CHECK(indexed->location == live.location);
+                    CHECK(indexed->treeToDropAt == live.treeToDropAt);
+                    CHECK(indexed->index == live.index);
+                    CHECK(indexed->showsHandle == live.showsHandle);
+                    CHECK(indexed->handleBounds == live.handleBounds);
+                    numChecked++;
+                }
+            }
+        };
+        check(child);
+    }
+    CHECK(numChecked > 0);
+    
+    /// Anything that changes the layout drops the index, and moves go back to the live path
+    data.addView(group, "Late", DockTypes::none);
+    CHECK(zones.isEmpty());
+}
+
+
+
+
+
+/**
+ ===================================
+ MARK: - Resizing -
+ ===================================
+ */
+
+TEST_CASE("resizerDidDrag_writesOnMouseUp")
+{
+    auto delegate = TestManagerDelegate();
+    auto manager = test_DockManager(delegate);
+    auto& data = manager.getData();
+    
+    auto [windowId, rootId] = data.addNewWindow("Window1");
+    auto split = data.addView(rootId, "", DockTypes::horizontal);
+    auto left = manager.getDockingComponent(data.addView(split, "Elements", DockTypes::none));
+    auto middle = manager.getDockingComponent(data.addView(split, "Canvas", DockTypes::none));
+    auto right = manager.getDockingComponent(data.addView(split, "Cues", DockTypes::none));
+    auto splitComponent = manager.getDockingComponent(split);
+    REQUIRE(splitComponent != nullptr);
+    auto leftWidth = left->getWidth();
+    
+    /// The split follows the drag, but nothing reaches the tree
+    DockCounters::reset();
+    manager.dragResizer(splitComponent, {20, 0}, 0);
+    manager.dragResizer(splitComponent, {10, 0}, 0);
+    CHECK(DockCounters::dispatchedCalls == 0);
+    CHECK_FALSE(left->getTree().hasProperty(dockProps::widthProperty));
+    CHECK(left->getWidth() == leftWidth + 30);
+    auto liveBounds = std::make_tuple(left->getBounds(), middle->getBounds(), right->getBounds());
+    
+    /// Released, the sizes are written once and the layout stays where it was dragged to
+    manager.releaseResizer(splitComponent);
+    CHECK(data.getWidth(left->getTree()) == leftWidth + 30);
+    CHECK(left->getTree().hasProperty(dockProps::widthProperty));
+    CHECK(middle->getTree().hasProperty(dockProps::widthProperty));
+    CHECK(std::make_tuple(left->getBounds(), middle->getBounds(), right->getBounds()) == liveBounds);
+    
+    /// With nothing else sharing the slack, only the two either side of the bar are laid out
+    auto rightTree = right->getTree();
+    data.setWidth(rightTree, (float) right->getWidth());
+    auto rightBounds = right->getBounds();
+    DockCounters::reset();
+    manager.dragResizer(splitComponent, {-15, 0}, 0);
+    manager.dragResizer(splitComponent, {-5, 0}, 0);
+    CHECK(DockCounters::layoutPasses == 4);
+    CHECK(left->getWidth() == leftWidth + 10);
+    CHECK(middle->getX() == left->getRight() + manager.getResizerBars(splitComponent)[0]->getWidth());
+    CHECK(middle->getRight() == manager.getResizerBars(splitComponent)[1]->getX());
+    CHECK(right->getBounds() == rightBounds);
+    
+    /// And the whole layout agrees once released
+    liveBounds = std::make_tuple(left->getBounds(), middle->getBounds(), right->getBounds());
+    manager.releaseResizer(splitComponent);
+    CHECK(std::make_tuple(left->getBounds(), middle->getBounds(), right->getBounds()) == liveBounds);
+}
+
+
+TEST_CASE("resizerDidDrag_childChangesCancel")
+{
+    auto delegate = TestManagerDelegate();
+    auto manager = test_DockManager(delegate);
+    auto& data = manager.getData();
+    
+    auto [windowId, rootId] = data.addNewWindow("Window1");
+    auto split = data.addView(rootId, "", DockTypes::horizontal);
+    auto left = manager.getDockingComponent(data.addView(split, "Elements", DockTypes::none));
+    auto right = manager.getDockingComponent(data.addView(split, "Canvas", DockTypes::none));
+    auto splitComponent = manager.getDockingComponent(split);
+    REQUIRE(splitComponent != nullptr);
+    
+    /// A child added under the drag ends it, so nothing is written
+    manager.dragResizer(splitComponent, {20, 0}, 0);
+    auto cues = data.addView(split, "Cues", DockTypes::none);
+    manager.releaseResizer(splitComponent);
+    CHECK_FALSE(left->getTree().hasProperty(dockProps::widthProperty));
+    CHECK_FALSE(right->getTree().hasProperty(dockProps::widthProperty));
+    
+    /// And the next drag starts again from what's laid out
+    auto leftWidth = left->getWidth();
+    manager.dragResizer(splitComponent, {10, 0}, 0);
+    manager.releaseResizer(splitComponent);
+    CHECK(data.getWidth(left->getTree()) == leftWidth + 10);
+    
+    /// Removed in a transaction too
+    manager.dragResizer(splitComponent, {10, 0}, 0);
+    {
+        DockManagerData::ScopedTransaction transaction(data);
+        data.removeView(cues);
+    }
+    manager.releaseResizer(splitComponent);
+    CHECK(data.getWidth(left->getTree()) == leftWidth + 10);
+}
+
+
+
+
+
+/**
+ ===================================
+ MARK: - Layout Solver -
+ ===================================
+ */
+
+TEST_CASE("layoutSolver_matchesComponents")
+{
+    auto random = juce::Random(2024);
+    for (auto run = 0; run < 20; run++)
+    {
+        auto delegate = ViewCountingDelegate();
+        auto manager = test_DockManager(delegate);
+        auto& data = manager.getData();
+        
+        /// A random layout, with some of the splits sized
+        auto [windowId, rootId] = data.addNewWindow("Window1", {0, 0, (float) (600 + random.nextInt(800)), (float) (400 + random.nextInt(600))});
+        juce::StringArray ids {data.dockNewView(rootId, DropLocation::rootRight, "View0")};
+        const DropLocation locations[] = {DropLocation::viewRight, DropLocation::viewBottom, DropLocation::tabs, DropLocation::rootLeft};
+        for (auto i = 1; i < 12; i++)
+            ids.add(data.dockNewView(ids[random.nextInt(ids.size())], locations[random.nextInt(4)], "View" + juce::String(i)));
+        
+        for (auto id : ids)
+        {
+            auto tree = findTree(data, id);
+            if (random.nextBool())
+                data.setWidth(tree, 50.0f + random.nextFloat() * 200.0f);
+            if (random.nextBool())
+                data.setHeight(tree, 50.0f + random.nextFloat() * 200.0f);
+        }
+        
+        auto anyComponent = manager.getDockingComponent(ids[0]);
+        REQUIRE(anyComponent != nullptr);
+        auto window = manager.getWindowComponent(anyComponent);
+        REQUIRE(window != nullptr);
+        auto root = window->getChildComponent(0);
+        for (auto i = 0; i < window->getNumChildComponents(); i++)
+            if (auto component = dynamic_cast<DockingComponent*>(window->getChildComponent(i)))
+                root = component;
+        
+        auto solver = LayoutSolver(data);
+        solver.solveWindow(findTree(data, windowId), window->getLocalBounds());
+        REQUIRE(solver.getRects(data.getUuid(findTree(data, windowId).getChild(0))) != nullptr);
+        CHECK(solver.getRects(data.getUuid(findTree(data, windowId).getChild(0)))->bounds == root->getBounds());
+        
+        /// Every component, its header, its view and its resizer bars, in the window's space
+        auto numChecked = 0;
+        for (const auto& rects : solver.getAllRects())
+        {
+            auto component = manager.getDockingComponent(rects.uuid);
+            if (component == nullptr) {continue;}
+            INFO("run " << run << ", " << data.getName(findTree(data, rects.uuid)));
+            auto toWindow = [&](juce::Component* c) {return window->getLocalArea(c->getParentComponent(), c->getBounds());};
+            CHECK(rects.bounds == toWindow(component));
+            
+            if (auto header = manager.getHeader(component))
+                CHECK(rects.header == toWindow(header));
+            else
+                CHECK(rects.header.isEmpty());
+            
+            if (auto view = manager.getView(component))
+                CHECK(rects.content == toWindow(view));
+            
+            auto type = data.getDockType(component->getTree());
+            if (type == DockTypes::horizontal || type == DockTypes::vertical)
+            {
+                auto& bars = manager.getResizerBars(component);
+                REQUIRE(rects.resizers.getLength() == bars.size());
+                for (auto i = 0; i < bars.size(); i++)
+                    CHECK(solver.getResizerBounds(rects.resizers.getStart() + i) == toWindow(bars[i].get()));
+            }
+            numChecked++;
+        }
+        CHECK(numChecked >= ids.size());
+    }
+}
+
+
+TEST_CASE("layoutSolver_hitTest")
+{
+    auto delegate = TestManagerDelegate();
+    auto manager = test_DockManager(delegate);
+    auto& data = manager.getData();
+    
+    auto [windowId, rootId] = data.addNewWindow("Window1", {0, 0, 800, 600});
+    auto left = data.dockNewView(rootId, DropLocation::rootRight, "Elements");
+    auto right = data.dockNewView(left, DropLocation::viewRight, "Canvas");
+    auto hidden = data.dockNewView(right, DropLocation::tabs, "Cues");
+    auto tabs = data.getUuid(findTree(data, right).getParent());
+    auto tabsTree = findTree(data, tabs);
+    data.setSelected(tabsTree, right);
+    
+    auto solver = LayoutSolver(data);
+    solver.solveWindow(findTree(data, windowId), {0, 0, 800, 600});
+    auto leftRects = solver.getRects(left);
+    auto rightRects = solver.getRects(right);
+    REQUIRE(leftRects != nullptr);
+    REQUIRE(rightRects != nullptr);
+    
+    CHECK(solver.getRectsAt(leftRects->content.getCentre())->uuid == left);
+    CHECK(solver.getRectsAt(rightRects->content.getCentre())->uuid == right);
+    CHECK_FALSE(solver.getRects(hidden)->isVisible);
+    CHECK(solver.getRectsAt({-10, -10}) == nullptr);
+}
+
+
+
+
+
+/**
+ ===================================
+ MARK: - Tabs -
+ ===================================
+ */
+
+TEST_CASE("headerTabs_onlyBuildNewTabs")
+{
+    auto delegate = TestManagerDelegate();
+    auto manager = test_DockManager(delegate);
+    auto& data = manager.getData();
+    
+    auto [windowId, rootId] = data.addNewWindow("Window1");
+    auto group = data.addView(rootId, "Group", DockTypes::tabs);
+    for (auto i = 0; i < 30; i++)
+        data.addView(group, "View" + juce::String(i), DockTypes::none);
+    auto groupComponent = manager.getDockingComponent(group);
+    auto groupTree = groupComponent->getTree();
+    auto tabIds = [&] {
+        juce::StringArray ids;
+        for (auto child : groupTree)
+            ids.add(data.getUuid(child));
+        return ids;
+    };
+    REQUIRE(manager.getTabIds(groupComponent) == tabIds());
+    
+    /// Adding
+    DockCounters::reset();
+    auto added = data.addView(group, "Added", DockTypes::none);
+    CHECK(DockCounters::tabComponents == 1);
+    CHECK(manager.getTabIds(groupComponent) == tabIds());
+    
+    /// Removing
+    DockCounters::reset();
+    data.removeView(tabIds()[10]);
+    CHECK(DockCounters::tabComponents == 0);
+    CHECK(manager.getTabIds(groupComponent) == tabIds());
+    
+    /// Reordering
+    DockCounters::reset();
+    groupTree.moveChild(0, 20, nullptr);
+    CHECK(DockCounters::tabComponents == 0);
+    CHECK(manager.getTabIds(groupComponent) == tabIds());
+    
+    /// Docking another view in, as one transaction
+    auto [otherWindowId, otherRootId] = data.addNewWindow("Window2");
+    auto canvas = data.addView(otherRootId, "Canvas", DockTypes::none);
+    DockCounters::reset();
+    data.dockView(canvas, added, DropLocation::tabs, {}, 0);
+    CHECK(DockCounters::tabComponents == 1);
+    CHECK(manager.getTabIds(groupComponent) == tabIds());
+}
+
+
+TEST_CASE("headerTabs_virtualTabStrip")
+{
+    auto delegate = TestManagerDelegate();
+    auto manager = test_DockManager(delegate);
+    manager.setVirtualTabStrip(true);
+    auto& data = manager.getData();
+    
+    auto [windowId, rootId] = data.addNewWindow("Window1", {0, 0, 600, 400});
+    auto group = data.addView(rootId, "Group", DockTypes::tabs);
+    DockCounters::reset();
+    for (auto i = 0; i < 200; i++)
+        data.addView(group, "View" + juce::String(i), DockTypes::none);
+    
+    /// Only what fits in the strip, and a few either side
+    auto groupComponent = manager.getDockingComponent(group);
+    auto groupTree = groupComponent->getTree();
+    auto numTabs = manager.getTabIds(groupComponent).size();
+    CHECK(numTabs > 0);
+    CHECK(numTabs < 20);
+    CHECK(DockCounters::tabComponents < 40);
+    CHECK(manager.getTabIds(groupComponent)[0] == data.getUuid(groupTree.getChild(0)));
+    
+    /// Scrolling reuses them
+    DockCounters::reset();
+    manager.scrollToTab(groupComponent, 100);
+    CHECK(DockCounters::tabComponents == 0);
+    auto tabIds = manager.getTabIds(groupComponent);
+    CHECK(tabIds.size() == numTabs);
+    CHECK(tabIds.contains(data.getUuid(groupTree.getChild(100))));
+    CHECK_FALSE(tabIds.contains(data.getUuid(groupTree.getChild(0))));
+    
+    /// A tab being dragged keeps its tree while it's scrolled out of the strip and back
+    manager.scrollToTab(groupComponent, 0);
+    auto dragged = manager.getTab(groupComponent, 1);
+    auto draggedTree = groupTree.getChild(1);
+    DockCounters::reset();
+    manager.startTabDrag(groupComponent, dragged);
+    manager.scrollToTab(groupComponent, 100);
+    REQUIRE(manager.isInTabStrip(groupComponent, dragged));
+    CHECK(DockCounters::tabComponents == 1);
+    CHECK(dragged->getTree() == draggedTree);
+    CHECK_FALSE(manager.getTabIds(groupComponent).contains(data.getUuid(draggedTree)));
+    
+    manager.scrollToTab(groupComponent, 0);
+    CHECK(manager.getTab(groupComponent, 1) == dragged);
+    CHECK(dragged->getTree() == draggedTree);
+    manager.endTabDrag(groupComponent, dragged);
+    CHECK(dragged->isVisible());
+    
+    /// The overflow menu comes from the tree, and scrolls to what it selects
+    DockCounters::reset();
+    CHECK(manager.getOverflowMenu(groupComponent).getNumItems() == 200);
+    auto last = data.getUuid(groupTree.getChild(199));
+    manager.selectTabFromOverflow(groupComponent, last);
+    CHECK(data.getSelectedId(groupTree) == last);
+    CHECK(manager.getTabIds(groupComponent).contains(last));
+    CHECK(DockCounters::tabComponents == 0);
+}
+
+
+
+
+
+/**
+ ===================================
+ MARK: - Lazy Views -
+ ===================================
+ */
+
+TEST_CASE("lazyViews_createdWhenSelected")
+{
+    auto delegate = ViewCountingDelegate();
+    auto manager = test_DockManager(delegate);
+    auto& data = manager.getData();
+    manager.setLazyViews(true);
+    
+    auto [windowId, rootId] = data.addNewWindow("Window1");
+    auto group = data.addView(rootId, "Group", DockTypes::tabs);
+    juce::StringArray tabIds;
+    for (auto i = 0; i < 5; i++)
+        tabIds.add(data.addView(group, "View" + juce::String(i), DockTypes::none));
+    auto groupTree = manager.getDockingComponent(group)->getTree();
+    
+    /// Only the selected tab has its view
+    CHECK(delegate.created == juce::StringArray("View0"));
+    CHECK(manager.getView(manager.getDockingComponent(tabIds[3])) == nullptr);
+    
+    /// Selecting a tab creates it, once
+    data.setSelected(groupTree, tabIds[3]);
+    auto tab = manager.getDockingComponent(tabIds[3]);
+    REQUIRE(manager.getView(tab) != nullptr);
+    CHECK(manager.getView(tab)->getParentComponent() == tab);
+    CHECK_FALSE(manager.getView(tab)->getBounds().isEmpty());
+    data.setSelected(groupTree, tabIds[0]);
+    data.setSelected(groupTree, tabIds[3]);
+    CHECK(delegate.created == juce::StringArray("View0", "View3"));
+}
+
+
+TEST_CASE("lazyViews_prewarm")
+{
+    auto delegate = ViewCountingDelegate();
+    auto manager = test_DockManager(delegate);
+    auto& data = manager.getData();
+    manager.setLazyViews(true, true);
+    
+    auto [windowId, rootId] = data.addNewWindow("Window1");
+    auto group = data.addView(rootId, "Group", DockTypes::tabs);
+    juce::StringArray tabIds;
+    for (auto i = 0; i < 4; i++)
+        tabIds.add(data.addView(group, "View" + juce::String(i), DockTypes::none));
+    auto groupTree = manager.getDockingComponent(group)->getTree();
+    CHECK(delegate.created.size() == 1);
+    
+    /// One view each time the queue runs, until every tab has one
+    CHECK(manager.prewarmNextView());
+    CHECK(delegate.created.size() == 2);
+    while (manager.prewarmNextView()) {}
+    CHECK(delegate.created.size() == 4);
+    
+    /// Selecting picks up the prewarmed view rather than creating another
+    data.setSelected(groupTree, tabIds[2]);
+    CHECK(delegate.created.size() == 4);
+    CHECK(manager.getView(manager.getDockingComponent(tabIds[2])) == manager.getAllComponents()[tabIds[2]].get());
+}
+
+
+
+
+
+/**
+ ===================================
+ MARK: - View Visibility -
+ ===================================
+ */
+
+TEST_CASE("viewVisibility_followsTabsAndWindow")
+{
+    using ViewVisibility = DockManager::Delegate::ViewVisibility;
+    auto delegate = VisibilityDelegate();
+    auto manager = test_DockManager(delegate);
+    auto& data = manager.getData();
+    
+    auto [windowId, rootId] = data.addNewWindow("Window1");
+    auto group = data.addView(rootId, "Group", DockTypes::tabs);
+    juce::StringArray tabIds;
+    for (auto i = 0; i < 3; i++)
+        tabIds.add(data.addView(group, "View" + juce::String(i), DockTypes::none));
+    auto groupTree = manager.getDockingComponent(group)->getTree();
+    
+    /// Only the selected tab runs
+    CHECK_FALSE(delegate.views["View0"]->isSuspended());
+    CHECK(delegate.views["View1"]->getViewVisibility() == ViewVisibility::hiddenTab);
+    CHECK(delegate.views["View2"]->isSuspended());
+    CHECK_FALSE(delegate.views["View2"]->getContent()->isVisible());
+    
+    data.setSelected(groupTree, tabIds[2]);
+    CHECK(delegate.views["View0"]->isSuspended());
+    CHECK_FALSE(delegate.views["View2"]->isSuspended());
+    CHECK(delegate.views["View2"]->getContent()->isVisible());
+    
+    /// Minimising suspends everything in the window, restoring brings back the selected tab
+    auto numSuspended = delegate.numSuspended;
+    auto rootTree = groupTree.getParent();
+    data.setWindowMinimized(windowId, true);
+    manager.updateViewVisibility(rootTree);
+    CHECK(delegate.views["View2"]->getViewVisibility() == ViewVisibility::minimised);
+    CHECK(delegate.views["View0"]->getViewVisibility() == ViewVisibility::minimised);
+    CHECK(delegate.numSuspended == numSuspended + 1);
+    
+    data.setWindowMinimized(windowId, false);
+    manager.updateViewVisibility(rootTree);
+    CHECK_FALSE(delegate.views["View2"]->isSuspended());
+    CHECK(delegate.views["View0"]->getViewVisibility() == ViewVisibility::hiddenTab);
+}
+
+
+TEST_CASE("viewVisibility_tabStrip")
+{
+    auto delegate = VisibilityDelegate();
+    auto manager = test_DockManager(delegate);
+    auto& data = manager.getData();
+    
+    /// More tabs than fit across the window at their smallest
+    auto [windowId, rootId] = data.addNewWindow("Window1", {0, 0, 600, 400});
+    auto group = data.addView(rootId, "Group", DockTypes::tabs);
+    for (auto i = 0; i < 20; i++)
+        data.addView(group, "View" + juce::String(i), DockTypes::none);
+    
+    CHECK_FALSE(delegate.outOfTabStrip.contains("View0"));
+    CHECK(delegate.outOfTabStrip.contains("View19"));
+    CHECK(delegate.outOfTabStrip.size() < 20);
+    
+    /// Scrolling only passes on the tabs which crossed the edge of the strip
+    auto groupComponent = manager.getDockingComponent(group);
+    auto numInStrip = 20 - delegate.outOfTabStrip.size();
+    delegate.numTabStripChanges = 0;
+    manager.scrollToTab(groupComponent, 19);
+    CHECK_FALSE(delegate.outOfTabStrip.contains("View19"));
+    CHECK(delegate.outOfTabStrip.contains("View0"));
+    CHECK(20 - delegate.outOfTabStrip.size() == numInStrip);
+    CHECK(delegate.numTabStripChanges <= numInStrip * 2);
+    
+    delegate.numTabStripChanges = 0;
+    manager.scrollToTab(groupComponent, 19);
+    CHECK(delegate.numTabStripChanges == 0);
+}
+
+
+
+
+
+/**
+ ===================================
+ MARK: - Autosave -
+ ===================================
+ */
+
+TEST_CASE("autosave_followsManagerChanges")
+{
+    auto delegate = TestManagerDelegate();
+    auto manager = test_DockManager(delegate);
+    auto& data = manager.getData();
+    auto file = juce::File::getSpecialLocation(juce::File::tempDirectory).getNonexistentChildFile("test_managerAutosave", ".layout");
+    auto readFile = [&file] {
+        juce::MemoryBlock block;
+        file.loadFileAsData(block);
+        return BinaryLayout::read(block.getData(), block.getSize());
+    };
+    
+    /// Docking and properties both count as changes
+    manager.setAutosave(file, LayoutFormat::binary);
+    auto [windowId, rootId] = data.addNewWindow("Window1");
+    auto view = data.addView(rootId, "Elements", DockTypes::none);
+    CHECK(manager.flushAutosave());
+    CHECK(readFile().isEquivalentTo(data.getTree()));
+    
+    auto tree = findTree(data, view);
+    data.setName(tree, "Renamed");
+    CHECK(manager.flushAutosave());
+    CHECK(readFile().isEquivalentTo(data.getTree()));
+    
+    /// Turned off, the file stays as it was
+    manager.setAutosave({});
+    data.addView(rootId, "Canvas", DockTypes::none);
+    CHECK(manager.flushAutosave());
+    CHECK_FALSE(readFile().isEquivalentTo(data.getTree()));
+    file.deleteFile();
+}
+
+
+TEST_CASE("layoutHash_skipsUnchangedLayouts")
+{
+    struct UpdateCountingDelegate : public TestManagerDelegate
+    {
+        void didUpdateLayouts() override {numUpdates++;}
+        int numUpdates = 0;
+    };
+    
+    auto delegate = UpdateCountingDelegate();
+    auto manager = test_DockManager(delegate);
+    auto& data = manager.getData();
+    auto [windowId, rootId] = data.addNewWindow("Window1");
+    auto view = data.addView(rootId, "Elements", DockTypes::none);
+    auto tree = findTree(data, view);
+    auto width = 100.0f;
+    data.setWidth(tree, width);
+    juce::MessageManager::getInstance()->runDispatchLoopUntil(10);
+    auto numUpdates = delegate.numUpdates;
+    
+    /// A drag which ends where it started isn't an update
+    data.setWidth(tree, width + 10);
+    data.setWidth(tree, width);
+    juce::MessageManager::getInstance()->runDispatchLoopUntil(10);
+    CHECK(delegate.numUpdates == numUpdates);
+    
+    data.setWidth(tree, width + 10);
+    juce::MessageManager::getInstance()->runDispatchLoopUntil(10);
+    CHECK(delegate.numUpdates == numUpdates + 1);
+    
+    /// Nor is a transaction which puts everything back, the components don't lay out again
+    DockCounters::reset();
+    {
+        DockManagerData::ScopedTransaction transaction(data);
+        data.setWidth(tree, width);
+        data.setName(tree, "Canvas");
+        data.setName(tree, "Elements");
+        data.setWidth(tree, width + 10);
+    }
+    CHECK(DockCounters::layoutPasses == 0);
+    
+    {
+        DockManagerData::ScopedTransaction transaction(data);
+        data.setName(tree, "Canvas");
+    }
+    CHECK(DockCounters::layoutPasses > 0);
+    data.setName(tree, "Elements");
+    
+    /// Nor is it saved again
+    auto file = juce::File::getSpecialLocation(juce::File::tempDirectory).getNonexistentChildFile("test_hashAutosave", ".layout");
+    manager.setAutosave(file);
+    data.setWidth(tree, width);
+    CHECK(manager.flushAutosave());
+    CHECK(manager.getNumAutosaves() == 1);
+    data.setWidth(tree, width + 10);
+    data.setWidth(tree, width);
+    CHECK(manager.flushAutosave());
+    CHECK(manager.getNumAutosaves() == 1);
+    data.setWidth(tree, width + 20);
+    CHECK(manager.flushAutosave());
+    CHECK(manager.getNumAutosaves() == 2);
+    manager.setAutosave({});
+    file.deleteFile();
+}
+
+
+TEST_CASE("journal_recoversManagerLayout")
+{
+    auto delegate = TestManagerDelegate();
+    auto file = juce::File::getSpecialLocation(juce::File::tempDirectory).getNonexistentChildFile("test_managerJournal", ".layout");
+    juce::ValueTree layout;
+    {
+        auto manager = test_DockManager(delegate);
+        auto& data = manager.getData();
+        manager.setJournal(file);
+        auto [windowId, rootId] = data.addNewWindow("Window1");
+        auto view = data.addView(rootId, "Elements", DockTypes::none);
+        data.addView(rootId, "Canvas", DockTypes::none);
+        auto tree = findTree(data, view);
+        data.setName(tree, "Renamed");
+        layout = data.getTree().createCopy();
+    }
+    
+    /// Tearing the manager down isn't journaled, what was open comes back
+    auto manager = test_DockManager(delegate);
+    CHECK(manager.recoverLayout(file));
+    CHECK(manager.getData().getTree().isEquivalentTo(layout));
+    
+    file.deleteFile();
+    LayoutJournal::getJournalFile(file).deleteFile();
+    CHECK_FALSE(manager.recoverLayout(file));
+}
+
+
+
+
+
+/**
+ ===================================
+ MARK: - Scale -
+ ===================================
+ Large layouts, left out unless asked for: [scale]
+ */
+
+TEST_CASE("scale_changeCostIsFlat", "[.][scale]")
+{
+    /// Windows of ten views side by side, the first window is the one changed
+    auto measureResize = [](int numViews)
+    {
+        auto delegate = ViewCountingDelegate();
+        auto manager = test_DockManager(delegate);
+        auto& data = manager.getData();
+        juce::String firstView;
+        {
+            DockManagerData::ScopedTransaction transaction(data);
+            juce::String split;
+            for (auto i = 0; i < numViews; i++)
+            {
+                if (i % 10 == 0)
+                    split = data.addView(data.addNewWindow("Window" + juce::String(i / 10)).second, "", DockTypes::horizontal);
+                auto view = data.addView(split, "View" + juce::String(i), DockTypes::none);
+                if (i == 0)
+                    firstView = view;
+            }
+        }
+        REQUIRE(delegate.created.size() == numViews);
+        
+        auto tree = findTree(data, firstView);
+        DockCounters::reset();
+        data.setWidth(tree, 150.0f);
+        data.setName(tree, "Renamed");
+        return std::make_tuple((int) DockCounters::treeCallbacks, (int) DockCounters::layoutPasses,
+                               (int) DockCounters::dispatchedCalls, (int) DockCounters::dockingComponents);
+    };
+    
+    /// A change reaches the components it's about, however many others there are
+    auto small = measureResize(10);
+    auto large = measureResize(2000);
+    CHECK(std::get<0>(small) > 0);
+    CHECK(small == large);
+}
+
+
+
+
+
 /**
  ===================================
  MARK: - Utility -
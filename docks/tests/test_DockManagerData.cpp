@@ -1,6 +1,10 @@
 
 #include "catch2.hpp"
 #include "../source/DockManagerData.h"
+#include "../source/BinaryLayout.h"
+#include "../source/XmlLayout.h"
+#include "../source/LayoutAutosaver.h"
+#include "../source/LayoutJournal.h"
 
 
 class test_DockManagerData : public DockManagerData
@@ -12,6 +16,12 @@ public:
     template <typename T>
     const T getProperty(const juce::ValueTree& tree, const juce::String& propId) const {return DockManagerData::getProperty<T>(tree, propId);}
     juce::ValueTree getRootTreeForWindow(const juce::String& forWindow) const {return DockManagerData::getRootTreeForWindow(forWindow);}
+    juce::ValueTree findTreeWithName(const juce::String& name) const {return DockManagerData::findTreeWithName(name);}
+    juce::ValueTree findTreeMatching(const juce::String& regex) const {return DockManagerData::findTreeMatching(regex);}
+    const int getIndexSize() const {return _uuidIndex.size();}
+    
+    /// Autosave, as if its timer went off
+    static void fireAutosave(LayoutAutosaver& autosaver) {autosaver.timerCallback();}
 };
 
 
@@ -323,21 +333,638 @@ TEST_CASE("dockManagerData_getBounds")
 
 TEST_CASE("findTreeWithUuid")
 {
+    auto data = test_DockManagerData();
+    auto [window1, rootId] = data.addNewWindow("Window1");
+    auto view1 = data.addView(rootId, "View1");
+    auto view2 = data.addView(view1, "View2");
+    auto view3 = data.addView(rootId, "View3", DockTypes::none);
+    
+    CHECK(data.findTree(window1).isValid());
+    CHECK(data.findTree(rootId) == data.getRootTreeForWindow(window1));
+    CHECK(data.findTree(view2).getParent() == data.findTree(view1));
+    CHECK(data.getIndexSize() == 5);
+    CHECK_FALSE(data.findTree("").isValid());
+    CHECK_FALSE(data.findTree("notAUuid").isValid());
+    
+    /// Removing a subtree drops it from the index
+    data.removeViewAndChildren(view1);
+    CHECK_FALSE(data.findTree(view1).isValid());
+    CHECK_FALSE(data.findTree(view2).isValid());
+    CHECK(data.getIndexSize() == 3);
+    
+    /// Moving a subtree keeps it indexed
+    auto [window2, rootId2] = data.addNewWindow("Window2");
+    auto view4 = data.addView(view3, "View4");
+    auto view3Tree = data.findTree(view3);
+    data.findTree(rootId).removeChild(view3Tree, nullptr);
+    data.findTree(rootId2).addChild(view3Tree, -1, nullptr);
+    CHECK(data.findTree(view3).getParent() == data.getRootTreeForWindow(window2));
+    CHECK(data.findTree(view4).getParent() == data.findTree(view3));
+    
+    /// Changing a uuid re-keys it
+    data.findTree(view4).setProperty(dockProps::uuidProperty, "newUuid", nullptr);
+    CHECK_FALSE(data.findTree(view4).isValid());
+    CHECK(data.findTree("newUuid").isValid());
+    
+    /// Tree listeners hear of a change once it's indexed
+    struct AddedListener : juce::ValueTree::Listener
+    {
+        AddedListener(test_DockManagerData& d) : data(d) {}
+        void valueTreeChildAdded(juce::ValueTree&, juce::ValueTree& child) override {found = data.findTree(data.getUuid(child)) == child;}
+        test_DockManagerData& data;
+        bool found = false;
+    };
+    auto listener = AddedListener(data);
+    data.addTreeListener(&listener);
+    data.addView(rootId2, "View5", DockTypes::none);
+    CHECK(listener.found);
+    data.removeTreeListener(&listener);
     
+    /// Listeners below the root hear first, and still find what the data is adding
+    auto root2Tree = data.findTree(rootId2);
+    listener.found = false;
+    root2Tree.addListener(&listener);
+    data.addView(rootId2, "View6", DockTypes::none);
+    CHECK(listener.found);
+    root2Tree.removeListener(&listener);
+    
+    /// Clearing empties it
+    data.clearWindows();
+    CHECK_FALSE(data.findTree(window1).isValid());
+    CHECK(data.getIndexSize() == 0);
 }
 
 
 TEST_CASE("findTree")
 {
+    auto data = test_DockManagerData();
+    auto [window1, rootId] = data.addNewWindow("Window1");
+    auto view1 = data.addView(rootId, "View1");
+    auto view2 = data.addView(rootId, "View2");
+    
+    CHECK(data.getUuid(data.findTree(dockProps::nameProperty, "View2")) == view2);
+    CHECK(data.findTree(dockProps::uuidProperty, view1) == data.findTree(view1));
+    CHECK_FALSE(data.findTree(dockProps::nameProperty, "View3").isValid());
+    
+    /// Trees opened from a layout are indexed
+    juce::MemoryOutputStream output;
+    REQUIRE(data.saveLayout(output));
+    auto opened = test_DockManagerData();
+    juce::MemoryInputStream input(output.getData(), output.getDataSize(), false);
+    REQUIRE(opened.openLayout(input));
+    CHECK(opened.getIndexSize() == 4);
+    CHECK(opened.getName(view2) == "View2");
+}
+
+
+
+
+
+
+
+TEST_CASE("findTreeWithName")
+{
+    auto data = test_DockManagerData();
+    auto [window1, rootId] = data.addNewWindow("Window1");
+    auto tabs = data.addView(rootId, "Tabs", DockTypes::tabs);
+    auto view1 = data.addView(tabs, "View1", DockTypes::none);
+    auto view2 = data.addView(tabs, "View2", DockTypes::none);
+    auto [window2, rootId2] = data.addNewWindow("Window2");
+    auto view3 = data.addView(rootId2, "View1", DockTypes::none);
+    
+    /// First in tree order
+    CHECK(data.getUuid(data.findTreeWithName("View1")) == view1);
+    CHECK(data.findTreeWithName("View1") == data.findTree(dockProps::nameProperty, "View1"));
+    CHECK_FALSE(data.findTreeWithName("View4").isValid());
     
+    /// Renaming and moving are tracked
+    data.setName(view1, "View4");
+    CHECK(data.getUuid(data.findTreeWithName("View1")) == view3);
+    CHECK(data.getUuid(data.findTreeWithName("View4")) == view1);
+    auto view3Tree = data.findTree(view3);
+    data.findTree(rootId2).removeChild(view3Tree, nullptr);
+    data.findTree(tabs).addChild(view3Tree, 0, nullptr);
+    CHECK(data.getUuid(data.findTreeWithName("View1")) == view3);
+    
+    /// Show View
+    CHECK(data.showView("View2"));
+    CHECK(data.getSelectedId(data.findTree(tabs)) == view2);
+    CHECK_FALSE(data.showView("View5"));
 }
 
 
+TEST_CASE("findTreeMatching")
+{
+    auto data = test_DockManagerData();
+    auto [window1, rootId] = data.addNewWindow("Window1");
+    auto tabs = data.addView(rootId, "Tabs", DockTypes::tabs);
+    auto view1 = data.addView(tabs, "Cues 1", DockTypes::none);
+    auto view2 = data.addView(tabs, "Cues 2", DockTypes::none);
+    
+    CHECK(data.getUuid(data.findTreeMatching("Cues.*")) == view1);
+    CHECK(data.getUuid(data.findTreeMatching("Cues.*")) == view1);
+    CHECK(data.getUuid(data.findTreeMatching(".*2")) == view2);
+    CHECK_FALSE(data.findTreeMatching("Palette").isValid());
+    
+    /// Cached matches follow renames
+    data.setName(view1, "Palette");
+    CHECK(data.getUuid(data.findTreeMatching("Cues.*")) == view2);
+    CHECK(data.getUuid(data.findTreeMatching("Palette")) == view1);
+}
 
 
 
 
 
+/**
+ ===================================
+ MARK: - Transactions -
+ ===================================
+ */
+
+/// Records every commit it recieves
+class test_TransactionListener : public DockManagerData::TransactionListener
+{
+public:
+    void transactionDidCommit(const juce::ValueTree& affectedTree) override {commits.add(affectedTree);}
+    juce::Array<juce::ValueTree> commits;
+};
+
+
+TEST_CASE("transaction_coalescesUpdates")
+{
+    auto data = test_DockManagerData();
+    auto listener = test_TransactionListener();
+    data.addTransactionListener(&listener);
+    
+    juce::String windowId, rootId, tabs;
+    {
+        DockManagerData::ScopedTransaction transaction(data);
+        std::tie(windowId, rootId) = data.addNewWindow("Window1");
+        tabs = data.addView(rootId, "Tabs", DockTypes::tabs);
+        data.addView(tabs, "View1", DockTypes::none);
+        data.addView(tabs, "View2", DockTypes::none);
+        data.setName(tabs, "Renamed");
+        CHECK(data.isInTransaction());
+        CHECK(listener.commits.isEmpty());
+    }
+    
+    /// One update per affected tree, parents first
+    CHECK_FALSE(data.isInTransaction());
+    CHECK(listener.commits.size() == 4);
+    CHECK(listener.commits[0] == data.getTree());
+    CHECK(listener.commits[1] == data.findTree(windowId));
+    CHECK(listener.commits[2] == data.findTree(rootId));
+    CHECK(listener.commits[3] == data.findTree(tabs));
+    
+    data.removeTransactionListener(&listener);
+}
+
+
+TEST_CASE("transaction_nested")
+{
+    auto data = test_DockManagerData();
+    auto listener = test_TransactionListener();
+    auto [windowId, rootId] = data.addNewWindow("Window1");
+    data.addTransactionListener(&listener);
+    
+    {
+        DockManagerData::ScopedTransaction outer(data);
+        {
+            DockManagerData::ScopedTransaction inner(data);
+            data.addView(rootId, "View1", DockTypes::none);
+        }
+        
+        /// Only the outermost transaction commits
+        CHECK(listener.commits.isEmpty());
+        data.addView(rootId, "View2", DockTypes::none);
+    }
+    
+    CHECK(listener.commits.size() == 1);
+    CHECK(listener.commits[0] == data.findTree(rootId));
+    
+    data.removeTransactionListener(&listener);
+}
+
+
+TEST_CASE("transaction_skipsRemovedTrees")
+{
+    auto data = test_DockManagerData();
+    auto listener = test_TransactionListener();
+    auto [windowId, rootId] = data.addNewWindow("Window1");
+    auto view = data.addView(rootId, "View1", DockTypes::none);
+    data.addTransactionListener(&listener);
+    
+    {
+        DockManagerData::ScopedTransaction transaction(data);
+        data.setName(view, "Renamed");
+        data.removeWindow(windowId);
+    }
+    
+    /// The window and its views are gone, only the root changed
+    CHECK(listener.commits.size() == 1);
+    CHECK(listener.commits[0] == data.getTree());
+    
+    data.removeTransactionListener(&listener);
+}
+
+
+
+
+
+/**
+ ===================================
+ MARK: - Reconcile -
+ ===================================
+ */
+
+/// Same types and names all the way down
+static bool test_hasSameStructure(test_DockManagerData& data, const juce::ValueTree& tree, const juce::ValueTree& layout)
+{
+    if (tree.getType() != layout.getType() || data.getName(tree) != data.getName(layout)) {return false;}
+    if (tree.getNumChildren() != layout.getNumChildren()) {return false;}
+    for (auto i = 0; i < tree.getNumChildren(); i++)
+        if (!test_hasSameStructure(data, tree.getChild(i), layout.getChild(i)))
+            return false;
+    return true;
+}
+
+
+TEST_CASE("reconcileLayout_keepsMatchingTrees")
+{
+    auto data = test_DockManagerData();
+    auto [windowId, rootId] = data.addNewWindow("Window1");
+    auto view1 = data.addView(rootId, "View1", DockTypes::none);
+    auto view2 = data.addView(rootId, "View2", DockTypes::none);
+    auto liveTree = data.findTree(view1);
+    
+    /// Same layout, minus one view
+    auto layout = data.getTree().createCopy();
+    auto layoutRoot = layout.getChild(0).getChild(0);
+    layoutRoot.removeChild(layoutRoot.getChildWithProperty(dockProps::uuidProperty, view2), nullptr);
+    
+    CHECK(data.reconcileLayout(layout));
+    CHECK(data.findTree(view1) == liveTree);
+    CHECK_FALSE(data.findTree(view2).isValid());
+    CHECK(test_hasSameStructure(data, data.getTree(), layout));
+}
+
+
+TEST_CASE("reconcileLayout_matchesByName")
+{
+    auto data = test_DockManagerData();
+    auto [windowId, rootId] = data.addNewWindow("Window1");
+    auto tabs = data.addView(rootId, "Tabs", DockTypes::tabs);
+    auto view1 = data.addView(tabs, "View1", DockTypes::none);
+    auto view2 = data.addView(tabs, "View2", DockTypes::none);
+    
+    /// The same names saved by another session, so none of the uuids match
+    auto other = test_DockManagerData();
+    auto [otherWindowId, otherRootId] = other.addNewWindow("Window1");
+    auto otherTabs = other.addView(otherRootId, "Tabs", DockTypes::tabs);
+    other.addView(otherTabs, "View1", DockTypes::none);
+    auto otherView2 = other.addView(otherTabs, "View2", DockTypes::none);
+    auto otherTabsTree = other.findTree(otherTabs);
+    other.setSelected(otherTabsTree, otherView2);
+    other.addView(otherRootId, "View3", DockTypes::none);
+    
+    CHECK(data.reconcileLayout(other.getTree()));
+    CHECK(test_hasSameStructure(data, data.getTree(), other.getTree()));
+    
+    /// The live trees are kept, and the selected tab follows them
+    CHECK(data.findTree(windowId).isValid());
+    CHECK(data.findTree(view1).isValid());
+    CHECK(data.getSelectedId(data.findTree(tabs)) == view2);
+    CHECK(data.findTreeWithName("View3").isValid());
+}
+
+
+TEST_CASE("reconcileLayout_removesMissing")
+{
+    auto data = test_DockManagerData();
+    auto [windowId, rootId] = data.addNewWindow("Window1");
+    data.addView(rootId, "View1", DockTypes::none);
+    auto [otherWindowId, otherRootId] = data.addNewWindow("Window2");
+    auto view2 = data.addView(otherRootId, "View2", DockTypes::none);
+    
+    auto other = test_DockManagerData();
+    auto [newWindowId, newRootId] = other.addNewWindow("Window3");
+    other.addView(newRootId, "View2", DockTypes::none);
+    
+    CHECK(data.reconcileLayout(other.getTree()));
+    CHECK(test_hasSameStructure(data, data.getTree(), other.getTree()));
+    CHECK_FALSE(data.findTree(windowId).isValid());
+    CHECK_FALSE(data.findTreeWithName("View1").isValid());
+    
+    /// Moved to the new window rather than rebuilt
+    CHECK(data.findTree(view2).isValid());
+    CHECK(data.getName(data.findTree(view2).getParent().getParent()) == "Window3");
+}
+
+
+
+
+
+/**
+ ===================================
+ MARK: - Layout Formats -
+ ===================================
+ */
+
+/// A layout with every kind of property a layout saves
+static void test_addFormatLayout(test_DockManagerData& data)
+{
+    auto [windowId, rootId] = data.addNewWindow("Window1");
+    auto tabs = data.addView(rootId, "Tabs", DockTypes::tabs);
+    auto view = data.addView(tabs, juce::String::fromUTF8("Caf\xc3\xa9 View"), DockTypes::none);
+    data.addView(tabs, "", DockTypes::none);
+    auto tree = data.findTree(view);
+    tree.setProperty("size", 123.25, nullptr);
+    tree.setProperty("ratio", 0.1, nullptr);
+    tree.setProperty("count", -42, nullptr);
+    tree.setProperty("big", (juce::int64) 1 << 40, nullptr);
+    tree.setProperty("flag", true, nullptr);
+    tree.setProperty("empty", juce::var(), nullptr);
+}
+
+
+static const bool test_hasSameTypes(const juce::ValueTree& tree, const juce::ValueTree& other)
+{
+    for (auto i = 0; i < tree.getNumProperties(); i++)
+    {
+        auto name = tree.getPropertyName(i);
+        const auto& value = tree.getProperty(name);
+        const auto& otherValue = other.getProperty(name);
+        if (value.isInt() != otherValue.isInt() || value.isInt64() != otherValue.isInt64()
+            || value.isBool() != otherValue.isBool() || value.isDouble() != otherValue.isDouble()
+            || value.isString() != otherValue.isString() || value.isVoid() != otherValue.isVoid())
+            return false;
+    }
+
+    for (auto i = 0; i < tree.getNumChildren(); i++)
+        if (!test_hasSameTypes(tree.getChild(i), other.getChild(i)))
+            return false;
+    return true;
+}
+
+
+TEST_CASE("layoutFormat_binaryRoundTrip")
+{
+    auto data = test_DockManagerData();
+    test_addFormatLayout(data);
+
+    juce::MemoryOutputStream stream;
+    REQUIRE(data.saveLayout(stream, LayoutFormat::binary));
+    CHECK(BinaryLayout::isBinaryLayout(stream.getData(), stream.getDataSize()));
+
+    auto tree = BinaryLayout::read(stream.getData(), stream.getDataSize());
+    REQUIRE(tree.isValid());
+    CHECK(tree.isEquivalentTo(data.getTree()));
+    CHECK(test_hasSameTypes(data.getTree(), tree));
+}
+
+
+TEST_CASE("layoutFormat_openDetectsFormat")
+{
+    auto data = test_DockManagerData();
+    test_addFormatLayout(data);
+
+    for (auto format : {LayoutFormat::xml, LayoutFormat::binary})
+    {
+        juce::MemoryOutputStream stream;
+        REQUIRE(data.saveLayout(stream, format));
+        INFO((format == LayoutFormat::xml ? "xml" : "binary"));
+
+        auto other = test_DockManagerData();
+        juce::MemoryInputStream input(stream.getData(), stream.getDataSize(), false);
+        CHECK(other.openLayout(input));
+        CHECK(other.getTree().createXml()->toString() == data.getTree().createXml()->toString());
+    }
+
+    /// XML is still the default, and unchanged
+    juce::MemoryOutputStream xmlStream;
+    REQUIRE(data.saveLayout(xmlStream));
+    CHECK(xmlStream.toString() == data.getTree().createXml()->toString());
+}
+
+
+TEST_CASE("layoutFormat_rejectsCorruptBinary")
+{
+    auto data = test_DockManagerData();
+    test_addFormatLayout(data);
+    juce::MemoryOutputStream stream;
+    REQUIRE(data.saveLayout(stream, LayoutFormat::binary));
+    juce::MemoryBlock block(stream.getData(), stream.getDataSize());
+
+    /// Every truncation fails cleanly, and leaves the layout alone
+    for (size_t size = 0; size < block.getSize(); size++)
+    {
+        INFO("truncated to " << size);
+        CHECK_FALSE(BinaryLayout::read(block.getData(), size).isValid());
+    }
+
+    auto other = test_DockManagerData();
+    auto [windowId, rootId] = other.addNewWindow("Kept");
+    juce::MemoryInputStream truncated(block.getData(), block.getSize() / 2, false);
+    CHECK_FALSE(other.openLayout(truncated));
+    CHECK(other.findTree(windowId).isValid());
+
+    /// A newer version, or any byte flipped, never crashes
+    auto newer = block;
+    newer[4] = (char) (BinaryLayout::version + 1);
+    CHECK_FALSE(BinaryLayout::read(newer.getData(), newer.getSize()).isValid());
+
+    auto random = juce::Random(99);
+    for (auto run = 0; run < 500; run++)
+    {
+        auto corrupt = block;
+        auto index = 4 + random.nextInt((int) corrupt.getSize() - 4);
+        corrupt[index] = (char) random.nextInt(256);
+        BinaryLayout::read(corrupt.getData(), corrupt.getSize());
+    }
+}
+
+
+/// Names which need escaping, and enough properties to wrap the attributes onto new lines
+static void test_addAwkwardLayout(test_DockManagerData& data, juce::Random& random, int numViews)
+{
+    const char* names[] = {"Plain", "A & B", "<Tag>", "\"Quoted\"", "Line\nBreak", "Tab\tbed", "Caret^ `tick`", "Caf\xc3\xa9", "\xe2\x9c\x93 Done", ""};
+    auto [windowId, rootId] = data.addNewWindow("Window & <1>");
+    auto parents = juce::StringArray(rootId);
+    for (auto i = 0; i < numViews; i++)
+    {
+        auto parent = parents[random.nextInt(parents.size())];
+        auto type = random.nextInt(4) == 0 ? DockTypes::tabs : DockTypes::none;
+        auto name = juce::String::fromUTF8(names[random.nextInt(juce::numElementsInArray(names))]) + juce::String(i);
+        auto view = data.addView(parent, name, type);
+        if (type == DockTypes::tabs)
+            parents.add(view);
+
+        auto tree = data.findTree(view);
+        if (random.nextBool())
+            tree.setProperty("size", random.nextFloat() * 500.0f, nullptr);
+        if (random.nextBool())
+            tree.setProperty("count", random.nextInt() - random.nextInt(), nullptr);
+        if (random.nextBool())
+            tree.setProperty("flag", random.nextBool(), nullptr);
+        if (random.nextInt(4) == 0)
+            tree.setProperty("aVeryLongPropertyNameToWrapTheLine", juce::String::repeatedString("x", random.nextInt(80)), nullptr);
+    }
+}
+
+
+TEST_CASE("layoutFormat_xmlMatchesCreateXml")
+{
+    auto random = juce::Random(2024);
+    for (auto run = 0; run < 20; run++)
+    {
+        auto data = test_DockManagerData();
+        test_addAwkwardLayout(data, random, 1 + random.nextInt(60));
+
+        juce::MemoryOutputStream streamed, viaXml;
+        REQUIRE(data.saveLayout(streamed));
+        data.getTree().createXml()->writeTo(viaXml);
+
+        INFO("run " << run);
+        REQUIRE(streamed.getDataSize() == viaXml.getDataSize());
+        CHECK(std::memcmp(streamed.getData(), viaXml.getData(), streamed.getDataSize()) == 0);
+    }
+
+    /// Through a file too
+    auto data = test_DockManagerData();
+    test_addAwkwardLayout(data, random, 20);
+    auto file = juce::File::getSpecialLocation(juce::File::tempDirectory).getNonexistentChildFile("test_xmlLayout", ".xml");
+    REQUIRE(data.saveToFile(file));
+    CHECK(file.loadFileAsString() == data.getTree().createXml()->toString());
+    file.deleteFile();
+}
+
+
+
+
+/**
+ ===================================
+ MARK: - Autosave -
+ ===================================
+ */
+
+static juce::File test_getAutosaveFile()
+{
+    return juce::File::getSpecialLocation(juce::File::tempDirectory).getNonexistentChildFile("test_autosave", ".layout");
+}
+
+
+static juce::String test_readLayoutFile(const juce::File& file)
+{
+    juce::FileInputStream stream(file);
+    auto other = test_DockManagerData();
+    return other.openLayout(stream) ? other.getTree().createXml()->toString() : juce::String();
+}
+
+
+TEST_CASE("autosave_writesOnBackgroundThread")
+{
+    auto data = test_DockManagerData();
+    auto [windowId, rootId] = data.addNewWindow("Window1");
+    auto file = test_getAutosaveFile();
+    {
+        LayoutAutosaver autosaver(data.getTree(), file, LayoutFormat::binary);
+        autosaver.layoutDidChange();
+        CHECK(autosaver.hasPendingChanges());
+        CHECK_FALSE(file.existsAsFile());
+
+        /// Only the copy is taken here, the thread writes it
+        test_DockManagerData::fireAutosave(autosaver);
+        CHECK_FALSE(autosaver.hasPendingChanges());
+        for (auto i = 0; i < 200 && autosaver.getNumSaves() == 0; i++)
+            juce::Thread::sleep(10);
+
+        CHECK(autosaver.getNumSaves() == 1);
+        CHECK(autosaver.lastSaveSucceeded());
+        CHECK(test_readLayoutFile(file) == data.getTree().createXml()->toString());
+
+        /// Changes after the copy wait for the next save
+        data.addView(rootId, "View1", DockTypes::none);
+        autosaver.layoutDidChange();
+        CHECK(test_readLayoutFile(file) != data.getTree().createXml()->toString());
+    }
+
+    /// Saved on the way out
+    CHECK(test_readLayoutFile(file) == data.getTree().createXml()->toString());
+    file.deleteFile();
+}
+
+
+TEST_CASE("autosave_flushWritesLatestOnly")
+{
+    auto data = test_DockManagerData();
+    auto [windowId, rootId] = data.addNewWindow("Window1");
+    auto file = test_getAutosaveFile();
+    LayoutAutosaver autosaver(data.getTree(), file);
+
+    /// Snapshots queued faster than they're written coalesce, the newest always wins
+    for (auto i = 0; i < 20; i++)
+    {
+        data.addView(rootId, "View" + juce::String(i), DockTypes::none);
+        autosaver.layoutDidChange();
+        if (i % 3 == 0)
+            test_DockManagerData::fireAutosave(autosaver);
+    }
+
+    CHECK(autosaver.flush());
+    CHECK(autosaver.getNumSaves() <= 8);
+    CHECK(test_readLayoutFile(file) == data.getTree().createXml()->toString());
+
+    /// Nothing new, nothing written
+    auto numSaves = autosaver.getNumSaves();
+    CHECK(autosaver.flush());
+    CHECK(autosaver.getNumSaves() == numSaves);
+    file.deleteFile();
+}
+
+
+TEST_CASE("autosave_maxLatency")
+{
+    auto data = test_DockManagerData();
+    data.addNewWindow("Window1");
+    auto file = test_getAutosaveFile();
+    LayoutAutosaver autosaver(data.getTree(), file);
+    juce::uint32 now = 1000;
+    autosaver.setClock([&now] {return now;});
+    CHECK(autosaver.getMillisecondsUntilSave() == -1);
+
+    /// Each change pushes the save back by the debounce
+    autosaver.setTiming(50, 10000);
+    autosaver.layoutDidChange();
+    CHECK(autosaver.getMillisecondsUntilSave() == 50);
+    now += 30;
+    CHECK(autosaver.getMillisecondsUntilSave() == 20);
+    autosaver.layoutDidChange();
+    CHECK(autosaver.getMillisecondsUntilSave() == 50);
+    autosaver.flush();
+
+    /// But not past the max latency from the first change, however often it changes
+    autosaver.setTiming(1000, 100);
+    autosaver.layoutDidChange();
+    for (auto i = 0; i < 12; i++)
+    {
+        now += 5;
+        autosaver.layoutDidChange();
+    }
+
+    CHECK(autosaver.getMillisecondsUntilSave() == 40);
+
+    now += 50;
+    autosaver.layoutDidChange();
+    CHECK(autosaver.getMillisecondsUntilSave() == 0);
+    CHECK(autosaver.flush());
+    CHECK_FALSE(autosaver.hasPendingChanges());
+    file.deleteFile();
+}
+
+
+
+
 /**
  ===================================
  MARK: - Mock -
@@ -345,3 +972,427 @@ TEST_CASE("findTree")
  */
 
 
+
+
+
+
+/**
+ ===================================
+ MARK: - Journal -
+ ===================================
+ */
+
+static juce::File test_getJournalSnapshotFile()
+{
+    return juce::File::getSpecialLocation(juce::File::tempDirectory).getNonexistentChildFile("test_journal", ".layout");
+}
+
+
+static void test_deleteJournalFiles(const juce::File& file)
+{
+    file.deleteFile();
+    LayoutJournal::getJournalFile(file).deleteFile();
+}
+
+
+/// One of the changes a user makes, to a random tree
+static void test_changeLayout(test_DockManagerData& data, juce::Random& random)
+{
+    juce::Array<juce::ValueTree> trees;
+    std::function<void(const juce::ValueTree&)> addTrees = [&](const juce::ValueTree& tree)
+    {
+        for (const auto& child : tree)
+        {
+            trees.add(child);
+            addTrees(child);
+        }
+    };
+    addTrees(data.getTree());
+
+    auto tree = trees[random.nextInt(trees.size())];
+    auto uuid = data.getUuid(tree);
+    switch (random.nextInt(8))
+    {
+        case 0: data.setName(tree, "Renamed " + juce::String(random.nextInt(100))); break;
+        case 1: data.setBounds(tree, {random.nextFloat() * 100, random.nextFloat() * 100, 200, 300}); break;
+        case 2: tree.setProperty("flag", random.nextBool(), nullptr); break;
+        case 3: tree.removeProperty("size", nullptr); break;
+        case 4: if (tree.getNumChildren() > 1) tree.moveChild(0, tree.getNumChildren() - 1, nullptr); break;
+        case 5: if (!data.isWindow(tree) && uuid.isNotEmpty()) data.removeView(uuid); break;
+        case 6: if (tree.getNumChildren() > 0) data.setSelected(tree, data.getUuid(tree.getChild(random.nextInt(tree.getNumChildren())))); break;
+        case 7: data.setWindowLocked(data.getUuid(data.getTree().getChild(0)), random.nextBool()); break;
+    }
+}
+
+
+TEST_CASE("journal_replaysEveryChange")
+{
+    auto random = juce::Random(18);
+    auto data = test_DockManagerData();
+    test_addAwkwardLayout(data, random, 200);
+    auto file = test_getJournalSnapshotFile();
+    {
+        LayoutJournal journal(data, file);
+        CHECK(journal.isOpen());
+        for (auto i = 0; i < 300 && data.getTree().getNumChildren() > 0; i++)
+            test_changeLayout(data, random);
+
+        /// Adding a whole tree is journaled with it
+        auto [windowId, rootId] = data.addNewWindow("Window2");
+        data.addView(rootId, "View2", DockTypes::none);
+
+        /// Left as though it crashed, without folding the journal in
+    }
+
+    auto recovered = LayoutJournal::recover(file);
+    REQUIRE(recovered.isValid());
+    CHECK(recovered.isEquivalentTo(data.getTree()));
+    CHECK(recovered.createXml()->toString() == data.getTree().createXml()->toString());
+    test_deleteJournalFiles(file);
+}
+
+
+TEST_CASE("journal_stopsAtTornRecord")
+{
+    auto data = test_DockManagerData();
+    auto [windowId, rootId] = data.addNewWindow("Window1");
+    auto view = data.addView(rootId, "View", DockTypes::none);
+    auto file = test_getJournalSnapshotFile();
+
+    juce::Array<juce::ValueTree> states;
+    {
+        LayoutJournal journal(data, file);
+        for (auto i = 0; i < 5; i++)
+        {
+            data.setName(view, "Name" + juce::String(i));
+            states.add(data.getTree().createCopy());
+        }
+    }
+
+    CHECK(LayoutJournal::recover(file).isEquivalentTo(states.getLast()));
+
+    /// A crash part way through the last record loses only that change
+    juce::MemoryBlock journal;
+    auto journalFile = LayoutJournal::getJournalFile(file);
+    REQUIRE(journalFile.loadFileAsData(journal));
+    journal.setSize(journal.getSize() - 3);
+    REQUIRE(journalFile.replaceWithData(journal.getData(), journal.getSize()));
+    CHECK(LayoutJournal::recover(file).isEquivalentTo(states[3]));
+
+    /// As does one which was written but not as it should have been
+    static_cast<char*>(journal.getData())[journal.getSize() - 1] ^= 0x55;
+    REQUIRE(journalFile.replaceWithData(journal.getData(), journal.getSize()));
+    CHECK(LayoutJournal::recover(file).isEquivalentTo(states[3]));
+    test_deleteJournalFiles(file);
+}
+
+
+TEST_CASE("journal_compactsIntoSnapshot")
+{
+    auto random = juce::Random(180);
+    auto data = test_DockManagerData();
+    test_addAwkwardLayout(data, random, 50);
+    auto file = test_getJournalSnapshotFile();
+    {
+        /// Folded in whenever it passes the limit, so it never grows much past it
+        LayoutJournal journal(data, file, 2048);
+        auto generation = journal.getGeneration();
+        for (auto i = 0; i < 400 && data.getTree().getNumChildren() > 0; i++)
+        {
+            test_changeLayout(data, random);
+            CHECK(journal.getJournalSize() <= 2048);
+        }
+
+        CHECK(journal.getGeneration() > generation);
+        CHECK(LayoutJournal::recover(file).isEquivalentTo(data.getTree()));
+    }
+
+    /// Carries on after the last generation rather than starting again
+    {
+        LayoutJournal journal(data, file, 2048);
+        data.addNewWindow("Window2");
+        CHECK(LayoutJournal::recover(file).isEquivalentTo(data.getTree()));
+    }
+
+    test_deleteJournalFiles(file);
+}
+
+
+TEST_CASE("journal_ignoresStaleJournal")
+{
+    auto data = test_DockManagerData();
+    auto [windowId, rootId] = data.addNewWindow("Window1");
+    auto file = test_getJournalSnapshotFile();
+    juce::MemoryBlock staleJournal;
+    {
+        LayoutJournal journal(data, file);
+        data.addView(rootId, "View1", DockTypes::none);
+        REQUIRE(LayoutJournal::getJournalFile(file).loadFileAsData(staleJournal));
+        CHECK(journal.compact());
+    }
+
+    /// Crashed between writing the snapshot and starting the new journal, its changes are already in the snapshot
+    LayoutJournal::getJournalFile(file).replaceWithData(staleJournal.getData(), staleJournal.getSize());
+    auto recovered = LayoutJournal::recover(file);
+    CHECK(recovered.isEquivalentTo(data.getTree()));
+
+    /// Nothing to recover without a snapshot
+    test_deleteJournalFiles(file);
+    CHECK_FALSE(LayoutJournal::recover(file).isValid());
+}
+
+
+
+
+/**
+ ===================================
+ MARK: - Layout Hashes -
+ ===================================
+ */
+
+TEST_CASE("layoutHash_returnsWithTheLayout")
+{
+    auto data = test_DockManagerData();
+    auto [windowId, rootId] = data.addNewWindow("Window1");
+    auto view = data.addView(rootId, "View1", DockTypes::none);
+    data.addView(rootId, "View2", DockTypes::none);
+    auto [otherWindowId, otherRootId] = data.addNewWindow("Window2");
+    data.addView(otherRootId, "View3", DockTypes::none);
+    auto tree = data.findTree(view);
+    auto width = 100.0f;
+    data.setWidth(tree, width);
+
+    auto layoutHash = data.getLayoutHash();
+    auto windowHash = data.getWindowHash(windowId);
+    auto otherWindowHash = data.getWindowHash(otherWindowId);
+    CHECK(windowHash != otherWindowHash);
+    CHECK(data.getWindowHash(view) == 0);
+
+    /// Only the window it happened in changes
+    data.setWidth(tree, width + 10);
+    CHECK(data.getLayoutHash() != layoutHash);
+    CHECK(data.getWindowHash(windowId) != windowHash);
+    CHECK(data.getWindowHash(otherWindowId) == otherWindowHash);
+
+    /// And comes back when the change is undone
+    data.setWidth(tree, width);
+    CHECK(data.getLayoutHash() == layoutHash);
+    CHECK(data.getWindowHash(windowId) == windowHash);
+
+    auto root = data.findTree(rootId);
+    root.moveChild(0, 1, nullptr);
+    CHECK(data.getLayoutHash() != layoutHash);
+    root.moveChild(1, 0, nullptr);
+    CHECK(data.getLayoutHash() == layoutHash);
+
+    auto added = data.addView(otherRootId, "View4", DockTypes::none);
+    CHECK(data.getWindowHash(otherWindowId) != otherWindowHash);
+    data.removeView(added);
+    CHECK(data.getWindowHash(otherWindowId) == otherWindowHash);
+
+    /// A copy hashes the same, whatever order its properties were set in
+    auto copy = juce::ValueTree(tree.getType());
+    for (auto i = tree.getNumProperties(); --i >= 0;)
+        copy.setProperty(tree.getPropertyName(i), tree.getProperty(tree.getPropertyName(i)), nullptr);
+    CHECK(data.getHash(copy) == data.getHash(tree));
+    copy.setProperty(dockProps::widthProperty, juce::String(width), nullptr);
+    CHECK(data.getHash(copy) != data.getHash(tree));
+}
+
+
+TEST_CASE("layoutHash_matchesFreshHash")
+{
+    /// A copy is never cached, so it's hashed from scratch
+    auto random = juce::Random(19);
+    auto data = test_DockManagerData();
+    test_addAwkwardLayout(data, random, 100);
+    for (auto i = 0; i < 300 && data.getTree().getNumChildren() > 0; i++)
+    {
+        test_changeLayout(data, random);
+        if (random.nextInt(3) == 0)
+            data.getWindowHash(data.getUuid(data.getTree().getChild(0)));
+
+        INFO("change " << i);
+        REQUIRE(data.getLayoutHash() == data.getHash(data.getTree().createCopy()));
+    }
+}
+
+
+
+
+/**
+ ===================================
+ MARK: - Dock Uuid -
+ ===================================
+ */
+
+TEST_CASE("dockUuid_keepsTheText")
+{
+    /// As juce::Uuid writes them, from text or bytes
+    juce::Uuid juceUuid;
+    auto uuid = DockUuid(juceUuid.toString());
+    CHECK(uuid.isCompact());
+    CHECK(uuid.toString() == juceUuid.toString());
+    CHECK(DockUuid::fromBytes(juceUuid.getRawData()) == uuid);
+    juce::uint8 bytes[16];
+    uuid.copyBytes(bytes);
+    CHECK(std::memcmp(bytes, juceUuid.getRawData(), 16) == 0);
+
+    /// Anything else stays as it was written, and never matches a different spelling
+    auto upperCase = DockUuid(juceUuid.toString().toUpperCase());
+    CHECK_FALSE(upperCase.isCompact());
+    CHECK(upperCase != uuid);
+    CHECK(upperCase.toString() == juceUuid.toString().toUpperCase());
+    for (auto text : {"newUuid", "0123456789abcdef0123456789abcdef0", "0123456789abcdef0123456789abcde", "00000000000000000000000000000000", "00000000000000000123456789abcdef"})
+    {
+        CHECK_FALSE(DockUuid(text).isCompact());
+        CHECK(DockUuid(text).toString() == text);
+        CHECK(DockUuid(text) == DockUuid(juce::String(text)));
+    }
+
+    /// Every digit, and a character either side of each range, in every position
+    auto digits = juce::String("0123456789abcdef0123456789abcdef");
+    CHECK(DockUuid(digits).isCompact());
+    CHECK(DockUuid(digits).toString() == digits);
+    for (auto i = 0; i < 32; i++)
+    {
+        for (auto c : {'/', ':', '`', 'g', 'A', 'F'})
+        {
+            auto text = digits.substring(0, i) + juce::String::charToString(c) + digits.substring(i + 1);
+            INFO(text);
+            CHECK_FALSE(DockUuid(text).isCompact());
+        }
+    }
+
+    CHECK(DockUuid().isNull());
+    CHECK(DockUuid(juce::String()).isNull());
+    CHECK(DockUuid(juce::String()) != DockUuid("00000000000000000000000000000000"));
+
+    /// Keys either kind
+    juce::HashMap<DockUuid, int, DockUuid::HashFunction> map;
+    map.set(uuid, 1);
+    map.set(DockUuid("newUuid"), 2);
+    CHECK(map[DockUuid(juceUuid.toString())] == 1);
+    CHECK(map[DockUuid("newUuid")] == 2);
+    CHECK_FALSE(map.contains(upperCase));
+}
+
+
+
+
+/**
+ ===================================
+ MARK: - Dock Schema -
+ ===================================
+ */
+
+TEST_CASE("dockSchema_storesAsText")
+{
+    /// Typed writes store what the text ids always did, so saved layouts read back the same
+    auto view = dockNode::create<dockSchema::view>();
+    dockNode::set<dockSchema::width>(view, 120.5f);
+    dockNode::set<dockSchema::dockType>(view, DockTypes::tabs);
+    dockNode::set<dockSchema::locked>(view, true);
+    dockNode::set<dockSchema::name>(view, "View");
+
+    CHECK(view.getType().toString() == dockIds::viewIdentifier);
+    CHECK((double) view.getProperty(dockProps::widthProperty) == 120.5);
+    CHECK((int) view.getProperty(dockProps::dockType) == (int) DockTypes::tabs);
+    CHECK((bool) view.getProperty(dockProps::lockedProperty));
+    CHECK(view.getProperty(dockProps::nameProperty).toString() == "View");
+
+    /// And read what was written as text
+    view.setProperty(dockProps::heightProperty, 80, nullptr);
+    view.setProperty(dockProps::selectedProperty, "tab", nullptr);
+    CHECK(dockNode::get<dockSchema::height>(view) == 80.0f);
+    CHECK(dockNode::get<dockSchema::selected>(view) == "tab");
+    CHECK(dockNode::get<dockSchema::width>(view) == 120.5f);
+    CHECK(dockNode::get<dockSchema::dockType>(view) == DockTypes::tabs);
+
+    /// Missing, or from an invalid tree, gives the type's default
+    CHECK(dockNode::get<dockSchema::x>(view) == 0.0f);
+    CHECK_FALSE(dockNode::get<dockSchema::minimized>(view));
+    CHECK(dockNode::get<dockSchema::uuid>(juce::ValueTree()).isEmpty());
+    CHECK(dockNode::get<dockSchema::dockType>(juce::ValueTree()) == DockTypes::none);
+
+    CHECK(dockNode::has<dockSchema::width>(view));
+    dockNode::remove<dockSchema::width>(view);
+    CHECK_FALSE(dockNode::has<dockSchema::width>(view));
+
+    /// One identifier per entry, the same one listeners are told about
+    CHECK(&dockNode::getId<dockSchema::width>() == &dockNode::getId<dockSchema::width>());
+    CHECK(dockNode::is<dockSchema::width>(juce::Identifier(dockProps::widthProperty)));
+    CHECK_FALSE(dockNode::is<dockSchema::width>(juce::Identifier(dockProps::heightProperty)));
+    CHECK(dockNode::isType<dockSchema::view>(view));
+    CHECK_FALSE(dockNode::isType<dockSchema::window>(view));
+}
+
+
+
+
+/**
+ ===================================
+ MARK: - Scale -
+ ===================================
+ Large random layouts, left out unless asked for: [scale]
+ */
+
+TEST_CASE("scale_randomLayoutStaysIndexed", "[.][scale]")
+{
+    auto random = juce::Random(22);
+    auto data = test_DockManagerData();
+    for (auto i = 0; i < 20; i++)
+        test_addAwkwardLayout(data, random, 250);
+
+    /// Leaves only, a tree can't be docked inside itself
+    auto getLeaves = [&]
+    {
+        juce::StringArray leaves;
+        std::function<void(const juce::ValueTree&)> addLeaves = [&](const juce::ValueTree& tree)
+        {
+            for (const auto& child : tree)
+            {
+                if (data.isView(child) && child.getNumChildren() == 0)
+                    leaves.add(data.getUuid(child));
+                addLeaves(child);
+            }
+        };
+        addLeaves(data.getTree());
+        return leaves;
+    };
+
+    for (auto i = 0; i < 2000 && data.getTree().getNumChildren() > 0; i++)
+    {
+        if (random.nextBool())
+        {
+            test_changeLayout(data, random);
+            continue;
+        }
+
+        auto leaves = getLeaves();
+        if (leaves.size() < 2) {break;}
+        auto location = (DropLocation) random.nextInt((int) DropLocation::none);
+        data.dockView(leaves[random.nextInt(leaves.size())], leaves[random.nextInt(leaves.size())], location, {}, 0);
+    }
+
+    /// Every tree is indexed and found without a search, and nothing else is
+    auto numTrees = 0;
+    std::function<void(const juce::ValueTree&)> checkIndexed = [&](const juce::ValueTree& tree)
+    {
+        for (const auto& child : tree)
+        {
+            auto uuid = data.getUuid(child);
+            REQUIRE(uuid.isNotEmpty());
+            REQUIRE(data.findTree(uuid) == child);
+            REQUIRE(data.findTree(dockProps::uuidProperty, uuid) == child);
+            numTrees++;
+            checkIndexed(child);
+        }
+    };
+    checkIndexed(data.getTree());
+    CHECK(data.getIndexSize() == numTrees);
+
+    /// And the cached hashes are those of the layout as it is
+    CHECK(data.getLayoutHash() == data.getHash(data.getTree().createCopy()));
+}
+
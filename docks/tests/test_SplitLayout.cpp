@@ -0,0 +1,207 @@
+#include "catch2.hpp"
+#include "../source/SplitLayout.h"
+
+
+/// A split laid out by both the engine and the Grid it replaced
+struct test_SplitLayout
+{
+    test_SplitLayout(juce::Random& random)
+    {
+        numComponents = 1 + random.nextInt(8);
+        numResizers = random.nextBool() ? numComponents - 1 : random.nextInt(numComponents + 1);
+        vertical = random.nextBool();
+        bounds = {random.nextInt(50), random.nextInt(50), random.nextInt(2000), random.nextInt(2000)};
+        crossSize = (float) (vertical ? bounds.getWidth() : bounds.getHeight()) + (random.nextBool() ? 0.0f : 25.0f);
+
+        for (auto i = 0; i < numComponents; i++)
+        {
+            hasSize.add(random.nextInt(4) != 0);
+            sizes.add(random.nextBool() ? random.nextFloat() * 500.0f : (float) random.nextInt(500));
+        }
+
+        for (auto i = 0; i < numComponents; i++)
+        {
+            components.add(new juce::Component());
+            gridComponents.add(new juce::Component());
+        }
+
+        for (auto i = 0; i < numResizers; i++)
+        {
+            resizers.add(new juce::Component());
+            gridResizers.add(new juce::Component());
+        }
+    }
+
+    bool isFixed(int i) const {return hasSize[i] && i != numComponents - 2;}
+
+    void layoutWithGrid()
+    {
+        juce::Grid grid;
+        using Track = juce::Grid::TrackInfo;
+        using Px = juce::Grid::Px;
+        using Fr = juce::Grid::Fr;
+        grid.autoFlow = vertical ? juce::Grid::AutoFlow::row : juce::Grid::AutoFlow::column;
+        auto& tracks = vertical ? grid.templateRows : grid.templateColumns;
+        (vertical ? grid.templateColumns : grid.templateRows).add(Track(Px(crossSize)));
+
+        for (auto i = 0; i < numComponents; i++)
+        {
+            tracks.add(isFixed(i) ? Track(Px(sizes[i])) : Track(Fr(1)));
+            grid.items.add(gridComponents[i]);
+
+            if (i < numResizers)
+            {
+                tracks.add(Track(Px(5)));
+                grid.items.add(gridResizers[i]);
+            }
+        }
+
+        grid.performLayout(bounds);
+    }
+
+    bool layoutWithSplit(SplitLayout& layout)
+    {
+        layout.setNumItems(numComponents + juce::jmin(numComponents, numResizers));
+        auto item = 0;
+        for (auto i = 0; i < numComponents; i++)
+        {
+            layout.setItem(item++, components[i], sizes[i], isFixed(i));
+            if (i < numResizers)
+                layout.setItem(item++, resizers[i], 5.0f, true);
+        }
+
+        return layout.performLayout(bounds, crossSize, vertical);
+    }
+
+    bool matches() const
+    {
+        for (auto i = 0; i < numComponents; i++)
+            if (components[i]->getBounds() != gridComponents[i]->getBounds())
+                return false;
+
+        for (auto i = 0; i < numResizers; i++)
+            if (resizers[i]->getBounds() != gridResizers[i]->getBounds())
+                return false;
+
+        return true;
+    }
+
+    int numComponents, numResizers;
+    bool vertical;
+    juce::Rectangle<int> bounds;
+    float crossSize;
+    juce::Array<bool> hasSize;
+    juce::Array<float> sizes;
+    juce::OwnedArray<juce::Component> components, resizers, gridComponents, gridResizers;
+};
+
+
+
+
+
+/**
+ ===================================
+ MARK: - Layout -
+ ===================================
+ */
+
+TEST_CASE("splitLayout_matchesGrid")
+{
+    auto random = juce::Random(8008);
+    for (auto run = 0; run < 1000; run++)
+    {
+        auto split = test_SplitLayout(random);
+        auto layout = SplitLayout();
+        split.layoutWithGrid();
+        REQUIRE(split.layoutWithSplit(layout));
+        INFO("run " << run << ", " << split.numComponents << " components, " << split.numResizers << " resizers");
+        CHECK(split.matches());
+    }
+}
+
+
+TEST_CASE("splitLayout_reusedMatchesGrid")
+{
+    /// One engine reused for every layout, as a component's is
+    auto random = juce::Random(1234);
+    auto layout = SplitLayout();
+    for (auto run = 0; run < 200; run++)
+    {
+        auto split = test_SplitLayout(random);
+        split.layoutWithGrid();
+        split.layoutWithSplit(layout);
+        INFO("run " << run);
+        CHECK(split.matches());
+    }
+}
+
+
+TEST_CASE("splitLayout_partialMatchesGrid")
+{
+    /// A resizer dragged, only the two beside it are laid out again, unless the rest would move too
+    auto random = juce::Random(77);
+    auto numPartial = 0;
+    for (auto run = 0; run < 500; run++)
+    {
+        auto split = test_SplitLayout(random);
+        if (split.numResizers == 0 || split.numComponents < 2) {continue;}
+        auto layout = SplitLayout();
+        split.layoutWithSplit(layout);
+
+        auto index = random.nextInt(juce::jmin(split.numResizers, split.numComponents - 1));
+        auto amount = (float) (random.nextInt(41) - 20);
+        split.sizes.set(index, split.sizes[index] + amount);
+        split.sizes.set(index + 1, split.sizes[index + 1] - amount);
+        layout.setItem(index * 2, split.components[index], split.sizes[index], split.isFixed(index));
+        layout.setItem(index * 2 + 2, split.components[index + 1], split.sizes[index + 1], split.isFixed(index + 1));
+        if (!layout.performLayout(index * 2, index * 2 + 2)) {continue;}
+
+        numPartial++;
+        split.layoutWithGrid();
+        INFO("run " << run << ", resizer " << index);
+        CHECK(split.matches());
+        CHECK_FALSE(split.layoutWithSplit(layout));
+    }
+
+    CHECK(numPartial > 50);
+}
+
+
+
+
+
+/**
+ ===================================
+ MARK: - Skipping -
+ ===================================
+ */
+
+TEST_CASE("splitLayout_skipsWhenUnchanged")
+{
+    auto random = juce::Random(42);
+    auto split = test_SplitLayout(random);
+    auto layout = SplitLayout();
+    CHECK(split.layoutWithSplit(layout));
+    CHECK_FALSE(split.layoutWithSplit(layout));
+
+    /// Sizes, the last subview always keeps its own
+    auto last = split.numComponents - 1;
+    split.sizes.set(last, split.sizes[last] + 10.0f);
+    split.hasSize.set(last, true);
+    CHECK(split.layoutWithSplit(layout));
+    CHECK_FALSE(split.layoutWithSplit(layout));
+
+    /// Bounds
+    split.bounds = split.bounds.withWidth(split.bounds.getWidth() + 1);
+    CHECK(split.layoutWithSplit(layout));
+    CHECK_FALSE(split.layoutWithSplit(layout));
+
+    /// Moved by something else
+    split.components[0]->setBounds(1, 2, 3, 4);
+    CHECK(split.layoutWithSplit(layout));
+    CHECK(split.components[0]->getBounds() == layout.getItemBounds(0));
+
+    /// Invalidated
+    layout.invalidate();
+    CHECK(split.layoutWithSplit(layout));
+}